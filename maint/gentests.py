@@ -33,6 +33,21 @@ def gen_simple_tests(testlist):
     sys.stdout.write("generating simple tests ... ")
     outfile.write(os.path.join(prefix, "simple_test") + "\n")
     outfile.write(os.path.join(prefix, "threaded_test") + "\n")
+    outfile.write(os.path.join(prefix, "pack_iov_test") + "\n")
+    outfile.write(os.path.join(prefix, "batch_test") + "\n")
+    outfile.write(os.path.join(prefix, "plan_test") + "\n")
+    outfile.write(os.path.join(prefix, "request_list_test") + "\n")
+    outfile.write(os.path.join(prefix, "callback_test") + "\n")
+    outfile.write(os.path.join(prefix, "hostgpu_test") + "\n")
+    outfile.write(os.path.join(prefix, "large_type_test") + "\n")
+    outfile.write(os.path.join(prefix, "buffer_unregister_test") + "\n")
+    outfile.write(os.path.join(prefix, "staging_test") + "\n")
+    outfile.write(os.path.join(prefix, "progress_thread_test") + "\n")
+    outfile.write(os.path.join(prefix, "lazy_gpu_init_test") + "\n")
+    outfile.write(os.path.join(prefix, "flatten_compact_test") + "\n")
+    outfile.write(os.path.join(prefix, "unflatten_cache_test") + "\n")
+    outfile.write(os.path.join(prefix, "flatten_shared_test") + "\n")
+    outfile.write(os.path.join(prefix, "type_library_test") + "\n")
     outfile.close()
     sys.stdout.write("done\n")
 
@@ -131,6 +146,31 @@ if __name__ == '__main__':
                        " -tbuf-memtype unreg-host" + \
                        " -dbuf-memtype unreg-host" + \
                        " -num-threads 4")
+    gen_pack_iov_tests("pack", "test/pack/testlist.async.gen", \
+                       " -sbuf-memtype unreg-host" + \
+                       " -tbuf-memtype unreg-host" + \
+                       " -dbuf-memtype unreg-host" + \
+                       " -async-threshold 0")
+    gen_pack_iov_tests("pack", "test/pack/testlist.streams.gen", \
+                       " -sbuf-memtype unreg-host" + \
+                       " -tbuf-memtype unreg-host" + \
+                       " -dbuf-memtype unreg-host" + \
+                       " -num-threads 4 -streams")
+    gen_pack_iov_tests("pack", "test/pack/testlist.deps.gen", \
+                       " -sbuf-memtype unreg-host" + \
+                       " -tbuf-memtype unreg-host" + \
+                       " -dbuf-memtype unreg-host" + \
+                       " -async-threshold 0 -dependency")
+    gen_pack_iov_tests("pack", "test/pack/testlist.blocking.gen", \
+                       " -sbuf-memtype unreg-host" + \
+                       " -tbuf-memtype unreg-host" + \
+                       " -dbuf-memtype unreg-host" + \
+                       " -blocking")
+    gen_pack_iov_tests("pack", "test/pack/testlist.counter.gen", \
+                       " -sbuf-memtype unreg-host" + \
+                       " -tbuf-memtype unreg-host" + \
+                       " -dbuf-memtype unreg-host" + \
+                       " -num-threads 4 -streams -async-threshold 0 -counter")
     gen_pack_iov_tests("pack", "test/pack/testlist.cuda.d-d-d.gen", \
                        " -sbuf-memtype device" + \
                        " -tbuf-memtype device" + \
@@ -177,6 +217,40 @@ if __name__ == '__main__':
                        " -device-start-id 1" + \
                        " -device-stride 1")
 
+    gen_pack_iov_tests("pack", "test/pack/testlist.hostgpu.d-d-d.gen", \
+                       " -sbuf-memtype device" + \
+                       " -tbuf-memtype device" + \
+                       " -dbuf-memtype device")
+    gen_pack_iov_tests("pack", "test/pack/testlist.hostgpu.d-rh-d.gen", \
+                       " -sbuf-memtype device" + \
+                       " -tbuf-memtype reg-host" + \
+                       " -dbuf-memtype device")
+    gen_pack_iov_tests("pack", "test/pack/testlist.hostgpu.d-urh-d.gen", \
+                       " -sbuf-memtype device" + \
+                       " -tbuf-memtype unreg-host" + \
+                       " -dbuf-memtype device")
+    gen_pack_iov_tests("pack", "test/pack/testlist.hostgpu.rh-d-rh.gen", \
+                       " -sbuf-memtype reg-host" + \
+                       " -tbuf-memtype device" + \
+                       " -dbuf-memtype reg-host")
+    gen_pack_iov_tests("pack", "test/pack/testlist.hostgpu.urh-d-urh.gen", \
+                       " -sbuf-memtype unreg-host" + \
+                       " -tbuf-memtype device" + \
+                       " -dbuf-memtype unreg-host")
+    gen_pack_iov_tests("pack", "test/pack/testlist.hostgpu.md-stride.d-d-d.gen", \
+                       " -sbuf-memtype device" + \
+                       " -tbuf-memtype device" + \
+                       " -dbuf-memtype device" + \
+                       " -device-start-id 1" + \
+                       " -device-stride 1")
+    gen_pack_iov_tests("pack", "test/pack/testlist.hostgpu.md.urh-d-urh.threads.gen", \
+                       " -sbuf-memtype unreg-host" + \
+                       " -tbuf-memtype device" + \
+                       " -dbuf-memtype unreg-host" + \
+                       " -num-threads 4" + \
+                       " -device-start-id 1" + \
+                       " -device-stride 0")
+
     gen_pack_iov_tests("iov", "test/iov/testlist.gen")
     gen_pack_iov_tests("iov", "test/iov/testlist.threads.gen", " -num-threads 4")
     gen_flatten_tests("test/flatten/testlist.gen")
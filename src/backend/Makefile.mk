@@ -4,5 +4,6 @@
 ##
 
 include $(top_srcdir)/src/backend/cuda/Makefile.mk
+include $(top_srcdir)/src/backend/hostgpu/Makefile.mk
 include $(top_srcdir)/src/backend/seq/Makefile.mk
 include $(top_srcdir)/src/backend/src/Makefile.mk
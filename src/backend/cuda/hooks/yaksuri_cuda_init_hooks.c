@@ -63,6 +63,10 @@ static int finalize_hook(void)
     int rc = YAKSA_SUCCESS;
     cudaError_t cerr;
 
+    /* the devices were never used */
+    if (yaksuri_cudai_global.stream == NULL)
+        goto fn_exit;
+
     int cur_device;
     cerr = cudaGetDevice(&cur_device);
     YAKSURI_CUDAI_CUDA_ERR_CHKANDJUMP(cerr, rc, fn_fail);
@@ -78,6 +82,8 @@ static int finalize_hook(void)
     }
     free(yaksuri_cudai_global.stream);
     free(yaksuri_cudai_global.p2p);
+    yaksuri_cudai_global.stream = NULL;
+    yaksuri_cudai_global.p2p = NULL;
 
     cerr = cudaSetDevice(cur_device);
     YAKSURI_CUDAI_CUDA_ERR_CHKANDJUMP(cerr, rc, fn_fail);
@@ -111,14 +117,13 @@ static int check_p2p_comm(int sdev, int ddev, bool * is_enabled)
     return YAKSA_SUCCESS;
 }
 
-int yaksuri_cuda_init_hook(yaksur_gpudriver_info_s ** info)
+/* creating the streams and enabling peer access sets up a context on
+ * every device, so it waits for the first device buffer */
+static int activate_hook(void)
 {
     int rc = YAKSA_SUCCESS;
     cudaError_t cerr;
 
-    cerr = cudaGetDeviceCount(&yaksuri_cudai_global.ndevices);
-    YAKSURI_CUDAI_CUDA_ERR_CHKANDJUMP(cerr, rc, fn_fail);
-
     yaksuri_cudai_global.stream = (cudaStream_t *)
         malloc(yaksuri_cudai_global.ndevices * sizeof(cudaStream_t));
 
@@ -162,9 +167,28 @@ int yaksuri_cuda_init_hook(yaksur_gpudriver_info_s ** info)
     cerr = cudaSetDevice(cur_device);
     YAKSURI_CUDAI_CUDA_ERR_CHKANDJUMP(cerr, rc, fn_fail);
 
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksuri_cuda_init_hook(yaksur_gpudriver_info_s ** info)
+{
+    int rc = YAKSA_SUCCESS;
+    cudaError_t cerr;
+
+    /* counting the devices does not create any context */
+    cerr = cudaGetDeviceCount(&yaksuri_cudai_global.ndevices);
+    YAKSURI_CUDAI_CUDA_ERR_CHKANDJUMP(cerr, rc, fn_fail);
+
+    yaksuri_cudai_global.stream = NULL;
+    yaksuri_cudai_global.p2p = NULL;
+
     *info = (yaksur_gpudriver_info_s *) malloc(sizeof(yaksur_gpudriver_info_s));
     (*info)->get_num_devices = get_num_devices;
     (*info)->check_p2p_comm = check_p2p_comm;
+    (*info)->activate = activate_hook;
     (*info)->ipack = yaksuri_cudai_ipack;
     (*info)->iunpack = yaksuri_cudai_iunpack;
     (*info)->pup_is_supported = yaksuri_cudai_pup_is_supported;
@@ -178,7 +202,11 @@ int yaksuri_cuda_init_hook(yaksur_gpudriver_info_s ** info)
     (*info)->event_add_dependency = yaksuri_cudai_event_add_dependency;
     (*info)->type_create = yaksuri_cudai_type_create_hook;
     (*info)->type_free = yaksuri_cudai_type_free_hook;
+    (*info)->info_create = yaksuri_cudai_info_create_hook;
+    (*info)->info_free = yaksuri_cudai_info_free_hook;
+    (*info)->info_keyval_append = yaksuri_cudai_info_keyval_append;
     (*info)->get_ptr_attr = yaksuri_cudai_get_ptr_attr;
+    (*info)->get_ptr_range = NULL;
     (*info)->finalize = finalize_hook;
 
   fn_exit:
@@ -0,0 +1,12 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+if BUILD_HOSTGPU_BACKEND
+include $(top_srcdir)/src/backend/hostgpu/include/Makefile.mk
+include $(top_srcdir)/src/backend/hostgpu/hooks/Makefile.mk
+include $(top_srcdir)/src/backend/hostgpu/pup/Makefile.mk
+else
+include $(top_srcdir)/src/backend/hostgpu/stub/Makefile.mk
+endif !BUILD_HOSTGPU_BACKEND
@@ -0,0 +1,9 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+AM_CPPFLAGS += -I$(top_srcdir)/src/backend/hostgpu/hooks
+
+libyaksa_la_SOURCES += \
+	src/backend/hostgpu/hooks/yaksuri_hostgpu_init_hooks.c
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksuri_hostgpui.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+yaksuri_hostgpui_global_s yaksuri_hostgpui_global;
+
+static void *hostgpu_host_malloc(uintptr_t size)
+{
+    yaksur_ptr_attr_s attr;
+
+    attr.type = YAKSUR_PTR_TYPE__REGISTERED_HOST;
+    attr.device = -1;
+
+    return yaksuri_hostgpui_malloc(size, attr);
+}
+
+static void *hostgpu_gpu_malloc(uintptr_t size, int device)
+{
+    yaksur_ptr_attr_s attr;
+
+    attr.type = YAKSUR_PTR_TYPE__GPU;
+    attr.device = device;
+
+    return yaksuri_hostgpui_malloc(size, attr);
+}
+
+static void hostgpu_free(void *ptr)
+{
+    int rc = yaksuri_hostgpui_free(ptr);
+    assert(rc == YAKSA_SUCCESS);
+}
+
+/* the worker threads of the devices are only started when the glue
+ * layer sees the first device buffer */
+static int activate_hook(void)
+{
+    int rc = YAKSA_SUCCESS;
+    int ndevices = 0;
+
+    yaksuri_hostgpui_global.device = (yaksuri_hostgpui_device_s *)
+        malloc(yaksuri_hostgpui_global.ndevices * sizeof(yaksuri_hostgpui_device_s));
+    YAKSU_ERR_CHKANDJUMP(!yaksuri_hostgpui_global.device, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    for (; ndevices < yaksuri_hostgpui_global.ndevices; ndevices++) {
+        rc = yaksuri_hostgpui_device_init(ndevices);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    for (int i = 0; i < ndevices; i++)
+        yaksuri_hostgpui_device_finalize(i);
+    free(yaksuri_hostgpui_global.device);
+    yaksuri_hostgpui_global.device = NULL;
+    goto fn_exit;
+}
+
+static int finalize_hook(void)
+{
+    int rc = YAKSA_SUCCESS;
+
+    for (int i = 0; yaksuri_hostgpui_global.device && i < yaksuri_hostgpui_global.ndevices; i++) {
+        rc = yaksuri_hostgpui_device_finalize(i);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+    free(yaksuri_hostgpui_global.device);
+    yaksuri_hostgpui_global.device = NULL;
+    yaksuri_hostgpui_global.ndevices = 0;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+static int get_num_devices(int *ndevices)
+{
+    *ndevices = yaksuri_hostgpui_global.ndevices;
+
+    return YAKSA_SUCCESS;
+}
+
+static int check_p2p_comm(int sdev, int ddev, bool * is_enabled)
+{
+    *is_enabled = (sdev == ddev) || yaksuri_hostgpui_global.p2p;
+
+    return YAKSA_SUCCESS;
+}
+
+/* the driver keeps no per-type or per-info state */
+static int type_hook(yaksi_type_s * type)
+{
+    return YAKSA_SUCCESS;
+}
+
+static int info_hook(yaksi_info_s * info)
+{
+    return YAKSA_SUCCESS;
+}
+
+static int info_keyval_append(yaksi_info_s * info, const char *key, const void *val,
+                              unsigned int vallen)
+{
+    return YAKSA_SUCCESS;
+}
+
+static uintptr_t getenv_uint(const char *name, uintptr_t defval)
+{
+    char *str = getenv(name);
+
+    if (str == NULL || *str == '\0')
+        return defval;
+
+    return (uintptr_t) strtoull(str, NULL, 10);
+}
+
+int yaksuri_hostgpu_init_hook(yaksur_gpudriver_info_s ** info)
+{
+    int rc = YAKSA_SUCCESS;
+
+    *info = NULL;
+    yaksuri_hostgpui_global.device = NULL;
+
+    yaksuri_hostgpui_global.ndevices = (int) getenv_uint("YAKSA_ENV_HOSTGPU_NUM_DEVICES",
+                                                         YAKSURI_HOSTGPUI_DEFAULT_NUM_DEVICES);
+    yaksuri_hostgpui_global.latency_us = getenv_uint("YAKSA_ENV_HOSTGPU_LATENCY",
+                                                     YAKSURI_HOSTGPUI_DEFAULT_LATENCY_US);
+    yaksuri_hostgpui_global.bandwidth_mb = getenv_uint("YAKSA_ENV_HOSTGPU_BANDWIDTH",
+                                                       YAKSURI_HOSTGPUI_DEFAULT_BANDWIDTH_MB);
+    yaksuri_hostgpui_global.p2p = !!getenv_uint("YAKSA_ENV_HOSTGPU_P2P", 1);
+
+    /* a driver without devices is the same as no driver */
+    if (yaksuri_hostgpui_global.ndevices <= 0) {
+        yaksuri_hostgpui_global.ndevices = 0;
+        goto fn_exit;
+    }
+
+    *info = (yaksur_gpudriver_info_s *) malloc(sizeof(yaksur_gpudriver_info_s));
+    YAKSU_ERR_CHKANDJUMP(!(*info), rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    (*info)->get_num_devices = get_num_devices;
+    (*info)->check_p2p_comm = check_p2p_comm;
+    (*info)->activate = activate_hook;
+    (*info)->ipack = yaksuri_hostgpui_ipack;
+    (*info)->iunpack = yaksuri_hostgpui_iunpack;
+    (*info)->pup_is_supported = yaksuri_hostgpui_pup_is_supported;
+    (*info)->host_malloc = hostgpu_host_malloc;
+    (*info)->host_free = hostgpu_free;
+    (*info)->gpu_malloc = hostgpu_gpu_malloc;
+    (*info)->gpu_free = hostgpu_free;
+    (*info)->event_destroy = yaksuri_hostgpui_event_destroy;
+    (*info)->event_query = yaksuri_hostgpui_event_query;
+    (*info)->event_synchronize = yaksuri_hostgpui_event_synchronize;
+    (*info)->event_add_dependency = yaksuri_hostgpui_event_add_dependency;
+    (*info)->type_create = type_hook;
+    (*info)->type_free = type_hook;
+    (*info)->info_create = info_hook;
+    (*info)->info_free = info_hook;
+    (*info)->info_keyval_append = info_keyval_append;
+    (*info)->get_ptr_attr = yaksuri_hostgpui_get_ptr_attr;
+    (*info)->get_ptr_range = yaksuri_hostgpui_get_ptr_range;
+    (*info)->finalize = finalize_hook;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    yaksuri_hostgpui_global.ndevices = 0;
+    goto fn_exit;
+}
+
+
+/* public allocation functions, so applications and tests can place
+ * their buffers on the emulated devices */
+
+int yaksa_hostgpu_get_num_devices(int *ndevices)
+{
+    *ndevices = yaksuri_hostgpui_global.ndevices;
+
+    return YAKSA_SUCCESS;
+}
+
+int yaksa_hostgpu_malloc(uintptr_t size, int device, void **ptr)
+{
+    int rc = YAKSA_SUCCESS;
+
+    YAKSU_ERR_CHKANDJUMP(device < 0 || device >= yaksuri_hostgpui_global.ndevices, rc,
+                         YAKSA_ERR__INTERNAL, fn_fail);
+
+    *ptr = hostgpu_gpu_malloc(size, device);
+    YAKSU_ERR_CHKANDJUMP(!(*ptr), rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksa_hostgpu_malloc_host(uintptr_t size, void **ptr)
+{
+    int rc = YAKSA_SUCCESS;
+
+    *ptr = hostgpu_host_malloc(size);
+    YAKSU_ERR_CHKANDJUMP(!(*ptr), rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksa_hostgpu_free(void *ptr)
+{
+    return yaksuri_hostgpui_free(ptr);
+}
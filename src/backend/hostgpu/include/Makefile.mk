@@ -0,0 +1,10 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+AM_CPPFLAGS += -I$(top_srcdir)/src/backend/hostgpu/include
+
+noinst_HEADERS += \
+	src/backend/hostgpu/include/yaksuri_hostgpu_post.h \
+	src/backend/hostgpu/include/yaksuri_hostgpui.h
@@ -0,0 +1,11 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#ifndef YAKSURI_HOSTGPU_POST_H_INCLUDED
+#define YAKSURI_HOSTGPU_POST_H_INCLUDED
+
+int yaksuri_hostgpu_init_hook(yaksur_gpudriver_info_s ** info);
+
+#endif /* YAKSURI_HOSTGPU_POST_H_INCLUDED */
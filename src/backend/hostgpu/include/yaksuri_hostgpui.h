@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#ifndef YAKSURI_HOSTGPUI_H_INCLUDED
+#define YAKSURI_HOSTGPUI_H_INCLUDED
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/* The hostgpu driver emulates GPU devices in host memory.  "Device"
+ * allocations are plain host allocations that are recorded in an
+ * address registry, so the glue layer sees them as GPU buffers.
+ * Each device has a worker thread, started with the first operation
+ * on device memory, that executes the pack/unpack operations queued
+ * on it in order, similar to a CUDA stream, and charges an artificial
+ * latency and bandwidth to every copy that crosses a device
+ * boundary. */
+
+/* the defaults can be overridden through the YAKSA_ENV_HOSTGPU_*
+ * environment variables */
+#define YAKSURI_HOSTGPUI_DEFAULT_NUM_DEVICES  (2)
+#define YAKSURI_HOSTGPUI_DEFAULT_LATENCY_US   (0)
+#define YAKSURI_HOSTGPUI_DEFAULT_BANDWIDTH_MB (0)       /* unlimited */
+
+/* the operations are executed by the seq backend, so these mirror its
+ * iov limits */
+#define YAKSURI_HOSTGPUI_IOV_PUP_THRESHOLD  (16384)
+#define YAKSURI_HOSTGPUI_MAX_IOV_LENGTH     (16384)
+
+/* an event tracks the operations recorded on it; it completes when
+ * all of them are done.  The event is reference counted, as queued
+ * operations can outlive the caller's handle. */
+typedef struct yaksuri_hostgpui_event_s {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int pending;
+    yaksu_atomic_int refcount;
+} yaksuri_hostgpui_event_s;
+
+typedef enum {
+    YAKSURI_HOSTGPUI_OPTYPE__PACK,
+    YAKSURI_HOSTGPUI_OPTYPE__UNPACK,
+    YAKSURI_HOSTGPUI_OPTYPE__WAIT,
+} yaksuri_hostgpui_optype_e;
+
+typedef struct yaksuri_hostgpui_op_s {
+    yaksuri_hostgpui_optype_e optype;
+    const void *inbuf;
+    void *outbuf;
+    uintptr_t count;
+    yaksi_type_s *type;
+    void *tmpbuf;
+    /* copies between devices, or between a device and the host, are
+     * charged the configured bandwidth */
+    bool crosses_device;
+
+    /* the event that this operation completes, or that it waits for
+     * in the case of WAIT operations */
+    yaksuri_hostgpui_event_s *event;
+
+    struct yaksuri_hostgpui_op_s *next;
+} yaksuri_hostgpui_op_s;
+
+typedef struct {
+    yaksuri_hostgpui_op_s *head;
+    yaksuri_hostgpui_op_s *tail;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool shutdown;
+    pthread_t worker;
+} yaksuri_hostgpui_device_s;
+
+typedef struct {
+    int ndevices;
+    yaksuri_hostgpui_device_s *device;
+
+    uintptr_t latency_us;
+    uintptr_t bandwidth_mb;     /* MB/s; zero means unlimited */
+    bool p2p;
+} yaksuri_hostgpui_global_s;
+extern yaksuri_hostgpui_global_s yaksuri_hostgpui_global;
+
+int yaksuri_hostgpui_event_create(yaksuri_hostgpui_event_s ** event);
+int yaksuri_hostgpui_event_record(yaksuri_hostgpui_event_s * event);
+int yaksuri_hostgpui_event_complete(yaksuri_hostgpui_event_s * event);
+int yaksuri_hostgpui_event_release(yaksuri_hostgpui_event_s * event);
+int yaksuri_hostgpui_event_destroy(void *event);
+int yaksuri_hostgpui_event_query(void *event, int *completed);
+int yaksuri_hostgpui_event_synchronize(void *event);
+int yaksuri_hostgpui_event_add_dependency(void *event, int device);
+
+void *yaksuri_hostgpui_malloc(uintptr_t size, yaksur_ptr_attr_s attr);
+int yaksuri_hostgpui_free(void *ptr);
+int yaksuri_hostgpui_get_ptr_attr(const void *buf, yaksur_ptr_attr_s * ptrattr);
+int yaksuri_hostgpui_get_ptr_range(const void *buf, yaksur_ptr_attr_s * ptrattr, uintptr_t * base,
+                                   uintptr_t * size);
+
+int yaksuri_hostgpui_device_init(int device);
+int yaksuri_hostgpui_device_finalize(int device);
+int yaksuri_hostgpui_device_push(int device, yaksuri_hostgpui_op_s * op);
+
+int yaksuri_hostgpui_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                           void *gpu_tmpbuf, int device, yaksi_info_s * info, void **event);
+int yaksuri_hostgpui_iunpack(const void *inbuf, void *outbuf, uintptr_t count,
+                             yaksi_type_s * type, void *gpu_tmpbuf, int device,
+                             yaksi_info_s * info, void **event);
+int yaksuri_hostgpui_pup_is_supported(yaksi_type_s * type, bool * is_supported);
+
+#endif /* YAKSURI_HOSTGPUI_H_INCLUDED */
@@ -0,0 +1,11 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+AM_CPPFLAGS += -I$(top_srcdir)/src/backend/hostgpu/pup
+
+libyaksa_la_SOURCES += \
+	src/backend/hostgpu/pup/yaksuri_hostgpui_event.c \
+	src/backend/hostgpu/pup/yaksuri_hostgpui_get_ptr_attr.c \
+	src/backend/hostgpu/pup/yaksuri_hostgpui_pup.c
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include <stdlib.h>
+#include <sched.h>
+#include "yaksi.h"
+#include "yaksu.h"
+#include "yaksuri_hostgpui.h"
+
+int yaksuri_hostgpui_event_create(yaksuri_hostgpui_event_s ** event)
+{
+    int rc = YAKSA_SUCCESS;
+
+    *event = (yaksuri_hostgpui_event_s *) malloc(sizeof(yaksuri_hostgpui_event_s));
+    YAKSU_ERR_CHKANDJUMP(!(*event), rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    pthread_mutex_init(&(*event)->mutex, NULL);
+    pthread_cond_init(&(*event)->cond, NULL);
+    (*event)->pending = 0;
+    yaksu_atomic_store(&(*event)->refcount, 1);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/* a new operation completes this event; the operation holds a
+ * reference till it is done */
+int yaksuri_hostgpui_event_record(yaksuri_hostgpui_event_s * event)
+{
+    yaksu_atomic_incr(&event->refcount);
+
+    pthread_mutex_lock(&event->mutex);
+    event->pending++;
+    pthread_mutex_unlock(&event->mutex);
+
+    return YAKSA_SUCCESS;
+}
+
+int yaksuri_hostgpui_event_complete(yaksuri_hostgpui_event_s * event)
+{
+    pthread_mutex_lock(&event->mutex);
+    event->pending--;
+    if (event->pending == 0)
+        pthread_cond_broadcast(&event->cond);
+    pthread_mutex_unlock(&event->mutex);
+
+    return yaksuri_hostgpui_event_release(event);
+}
+
+int yaksuri_hostgpui_event_release(yaksuri_hostgpui_event_s * event)
+{
+    int ret = yaksu_atomic_decr(&event->refcount);
+
+    if (ret == 1) {
+        pthread_mutex_destroy(&event->mutex);
+        pthread_cond_destroy(&event->cond);
+        free(event);
+    }
+
+    return YAKSA_SUCCESS;
+}
+
+int yaksuri_hostgpui_event_destroy(void *event)
+{
+    int rc = YAKSA_SUCCESS;
+
+    if (event) {
+        rc = yaksuri_hostgpui_event_release((yaksuri_hostgpui_event_s *) event);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksuri_hostgpui_event_query(void *event, int *completed)
+{
+    yaksuri_hostgpui_event_s *hostgpu_event = (yaksuri_hostgpui_event_s *) event;
+
+    if (hostgpu_event) {
+        pthread_mutex_lock(&hostgpu_event->mutex);
+        *completed = (hostgpu_event->pending == 0);
+        pthread_mutex_unlock(&hostgpu_event->mutex);
+
+        /* the progress engine polls its events in a loop; unlike a
+         * real device, the workers share the CPUs with the polling
+         * threads, so give them a chance to run */
+        if (!*completed)
+            sched_yield();
+    } else {
+        *completed = 1;
+    }
+
+    return YAKSA_SUCCESS;
+}
+
+int yaksuri_hostgpui_event_synchronize(void *event)
+{
+    yaksuri_hostgpui_event_s *hostgpu_event = (yaksuri_hostgpui_event_s *) event;
+
+    if (hostgpu_event) {
+        pthread_mutex_lock(&hostgpu_event->mutex);
+        while (hostgpu_event->pending)
+            pthread_cond_wait(&hostgpu_event->cond, &hostgpu_event->mutex);
+        pthread_mutex_unlock(&hostgpu_event->mutex);
+    }
+
+    return YAKSA_SUCCESS;
+}
+
+/* operations queued on the device after this call do not start
+ * until all of the operations recorded on the event are done */
+int yaksuri_hostgpui_event_add_dependency(void *event, int device)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_hostgpui_op_s *op = NULL;
+
+    if (event == NULL)
+        goto fn_exit;
+
+    op = (yaksuri_hostgpui_op_s *) malloc(sizeof(yaksuri_hostgpui_op_s));
+    YAKSU_ERR_CHKANDJUMP(!op, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    op->optype = YAKSURI_HOSTGPUI_OPTYPE__WAIT;
+    op->event = (yaksuri_hostgpui_event_s *) event;
+    op->next = NULL;
+    yaksu_atomic_incr(&op->event->refcount);
+
+    rc = yaksuri_hostgpui_device_push(device, op);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    if (op) {
+        yaksuri_hostgpui_event_release(op->event);
+        free(op);
+    }
+    goto fn_exit;
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "yaksi.h"
+#include "yaksu.h"
+#include "yaksuri_hostgpui.h"
+
+/* The address registry keeps the allocations of the driver sorted by
+ * their base address, so pointers can be looked up with a binary
+ * search.  Lookups are far more frequent than allocations, so the
+ * registry is protected by a reader-writer lock.  The registry is
+ * statically initialized, as allocations can outlive yaksa_init and
+ * yaksa_finalize.  Every change to the registry unregisters the
+ * affected range, so the pointer-attribute cache of the glue layer
+ * never serves a stale classification. */
+
+#define ALLOC_ALIGNMENT  (64)
+
+typedef struct {
+    uintptr_t base;
+    uintptr_t size;
+    yaksur_ptr_attr_s attr;
+} registry_entry_s;
+
+static registry_entry_s *registry = NULL;
+static uintptr_t registry_len = 0;
+static uintptr_t registry_maxlen = 0;
+static pthread_rwlock_t registry_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/* index of the first entry whose base is larger than addr */
+static uintptr_t registry_upper_bound(uintptr_t addr)
+{
+    uintptr_t lo = 0, hi = registry_len;
+
+    while (lo < hi) {
+        uintptr_t mid = lo + (hi - lo) / 2;
+        if (registry[mid].base <= addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+void *yaksuri_hostgpui_malloc(uintptr_t size, yaksur_ptr_attr_s attr)
+{
+    void *ptr = NULL;
+
+    /* zero-sized allocations still need a unique address */
+    if (posix_memalign(&ptr, ALLOC_ALIGNMENT, size ? size : 1))
+        return NULL;
+
+    pthread_rwlock_wrlock(&registry_lock);
+
+    if (registry_len == registry_maxlen) {
+        uintptr_t maxlen = registry_maxlen ? 2 * registry_maxlen : 64;
+        registry_entry_s *tmp = (registry_entry_s *) realloc(registry,
+                                                             maxlen * sizeof(registry_entry_s));
+        if (tmp == NULL) {
+            pthread_rwlock_unlock(&registry_lock);
+            free(ptr);
+            return NULL;
+        }
+        registry = tmp;
+        registry_maxlen = maxlen;
+    }
+
+    uintptr_t idx = registry_upper_bound((uintptr_t) ptr);
+    memmove(&registry[idx + 1], &registry[idx], (registry_len - idx) * sizeof(registry_entry_s));
+    registry[idx].base = (uintptr_t) ptr;
+    registry[idx].size = size ? size : 1;
+    registry[idx].attr = attr;
+    registry_len++;
+
+    pthread_rwlock_unlock(&registry_lock);
+
+    yaksur_buffer_unregister(ptr, size ? size : 1);
+
+    return ptr;
+}
+
+int yaksuri_hostgpui_free(void *ptr)
+{
+    int rc = YAKSA_SUCCESS;
+
+    if (ptr == NULL)
+        goto fn_exit;
+
+    pthread_rwlock_wrlock(&registry_lock);
+
+    uintptr_t idx = registry_upper_bound((uintptr_t) ptr);
+    if (idx == 0 || registry[idx - 1].base != (uintptr_t) ptr) {
+        pthread_rwlock_unlock(&registry_lock);
+        rc = YAKSA_ERR__INTERNAL;
+        goto fn_fail;
+    }
+
+    uintptr_t size = registry[idx - 1].size;
+    memmove(&registry[idx - 1], &registry[idx], (registry_len - idx) * sizeof(registry_entry_s));
+    registry_len--;
+
+    if (registry_len == 0) {
+        free(registry);
+        registry = NULL;
+        registry_maxlen = 0;
+    }
+
+    pthread_rwlock_unlock(&registry_lock);
+
+    yaksur_buffer_unregister(ptr, size);
+    free(ptr);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksuri_hostgpui_get_ptr_attr(const void *buf, yaksur_ptr_attr_s * ptrattr)
+{
+    uintptr_t addr = (uintptr_t) buf;
+
+    ptrattr->type = YAKSUR_PTR_TYPE__UNREGISTERED_HOST;
+    ptrattr->device = -1;
+
+    pthread_rwlock_rdlock(&registry_lock);
+
+    uintptr_t idx = registry_upper_bound(addr);
+    if (idx && addr < registry[idx - 1].base + registry[idx - 1].size)
+        *ptrattr = registry[idx - 1].attr;
+
+    pthread_rwlock_unlock(&registry_lock);
+
+    return YAKSA_SUCCESS;
+}
+
+/* the attributes hold up to the neighboring allocations */
+int yaksuri_hostgpui_get_ptr_range(const void *buf, yaksur_ptr_attr_s * ptrattr, uintptr_t * base,
+                                   uintptr_t * size)
+{
+    uintptr_t addr = (uintptr_t) buf;
+
+    ptrattr->type = YAKSUR_PTR_TYPE__UNREGISTERED_HOST;
+    ptrattr->device = -1;
+
+    pthread_rwlock_rdlock(&registry_lock);
+
+    uintptr_t idx = registry_upper_bound(addr);
+    if (idx && addr < registry[idx - 1].base + registry[idx - 1].size) {
+        *ptrattr = registry[idx - 1].attr;
+        *base = registry[idx - 1].base;
+        *size = registry[idx - 1].size;
+    } else {
+        *base = idx ? registry[idx - 1].base + registry[idx - 1].size : 0;
+        *size = (idx < registry_len ? registry[idx].base : UINTPTR_MAX) - *base;
+    }
+
+    pthread_rwlock_unlock(&registry_lock);
+
+    return YAKSA_SUCCESS;
+}
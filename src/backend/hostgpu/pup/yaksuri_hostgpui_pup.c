@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "yaksi.h"
+#include "yaksu.h"
+#include "yaksuri_hostgpui.h"
+
+/* the copy takes at least as long as the configured latency and
+ * bandwidth would allow; anything left over is slept off */
+static void charge_copy_cost(const struct timespec *start, uintptr_t nbytes, bool crosses_device)
+{
+    uint64_t ns = (uint64_t) yaksuri_hostgpui_global.latency_us * 1000;
+    if (crosses_device && yaksuri_hostgpui_global.bandwidth_mb)
+        ns += (uint64_t) nbytes *1000 / yaksuri_hostgpui_global.bandwidth_mb;
+
+    if (ns == 0)
+        return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t elapsed = (uint64_t) (now.tv_sec - start->tv_sec) * 1000000000 +
+        (uint64_t) (now.tv_nsec - start->tv_nsec);
+    if (elapsed >= ns)
+        return;
+
+    struct timespec remaining;
+    remaining.tv_sec = (time_t) ((ns - elapsed) / 1000000000);
+    remaining.tv_nsec = (long) ((ns - elapsed) % 1000000000);
+    while (nanosleep(&remaining, &remaining));
+}
+
+static void execute_op(yaksuri_hostgpui_op_s * op)
+{
+    int rc;
+    struct timespec start;
+    uintptr_t nbytes = op->count * op->type->size;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* like a real device, noncontiguous data that leaves the device
+     * is first packed into the device staging buffer */
+    bool use_tmpbuf = (op->tmpbuf && op->crosses_device && !op->type->is_contig);
+
+    if (op->optype == YAKSURI_HOSTGPUI_OPTYPE__PACK) {
+        if (use_tmpbuf) {
+            rc = yaksuri_seq_ipack(op->inbuf, op->tmpbuf, op->count, NULL, op->type);
+            assert(rc == YAKSA_SUCCESS);
+            memcpy(op->outbuf, op->tmpbuf, nbytes);
+        } else {
+            rc = yaksuri_seq_ipack(op->inbuf, op->outbuf, op->count, NULL, op->type);
+            assert(rc == YAKSA_SUCCESS);
+        }
+    } else {
+        if (use_tmpbuf) {
+            memcpy(op->tmpbuf, op->inbuf, nbytes);
+            rc = yaksuri_seq_iunpack(op->tmpbuf, op->outbuf, op->count, NULL, op->type);
+            assert(rc == YAKSA_SUCCESS);
+        } else {
+            rc = yaksuri_seq_iunpack(op->inbuf, op->outbuf, op->count, NULL, op->type);
+            assert(rc == YAKSA_SUCCESS);
+        }
+    }
+
+    charge_copy_cost(&start, nbytes, op->crosses_device);
+}
+
+static void *device_worker_fn(void *arg)
+{
+    yaksuri_hostgpui_device_s *device = (yaksuri_hostgpui_device_s *) arg;
+
+    pthread_mutex_lock(&device->mutex);
+    while (1) {
+        while (device->head == NULL && !device->shutdown)
+            pthread_cond_wait(&device->cond, &device->mutex);
+
+        if (device->head == NULL) {
+            /* no more work and we are shutting down */
+            break;
+        }
+
+        yaksuri_hostgpui_op_s *op = device->head;
+        device->head = op->next;
+        if (device->head == NULL)
+            device->tail = NULL;
+        pthread_mutex_unlock(&device->mutex);
+
+        if (op->optype == YAKSURI_HOSTGPUI_OPTYPE__WAIT) {
+            yaksuri_hostgpui_event_synchronize(op->event);
+            yaksuri_hostgpui_event_release(op->event);
+        } else {
+            execute_op(op);
+            yaksuri_hostgpui_event_complete(op->event);
+        }
+        free(op);
+
+        pthread_mutex_lock(&device->mutex);
+    }
+    pthread_mutex_unlock(&device->mutex);
+
+    return NULL;
+}
+
+int yaksuri_hostgpui_device_init(int devid)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_hostgpui_device_s *device = &yaksuri_hostgpui_global.device[devid];
+
+    device->head = device->tail = NULL;
+    device->shutdown = false;
+    pthread_mutex_init(&device->mutex, NULL);
+    pthread_cond_init(&device->cond, NULL);
+
+    int ret = pthread_create(&device->worker, NULL, device_worker_fn, device);
+    YAKSU_ERR_CHKANDJUMP(ret, rc, YAKSA_ERR__INTERNAL, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    pthread_mutex_destroy(&device->mutex);
+    pthread_cond_destroy(&device->cond);
+    goto fn_exit;
+}
+
+/* the worker drains its queue before exiting */
+int yaksuri_hostgpui_device_finalize(int devid)
+{
+    yaksuri_hostgpui_device_s *device = &yaksuri_hostgpui_global.device[devid];
+
+    pthread_mutex_lock(&device->mutex);
+    device->shutdown = true;
+    pthread_cond_signal(&device->cond);
+    pthread_mutex_unlock(&device->mutex);
+
+    pthread_join(device->worker, NULL);
+
+    pthread_mutex_destroy(&device->mutex);
+    pthread_cond_destroy(&device->cond);
+
+    return YAKSA_SUCCESS;
+}
+
+int yaksuri_hostgpui_device_push(int devid, yaksuri_hostgpui_op_s * op)
+{
+    int rc = YAKSA_SUCCESS;
+
+    YAKSU_ERR_CHKANDJUMP(devid < 0 || devid >= yaksuri_hostgpui_global.ndevices, rc,
+                         YAKSA_ERR__INTERNAL, fn_fail);
+
+    yaksuri_hostgpui_device_s *device = &yaksuri_hostgpui_global.device[devid];
+
+    pthread_mutex_lock(&device->mutex);
+    if (device->tail == NULL) {
+        device->head = device->tail = op;
+    } else {
+        device->tail->next = op;
+        device->tail = op;
+    }
+    pthread_cond_signal(&device->cond);
+    pthread_mutex_unlock(&device->mutex);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksuri_hostgpui_pup_is_supported(yaksi_type_s * type, bool * is_supported)
+{
+    int rc = YAKSA_SUCCESS;
+
+    rc = yaksuri_seq_pup_is_supported(type, is_supported);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    /* the workers cannot fall back to anything else, so reject the
+     * layouts that the seq backend could refuse at execution time */
+    if (*is_supported && !type->is_contig &&
+        type->size / type->num_contig >= YAKSURI_HOSTGPUI_IOV_PUP_THRESHOLD &&
+        type->num_contig > YAKSURI_HOSTGPUI_MAX_IOV_LENGTH)
+        *is_supported = false;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+static bool is_on_device(const void *buf, int device)
+{
+    yaksur_ptr_attr_s attr;
+
+    yaksuri_hostgpui_get_ptr_attr(buf, &attr);
+    return (attr.type == YAKSUR_PTR_TYPE__GPU && attr.device == device);
+}
+
+static int enqueue(yaksuri_hostgpui_optype_e optype, const void *inbuf, void *outbuf,
+                   uintptr_t count, yaksi_type_s * type, void *gpu_tmpbuf, int device,
+                   bool crosses_device, void **event)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_hostgpui_op_s *op = NULL;
+    bool new_event = false;
+
+    if (*event == NULL) {
+        rc = yaksuri_hostgpui_event_create((yaksuri_hostgpui_event_s **) event);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+        new_event = true;
+    }
+
+    op = (yaksuri_hostgpui_op_s *) malloc(sizeof(yaksuri_hostgpui_op_s));
+    YAKSU_ERR_CHKANDJUMP(!op, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    op->optype = optype;
+    op->inbuf = inbuf;
+    op->outbuf = outbuf;
+    op->count = count;
+    op->type = type;
+    op->tmpbuf = gpu_tmpbuf;
+    op->crosses_device = crosses_device;
+    op->event = (yaksuri_hostgpui_event_s *) * event;
+    op->next = NULL;
+
+    rc = yaksuri_hostgpui_event_record(op->event);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksuri_hostgpui_device_push(device, op);
+    if (rc) {
+        yaksuri_hostgpui_event_complete(op->event);
+        goto fn_fail;
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    free(op);
+    if (new_event) {
+        yaksuri_hostgpui_event_release((yaksuri_hostgpui_event_s *) * event);
+        *event = NULL;
+    }
+    goto fn_exit;
+}
+
+int yaksuri_hostgpui_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                           void *gpu_tmpbuf, int device, yaksi_info_s * info, void **event)
+{
+    bool crosses_device = !is_on_device((const char *) inbuf + type->true_lb, device) ||
+        !is_on_device(outbuf, device);
+
+    return enqueue(YAKSURI_HOSTGPUI_OPTYPE__PACK, inbuf, outbuf, count, type, gpu_tmpbuf, device,
+                   crosses_device, event);
+}
+
+int yaksuri_hostgpui_iunpack(const void *inbuf, void *outbuf, uintptr_t count,
+                             yaksi_type_s * type, void *gpu_tmpbuf, int device,
+                             yaksi_info_s * info, void **event)
+{
+    bool crosses_device = !is_on_device(inbuf, device) ||
+        !is_on_device((const char *) outbuf + type->true_lb, device);
+
+    return enqueue(YAKSURI_HOSTGPUI_OPTYPE__UNPACK, inbuf, outbuf, count, type, gpu_tmpbuf,
+                   device, crosses_device, event);
+}
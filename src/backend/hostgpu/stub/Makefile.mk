@@ -0,0 +1,12 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+AM_CPPFLAGS += -I$(top_srcdir)/src/backend/hostgpu/stub
+
+noinst_HEADERS += \
+	src/backend/hostgpu/stub/yaksuri_hostgpu_post.h
+
+libyaksa_la_SOURCES += \
+	src/backend/hostgpu/stub/yaksuri_hostgpu_stub.c
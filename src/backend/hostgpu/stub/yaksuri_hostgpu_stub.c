@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksa.h"
+
+/* the host-emulated GPU driver was not built, so there are no
+ * devices to allocate memory on */
+
+int yaksa_hostgpu_get_num_devices(int *ndevices)
+{
+    *ndevices = 0;
+
+    return YAKSA_SUCCESS;
+}
+
+int yaksa_hostgpu_malloc(uintptr_t size, int device, void **ptr)
+{
+    *ptr = NULL;
+
+    return YAKSA_ERR__NOT_SUPPORTED;
+}
+
+int yaksa_hostgpu_malloc_host(uintptr_t size, void **ptr)
+{
+    *ptr = NULL;
+
+    return YAKSA_ERR__NOT_SUPPORTED;
+}
+
+int yaksa_hostgpu_free(void *ptr)
+{
+    return YAKSA_ERR__NOT_SUPPORTED;
+}
@@ -0,0 +1,27 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+
+##########################################################################
+##### capture user arguments
+##########################################################################
+
+# --enable-hostgpu
+AC_ARG_ENABLE([hostgpu],AS_HELP_STRING([--enable-hostgpu],[builds a GPU driver that emulates
+                                       devices in host memory, to exercise the staged
+                                       pipeline without GPU hardware]),,
+              [enable_hostgpu=no])
+
+
+##########################################################################
+##### analyze the user arguments and setup internal infrastructure
+##########################################################################
+
+if test "${enable_hostgpu}" = "yes" ; then
+    AC_DEFINE([HAVE_HOSTGPU],[1],[Define if the host-emulated GPU driver is enabled])
+    supported_backends="${supported_backends},hostgpu"
+fi
+AM_CONDITIONAL([BUILD_HOSTGPU_BACKEND], [test x${enable_hostgpu} = xyes])
+AM_CONDITIONAL([BUILD_HOSTGPU_TESTS], [test x${enable_hostgpu} = xyes])
@@ -12,12 +12,12 @@
 
 int yaksuri_seq_init_hook(void)
 {
-    return YAKSA_SUCCESS;
+    return yaksuri_seqi_async_init();
 }
 
 int yaksuri_seq_finalize_hook(void)
 {
-    return YAKSA_SUCCESS;
+    return yaksuri_seqi_async_finalize();
 }
 
 int yaksuri_seq_type_create_hook(yaksi_type_s * type)
@@ -56,6 +56,7 @@ int yaksuri_seq_info_create_hook(yaksi_info_s * info)
     /* set default values for info keys */
     seq->iov_pack_threshold = YAKSURI_SEQI_INFO__DEFAULT_IOV_PUP_THRESHOLD;
     seq->iov_unpack_threshold = YAKSURI_SEQI_INFO__DEFAULT_IOV_PUP_THRESHOLD;
+    seq->async_threshold = YAKSURI_SEQI_INFO__DEFAULT_ASYNC_THRESHOLD;
 
     info->backend.seq.priv = (void *) seq;
 
@@ -83,6 +84,9 @@ int yaksuri_seq_info_keyval_append(yaksi_info_s * info, const char *key, const v
     } else if (!strncmp(key, "yaksa_seq_iov_unpack_threshold", YAKSA_INFO_MAX_KEYLEN)) {
         assert(vallen == sizeof(uintptr_t));
         seq->iov_unpack_threshold = (uintptr_t) val;
+    } else if (!strncmp(key, "yaksa_seq_async_threshold", YAKSA_INFO_MAX_KEYLEN)) {
+        assert(vallen == sizeof(uintptr_t));
+        seq->async_threshold = (uintptr_t) val;
     }
 
     return YAKSA_SUCCESS;
@@ -20,5 +20,31 @@ int yaksuri_seq_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_in
                       yaksi_type_s * type);
 int yaksuri_seq_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_info_s * info,
                         yaksi_type_s * type);
+int yaksuri_seq_async_is_enabled(uintptr_t count, yaksi_type_s * type, yaksi_info_s * info,
+                                 bool * is_enabled);
+int yaksuri_seq_ipack_async(const void *inbuf, void *outbuf, uintptr_t count, yaksi_info_s * info,
+                            yaksi_type_s * type, yaksi_request_s * request);
+int yaksuri_seq_iunpack_async(const void *inbuf, void *outbuf, uintptr_t count,
+                              yaksi_info_s * info, yaksi_type_s * type, yaksi_request_s * request);
+int yaksuri_seq_ipack_async_counter(const void *inbuf, void *outbuf, uintptr_t count,
+                                    yaksi_info_s * info, yaksi_type_s * type,
+                                    yaksu_atomic_int * counter);
+int yaksuri_seq_iunpack_async_counter(const void *inbuf, void *outbuf, uintptr_t count,
+                                      yaksi_info_s * info, yaksi_type_s * type,
+                                      yaksu_atomic_int * counter);
+int yaksuri_seq_ipack_batch_async(const yaksi_batch_desc_s * descs, uintptr_t ndescs,
+                                  void *outbuf, yaksi_info_s * info, yaksi_request_s * request);
+int yaksuri_seq_iunpack_batch_async(const void *inbuf, const yaksi_batch_desc_s * descs,
+                                    uintptr_t ndescs, yaksi_info_s * info,
+                                    yaksi_request_s * request);
+int yaksuri_seq_plan_create(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                            yaksi_info_s * info, bool is_pack, void **plan);
+int yaksuri_seq_plan_execute(void *plan);
+int yaksuri_seq_plan_free(void *plan);
+int yaksuri_seq_pack_iov(const void *inbuf, uintptr_t count, yaksi_type_s * type,
+                         uintptr_t iov_offset, void *tmpbuf, uintptr_t max_tmpbuf_bytes,
+                         struct iovec *iov, uintptr_t max_iov_len, uintptr_t * actual_iov_len,
+                         uintptr_t * actual_tmpbuf_bytes, uintptr_t * actual_segments,
+                         yaksi_info_s * info);
 
 #endif /* YAKSURI_SEQ_H_INCLUDED */
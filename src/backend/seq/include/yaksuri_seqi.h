@@ -14,12 +14,23 @@ typedef struct yaksuri_seqi_type_s {
 } yaksuri_seqi_type_s;
 
 #define YAKSURI_SEQI_INFO__DEFAULT_IOV_PUP_THRESHOLD   (16384)
+#define YAKSURI_SEQI_INFO__DEFAULT_ASYNC_THRESHOLD     (UINTPTR_MAX)
+
+#define YAKSURI_SEQI_MAX_IOV_LENGTH (16384)
 
 typedef struct {
     uintptr_t iov_pack_threshold;
     uintptr_t iov_unpack_threshold;
+    uintptr_t async_threshold;
 } yaksuri_seqi_info_s;
 
+typedef enum {
+    YAKSURI_SEQI_ASYNC_OPTYPE__PACK,
+    YAKSURI_SEQI_ASYNC_OPTYPE__UNPACK,
+} yaksuri_seqi_async_optype_e;
+
 int yaksuri_seqi_populate_pupfns(yaksi_type_s * type);
+int yaksuri_seqi_async_init(void);
+int yaksuri_seqi_async_finalize(void);
 
 #endif /* YAKSURI_SEQI_H_INCLUDED */
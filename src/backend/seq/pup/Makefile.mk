@@ -5,5 +5,8 @@
 
 AM_CPPFLAGS += -I$(top_srcdir)/src/backend/seq/pup
 
+libyaksa_la_SOURCES += \
+	src/backend/seq/pup/yaksuri_seq_async.c
+
 include src/backend/seq/pup/Makefile.pup.mk
 include src/backend/seq/pup/Makefile.populate_pupfns.mk
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include "yaksuri_seqi.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+/* host-to-host operations that are larger than the async threshold
+ * are queued to a worker thread, so the calling thread can return
+ * immediately.  The request completion counter is incremented when
+ * the operation is queued and decremented by the worker once the
+ * data has been copied. */
+
+/* an operation covers one or more descriptors that share the same
+ * contiguous buffer; batches are queued as a single operation per
+ * node, so the workers see the whole batch at once */
+typedef struct yaksuri_seqi_async_op_s {
+    yaksuri_seqi_async_optype_e optype;
+    void *contigbuf;
+    yaksi_info_s *info;
+    /* operations complete either a request or a caller-owned
+     * counter */
+    yaksi_request_s *request;
+    yaksu_atomic_int *counter;
+
+    struct yaksuri_seqi_async_op_s *next;
+
+    uintptr_t ndescs;
+    yaksi_batch_desc_s descs[];
+} yaksuri_seqi_async_op_s;
+
+/* each NUMA node has its own queue and worker thread, which is bound
+ * to the CPUs of that node, so the copies are performed close to the
+ * memory of the user buffer */
+typedef struct {
+    yaksuri_seqi_async_op_s *head;
+    yaksuri_seqi_async_op_s *tail;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool worker_started;
+    bool shutdown;
+    int node;
+    pthread_t worker;
+} async_queue_s;
+
+static async_queue_s *async_queues = NULL;
+static int async_nqueues = 0;
+
+static void *async_worker_fn(void *arg)
+{
+    int rc;
+    async_queue_s *queue = (async_queue_s *) arg;
+
+    /* binding is only a performance hint, so ignore failures */
+    yaksu_numa_bind_thread(queue->node);
+
+    pthread_mutex_lock(&queue->mutex);
+    while (1) {
+        while (queue->head == NULL && !queue->shutdown)
+            pthread_cond_wait(&queue->cond, &queue->mutex);
+
+        if (queue->head == NULL) {
+            /* no more work and we are shutting down */
+            break;
+        }
+
+        yaksuri_seqi_async_op_s *op = queue->head;
+        queue->head = op->next;
+        if (queue->head == NULL)
+            queue->tail = NULL;
+        pthread_mutex_unlock(&queue->mutex);
+
+        for (uintptr_t i = 0; i < op->ndescs; i++) {
+            yaksi_batch_desc_s *desc = &op->descs[i];
+            char *cbuf = (char *) op->contigbuf + desc->offset;
+
+            if (op->optype == YAKSURI_SEQI_ASYNC_OPTYPE__PACK) {
+                rc = yaksuri_seq_ipack(desc->buf, cbuf, desc->count, op->info, desc->type);
+            } else {
+                rc = yaksuri_seq_iunpack(cbuf, desc->buf, desc->count, op->info, desc->type);
+            }
+            /* the eligibility check ensures that the seq backend can
+             * handle this operation, so there is no fallback path
+             * here */
+            assert(rc == YAKSA_SUCCESS);
+        }
+
+        if (op->request) {
+            rc = yaksi_request_complete(op->request);
+            assert(rc == YAKSA_SUCCESS);
+        } else {
+            yaksu_atomic_decr(op->counter);
+        }
+        free(op);
+
+        pthread_mutex_lock(&queue->mutex);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+
+    return NULL;
+}
+
+int yaksuri_seqi_async_init(void)
+{
+    int rc = YAKSA_SUCCESS;
+
+    rc = yaksu_numa_get_num_nodes(&async_nqueues);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    async_queues = (async_queue_s *) malloc(async_nqueues * sizeof(async_queue_s));
+    YAKSU_ERR_CHKANDJUMP(!async_queues, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    for (int i = 0; i < async_nqueues; i++) {
+        async_queues[i].head = async_queues[i].tail = NULL;
+        pthread_mutex_init(&async_queues[i].mutex, NULL);
+        pthread_cond_init(&async_queues[i].cond, NULL);
+        async_queues[i].worker_started = false;
+        async_queues[i].shutdown = false;
+        async_queues[i].node = i;
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksuri_seq_async_is_enabled(uintptr_t count, yaksi_type_s * type, yaksi_info_s * info,
+                                 bool * is_enabled)
+{
+    int rc = YAKSA_SUCCESS;
+
+    *is_enabled = false;
+
+    if (info == NULL)
+        goto fn_exit;
+
+    yaksuri_seqi_info_s *seq_info = (yaksuri_seqi_info_s *) info->backend.seq.priv;
+    if (count * type->size < seq_info->async_threshold)
+        goto fn_exit;
+
+    /* layouts with too many segments for the iov path can return
+     * NOT_SUPPORTED from the seq backend, which needs to be handled
+     * by the caller synchronously */
+    if (!type->is_contig && type->num_contig > YAKSURI_SEQI_MAX_IOV_LENGTH)
+        goto fn_exit;
+
+    *is_enabled = true;
+
+  fn_exit:
+    return rc;
+}
+
+/* queue the operation on the node that owns the noncontiguous side
+ * of the copy, falling back to the contiguous side */
+static int desc_get_node(const yaksi_batch_desc_s * desc, void *contigbuf, int *node)
+{
+    int rc = YAKSA_SUCCESS;
+
+    if (async_nqueues == 1) {
+        *node = 0;
+        goto fn_exit;
+    }
+
+    rc = yaksu_numa_get_node((const char *) desc->buf + desc->type->true_lb, node);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+    if (*node == YAKSU_NUMA_NODE__UNKNOWN) {
+        rc = yaksu_numa_get_node((const char *) contigbuf + desc->offset, node);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+    if (*node < 0 || *node >= async_nqueues)
+        *node = 0;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+static int queue_push(async_queue_s * queue, yaksuri_seqi_async_op_s * op)
+{
+    int rc = YAKSA_SUCCESS;
+
+    pthread_mutex_lock(&queue->mutex);
+    if (!queue->worker_started) {
+        int ret = pthread_create(&queue->worker, NULL, async_worker_fn, queue);
+        if (ret) {
+            pthread_mutex_unlock(&queue->mutex);
+            rc = YAKSA_ERR__INTERNAL;
+            goto fn_fail;
+        }
+        queue->worker_started = true;
+    }
+
+    if (op->request)
+        yaksu_atomic_incr(&op->request->cc);
+
+    if (queue->tail == NULL) {
+        queue->head = queue->tail = op;
+    } else {
+        queue->tail->next = op;
+        queue->tail = op;
+    }
+    pthread_cond_signal(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+static int async_enqueue(yaksuri_seqi_async_optype_e optype, void *contigbuf,
+                         const yaksi_batch_desc_s * descs, uintptr_t ndescs,
+                         yaksi_info_s * info, yaksi_request_s * request,
+                         yaksu_atomic_int * counter)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_seqi_async_op_s *op = NULL;
+    int *nodes;
+
+    nodes = (int *) malloc(ndescs * sizeof(int));
+    YAKSU_ERR_CHKANDJUMP(!nodes, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    for (uintptr_t i = 0; i < ndescs; i++) {
+        rc = desc_get_node(&descs[i], contigbuf, &nodes[i]);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    for (int node = 0; node < async_nqueues; node++) {
+        uintptr_t n = 0;
+        for (uintptr_t i = 0; i < ndescs; i++)
+            if (nodes[i] == node)
+                n++;
+        if (n == 0)
+            continue;
+
+        op = (yaksuri_seqi_async_op_s *) malloc(sizeof(yaksuri_seqi_async_op_s) +
+                                                n * sizeof(yaksi_batch_desc_s));
+        YAKSU_ERR_CHKANDJUMP(!op, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+        op->optype = optype;
+        op->contigbuf = contigbuf;
+        op->info = info;
+        op->request = request;
+        op->counter = counter;
+        op->next = NULL;
+        op->ndescs = 0;
+        for (uintptr_t i = 0; i < ndescs; i++)
+            if (nodes[i] == node)
+                op->descs[op->ndescs++] = descs[i];
+
+        rc = queue_push(&async_queues[node], op);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+        op = NULL;
+    }
+
+  fn_exit:
+    free(nodes);
+    return rc;
+  fn_fail:
+    free(op);
+    goto fn_exit;
+}
+
+int yaksuri_seq_ipack_async(const void *inbuf, void *outbuf, uintptr_t count, yaksi_info_s * info,
+                            yaksi_type_s * type, yaksi_request_s * request)
+{
+    yaksi_batch_desc_s desc = { (void *) inbuf, count, type, 0 };
+    return async_enqueue(YAKSURI_SEQI_ASYNC_OPTYPE__PACK, outbuf, &desc, 1, info, request, NULL);
+}
+
+int yaksuri_seq_iunpack_async(const void *inbuf, void *outbuf, uintptr_t count,
+                              yaksi_info_s * info, yaksi_type_s * type, yaksi_request_s * request)
+{
+    yaksi_batch_desc_s desc = { outbuf, count, type, 0 };
+    return async_enqueue(YAKSURI_SEQI_ASYNC_OPTYPE__UNPACK, (void *) inbuf, &desc, 1, info,
+                         request, NULL);
+}
+
+int yaksuri_seq_ipack_batch_async(const yaksi_batch_desc_s * descs, uintptr_t ndescs,
+                                  void *outbuf, yaksi_info_s * info, yaksi_request_s * request)
+{
+    return async_enqueue(YAKSURI_SEQI_ASYNC_OPTYPE__PACK, outbuf, descs, ndescs, info, request,
+                         NULL);
+}
+
+int yaksuri_seq_iunpack_batch_async(const void *inbuf, const yaksi_batch_desc_s * descs,
+                                    uintptr_t ndescs, yaksi_info_s * info,
+                                    yaksi_request_s * request)
+{
+    return async_enqueue(YAKSURI_SEQI_ASYNC_OPTYPE__UNPACK, (void *) inbuf, descs, ndescs, info,
+                         request, NULL);
+}
+
+/* the counter is decremented once, so the descriptor is queued as a
+ * single operation */
+int yaksuri_seq_ipack_async_counter(const void *inbuf, void *outbuf, uintptr_t count,
+                                    yaksi_info_s * info, yaksi_type_s * type,
+                                    yaksu_atomic_int * counter)
+{
+    yaksi_batch_desc_s desc = { (void *) inbuf, count, type, 0 };
+    return async_enqueue(YAKSURI_SEQI_ASYNC_OPTYPE__PACK, outbuf, &desc, 1, info, NULL, counter);
+}
+
+int yaksuri_seq_iunpack_async_counter(const void *inbuf, void *outbuf, uintptr_t count,
+                                      yaksi_info_s * info, yaksi_type_s * type,
+                                      yaksu_atomic_int * counter)
+{
+    yaksi_batch_desc_s desc = { outbuf, count, type, 0 };
+    return async_enqueue(YAKSURI_SEQI_ASYNC_OPTYPE__UNPACK, (void *) inbuf, &desc, 1, info, NULL,
+                         counter);
+}
+
+int yaksuri_seqi_async_finalize(void)
+{
+    int rc = YAKSA_SUCCESS;
+
+    for (int i = 0; i < async_nqueues; i++) {
+        async_queue_s *queue = &async_queues[i];
+
+        pthread_mutex_lock(&queue->mutex);
+        queue->shutdown = true;
+        pthread_cond_signal(&queue->cond);
+        pthread_mutex_unlock(&queue->mutex);
+
+        if (queue->worker_started)
+            pthread_join(queue->worker, NULL);
+
+        pthread_mutex_destroy(&queue->mutex);
+        pthread_cond_destroy(&queue->cond);
+    }
+
+    free(async_queues);
+    async_queues = NULL;
+    async_nqueues = 0;
+
+    return rc;
+}
@@ -9,8 +9,6 @@
 #include <assert.h>
 #include <stdlib.h>
 
-#define MAX_IOV_LENGTH (16384)
-
 int yaksuri_seq_pup_is_supported(yaksi_type_s * type, bool * is_supported)
 {
     int rc = YAKSA_SUCCESS;
@@ -42,10 +40,10 @@ int yaksuri_seq_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_in
         struct iovec *iov;
         uintptr_t actual_iov_len;
 
-        if (type->num_contig * count <= MAX_IOV_LENGTH) {
+        if (type->num_contig * count <= YAKSURI_SEQI_MAX_IOV_LENGTH) {
             iov = (struct iovec *) malloc(type->num_contig * count * sizeof(struct iovec));
 
-            rc = yaksi_iov(inbuf, count, type, 0, iov, MAX_IOV_LENGTH, &actual_iov_len);
+            rc = yaksi_iov(inbuf, count, type, 0, iov, YAKSURI_SEQI_MAX_IOV_LENGTH, &actual_iov_len);
             YAKSU_ERR_CHECK(rc, fn_fail);
             assert(actual_iov_len == type->num_contig * count);
 
@@ -56,14 +54,14 @@ int yaksuri_seq_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_in
             }
 
             free(iov);
-        } else if (type->num_contig <= MAX_IOV_LENGTH) {
+        } else if (type->num_contig <= YAKSURI_SEQI_MAX_IOV_LENGTH) {
             iov = (struct iovec *) malloc(type->num_contig * sizeof(struct iovec));
 
             uintptr_t iov_offset = 0;
             char *dbuf = (char *) outbuf;
             const char *sbuf = (const char *) inbuf;
             for (uintptr_t i = 0; i < count; i++) {
-                rc = yaksi_iov(sbuf, 1, type, iov_offset, iov, MAX_IOV_LENGTH, &actual_iov_len);
+                rc = yaksi_iov(sbuf, 1, type, iov_offset, iov, YAKSURI_SEQI_MAX_IOV_LENGTH, &actual_iov_len);
                 YAKSU_ERR_CHECK(rc, fn_fail);
                 assert(actual_iov_len == type->num_contig);
 
@@ -110,10 +108,10 @@ int yaksuri_seq_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_
         struct iovec *iov;
         uintptr_t actual_iov_len;
 
-        if (type->num_contig * count <= MAX_IOV_LENGTH) {
+        if (type->num_contig * count <= YAKSURI_SEQI_MAX_IOV_LENGTH) {
             iov = (struct iovec *) malloc(type->num_contig * count * sizeof(struct iovec));
 
-            rc = yaksi_iov(outbuf, count, type, 0, iov, MAX_IOV_LENGTH, &actual_iov_len);
+            rc = yaksi_iov(outbuf, count, type, 0, iov, YAKSURI_SEQI_MAX_IOV_LENGTH, &actual_iov_len);
             YAKSU_ERR_CHECK(rc, fn_fail);
             assert(actual_iov_len == type->num_contig * count);
 
@@ -124,14 +122,14 @@ int yaksuri_seq_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_
             }
 
             free(iov);
-        } else if (type->num_contig <= MAX_IOV_LENGTH) {
+        } else if (type->num_contig <= YAKSURI_SEQI_MAX_IOV_LENGTH) {
             iov = (struct iovec *) malloc(type->num_contig * sizeof(struct iovec));
 
             uintptr_t iov_offset = 0;
             char *dbuf = (char *) outbuf;
             const char *sbuf = (const char *) inbuf;
             for (uintptr_t i = 0; i < count; i++) {
-                rc = yaksi_iov(dbuf, 1, type, iov_offset, iov, MAX_IOV_LENGTH, &actual_iov_len);
+                rc = yaksi_iov(dbuf, 1, type, iov_offset, iov, YAKSURI_SEQI_MAX_IOV_LENGTH, &actual_iov_len);
                 YAKSU_ERR_CHECK(rc, fn_fail);
                 assert(actual_iov_len == type->num_contig);
 
@@ -159,3 +157,246 @@ int yaksuri_seq_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_
   fn_fail:
     goto fn_exit;
 }
+
+int yaksuri_seq_pack_iov(const void *inbuf, uintptr_t count, yaksi_type_s * type,
+                         uintptr_t iov_offset, void *tmpbuf, uintptr_t max_tmpbuf_bytes,
+                         struct iovec *iov, uintptr_t max_iov_len, uintptr_t * actual_iov_len,
+                         uintptr_t * actual_tmpbuf_bytes, uintptr_t * actual_segments,
+                         yaksi_info_s * info)
+{
+    int rc = YAKSA_SUCCESS;
+    struct iovec *seg = NULL;
+
+    uintptr_t iov_pack_threshold = YAKSURI_SEQI_INFO__DEFAULT_IOV_PUP_THRESHOLD;
+    if (info) {
+        yaksuri_seqi_info_s *seq_info = (yaksuri_seqi_info_s *) info->backend.seq.priv;
+        iov_pack_threshold = seq_info->iov_pack_threshold;
+    }
+
+    *actual_iov_len = 0;
+    *actual_tmpbuf_bytes = 0;
+    *actual_segments = 0;
+
+    uintptr_t total_segments;
+    if (type->is_contig)
+        total_segments = 1;
+    else
+        total_segments = count * type->num_contig;
+
+    if (iov_offset >= total_segments || max_iov_len == 0)
+        goto fn_exit;
+
+    uintptr_t seg_len = YAKSU_MIN(total_segments - iov_offset, YAKSURI_SEQI_MAX_IOV_LENGTH);
+    seg = (struct iovec *) malloc(seg_len * sizeof(struct iovec));
+    YAKSU_ERR_CHKANDJUMP(!seg, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    /* walk the segments of the layout in batches, referencing the
+     * large segments in place and copying the small ones into the
+     * staging buffer.  Adjacent pieces (staged or in place) are
+     * merged into a single iov element. */
+    char *tbuf = (char *) tmpbuf;
+    bool last_is_staged = false;
+    uintptr_t idx = iov_offset;
+    while (idx < total_segments) {
+        uintptr_t nseg;
+
+        if (type->is_contig) {
+            seg[0].iov_base = (char *) inbuf + type->true_lb;
+            seg[0].iov_len = count * type->size;
+            nseg = 1;
+        } else {
+            rc = yaksi_iov(inbuf, count, type, idx, seg, seg_len, &nseg);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+            assert(nseg);
+        }
+
+        for (uintptr_t i = 0; i < nseg; i++) {
+            struct iovec *last = *actual_iov_len ? &iov[*actual_iov_len - 1] : NULL;
+
+            if (seg[i].iov_len >= iov_pack_threshold) {
+                if (last && !last_is_staged &&
+                    (char *) last->iov_base + last->iov_len == (char *) seg[i].iov_base) {
+                    last->iov_len += seg[i].iov_len;
+                } else {
+                    if (*actual_iov_len == max_iov_len)
+                        goto fn_exit;
+                    iov[*actual_iov_len] = seg[i];
+                    (*actual_iov_len)++;
+                }
+                last_is_staged = false;
+            } else {
+                if (*actual_tmpbuf_bytes + seg[i].iov_len > max_tmpbuf_bytes)
+                    goto fn_exit;
+
+                char *dbuf = tbuf + *actual_tmpbuf_bytes;
+                if (last && last_is_staged) {
+                    last->iov_len += seg[i].iov_len;
+                } else {
+                    if (*actual_iov_len == max_iov_len)
+                        goto fn_exit;
+                    iov[*actual_iov_len].iov_base = dbuf;
+                    iov[*actual_iov_len].iov_len = seg[i].iov_len;
+                    (*actual_iov_len)++;
+                }
+                memcpy(dbuf, seg[i].iov_base, seg[i].iov_len);
+                *actual_tmpbuf_bytes += seg[i].iov_len;
+                last_is_staged = true;
+            }
+
+            (*actual_segments)++;
+            idx++;
+        }
+    }
+
+  fn_exit:
+    free(seg);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/* a persistent operation resolves the strategy of yaksuri_seq_ipack
+ * and yaksuri_seq_iunpack once: contiguous and iov-eligible layouts
+ * keep their segment list, so that executing the plan is a plain
+ * sequence of memcpys, and all other layouts keep the kernel */
+typedef struct {
+    enum {
+        YAKSURI_SEQI_PLAN_KIND__IOV,
+        YAKSURI_SEQI_PLAN_KIND__KERNEL,
+    } kind;
+    bool is_pack;
+
+    const void *inbuf;
+    void *outbuf;
+    uintptr_t count;
+    yaksi_type_s *type;
+    int (*fn) (const void *inbuf, void *outbuf, uintptr_t count, struct yaksi_type_s *);
+
+    /* the segments of the noncontiguous buffer, which are repeated
+     * nelems times with the type extent as the stride */
+    struct iovec *iov;
+    uintptr_t iov_len;
+    uintptr_t nelems;
+} yaksuri_seqi_plan_s;
+
+int yaksuri_seq_plan_create(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                            yaksi_info_s * info, bool is_pack, void **plan)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_seqi_type_s *seq_type = (yaksuri_seqi_type_s *) type->backend.seq.priv;
+    yaksuri_seqi_plan_s *seq_plan;
+
+    seq_plan = (yaksuri_seqi_plan_s *) malloc(sizeof(yaksuri_seqi_plan_s));
+    YAKSU_ERR_CHKANDJUMP(!seq_plan, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    seq_plan->is_pack = is_pack;
+    seq_plan->inbuf = inbuf;
+    seq_plan->outbuf = outbuf;
+    seq_plan->count = count;
+    seq_plan->type = type;
+    seq_plan->fn = NULL;
+    seq_plan->iov = NULL;
+    seq_plan->iov_len = 0;
+    seq_plan->nelems = 1;
+
+    uintptr_t iov_pup_threshold = YAKSURI_SEQI_INFO__DEFAULT_IOV_PUP_THRESHOLD;
+    if (info) {
+        yaksuri_seqi_info_s *seq_info = (yaksuri_seqi_info_s *) info->backend.seq.priv;
+        iov_pup_threshold = is_pack ? seq_info->iov_pack_threshold :
+            seq_info->iov_unpack_threshold;
+    }
+
+    const void *buf = is_pack ? inbuf : (const void *) outbuf;
+
+    if (type->is_contig) {
+        seq_plan->kind = YAKSURI_SEQI_PLAN_KIND__IOV;
+        seq_plan->iov = (struct iovec *) malloc(sizeof(struct iovec));
+        YAKSU_ERR_CHKANDJUMP(!seq_plan->iov, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+        seq_plan->iov[0].iov_base = (char *) buf + type->true_lb;
+        seq_plan->iov[0].iov_len = type->size * count;
+        seq_plan->iov_len = 1;
+    } else if (type->size / type->num_contig >= iov_pup_threshold) {
+        uintptr_t nelems;
+        if (type->num_contig * count <= YAKSURI_SEQI_MAX_IOV_LENGTH) {
+            nelems = count;
+            seq_plan->nelems = 1;
+        } else if (type->num_contig <= YAKSURI_SEQI_MAX_IOV_LENGTH) {
+            nelems = 1;
+            seq_plan->nelems = count;
+        } else {
+            rc = YAKSA_ERR__NOT_SUPPORTED;
+            goto fn_fail;
+        }
+
+        seq_plan->kind = YAKSURI_SEQI_PLAN_KIND__IOV;
+        seq_plan->iov = (struct iovec *) malloc(type->num_contig * nelems * sizeof(struct iovec));
+        YAKSU_ERR_CHKANDJUMP(!seq_plan->iov, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+        rc = yaksi_iov(buf, nelems, type, 0, seq_plan->iov, YAKSURI_SEQI_MAX_IOV_LENGTH,
+                       &seq_plan->iov_len);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+        assert(seq_plan->iov_len == type->num_contig * nelems);
+    } else if (is_pack ? seq_type->pack != NULL : seq_type->unpack != NULL) {
+        seq_plan->kind = YAKSURI_SEQI_PLAN_KIND__KERNEL;
+        seq_plan->fn = is_pack ? seq_type->pack : seq_type->unpack;
+    } else {
+        rc = YAKSA_ERR__NOT_SUPPORTED;
+        goto fn_fail;
+    }
+
+    *plan = seq_plan;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    if (seq_plan)
+        free(seq_plan->iov);
+    free(seq_plan);
+    goto fn_exit;
+}
+
+int yaksuri_seq_plan_execute(void *plan)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_seqi_plan_s *seq_plan = (yaksuri_seqi_plan_s *) plan;
+
+    if (seq_plan->kind == YAKSURI_SEQI_PLAN_KIND__KERNEL) {
+        rc = seq_plan->fn(seq_plan->inbuf, seq_plan->outbuf, seq_plan->count, seq_plan->type);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    } else if (seq_plan->is_pack) {
+        char *dbuf = (char *) seq_plan->outbuf;
+        for (uintptr_t i = 0; i < seq_plan->nelems; i++) {
+            uintptr_t disp = i * seq_plan->type->extent;
+            for (uintptr_t j = 0; j < seq_plan->iov_len; j++) {
+                memcpy(dbuf, (const char *) seq_plan->iov[j].iov_base + disp,
+                       seq_plan->iov[j].iov_len);
+                dbuf += seq_plan->iov[j].iov_len;
+            }
+        }
+    } else {
+        const char *sbuf = (const char *) seq_plan->inbuf;
+        for (uintptr_t i = 0; i < seq_plan->nelems; i++) {
+            uintptr_t disp = i * seq_plan->type->extent;
+            for (uintptr_t j = 0; j < seq_plan->iov_len; j++) {
+                memcpy((char *) seq_plan->iov[j].iov_base + disp, sbuf, seq_plan->iov[j].iov_len);
+                sbuf += seq_plan->iov[j].iov_len;
+            }
+        }
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksuri_seq_plan_free(void *plan)
+{
+    yaksuri_seqi_plan_s *seq_plan = (yaksuri_seqi_plan_s *) plan;
+
+    free(seq_plan->iov);
+    free(seq_plan);
+
+    return YAKSA_SUCCESS;
+}
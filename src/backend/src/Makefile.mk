@@ -7,6 +7,8 @@ AM_CPPFLAGS += -I$(top_srcdir)/src/backend/src
 
 libyaksa_la_SOURCES += \
 	src/backend/src/yaksuri_progress.c \
+	src/backend/src/yaksuri_progress_thread.c \
+	src/backend/src/yaksuri_ptr_cache.c \
 	src/backend/src/yaksur_hooks.c \
 	src/backend/src/yaksur_pup.c \
 	src/backend/src/yaksur_request.c
@@ -12,7 +12,37 @@
 
 yaksuri_global_s yaksuri_global;
 
-int yaksur_init_hook(void)
+/* serializes the one-time setup of the GPU drivers */
+static pthread_mutex_t gpudriver_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Most processes of large jobs never touch device memory, so the GPU
+ * drivers only probe for devices in yaksa_init.  Creating contexts and
+ * streams and enabling peer access is deferred until the first buffer
+ * that a driver claims as GPU memory, unless the application asked for
+ * it upfront. */
+int yaksuri_gpudriver_activate(yaksuri_gpudriver_id_e id)
+{
+    int rc = YAKSA_SUCCESS;
+
+    if (yaksu_atomic_load(&yaksuri_global.gpudriver[id].active))
+        goto fn_exit;
+
+    pthread_mutex_lock(&gpudriver_mutex);
+    if (!yaksu_atomic_load(&yaksuri_global.gpudriver[id].active)) {
+        rc = yaksuri_global.gpudriver[id].info->activate();
+        if (rc == YAKSA_SUCCESS)
+            yaksu_atomic_store(&yaksuri_global.gpudriver[id].active, 1);
+    }
+    pthread_mutex_unlock(&gpudriver_mutex);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_init_hook(yaksa_init_attr_t attr)
 {
     int rc = YAKSA_SUCCESS;
     yaksuri_gpudriver_id_e id;
@@ -20,37 +50,57 @@ int yaksur_init_hook(void)
     rc = yaksuri_seq_init_hook();
     YAKSU_ERR_CHECK(rc, fn_fail);
 
+    rc = yaksu_numa_get_num_nodes(&yaksuri_global.num_numa_nodes);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    char *str = getenv("YAKSA_ENV_PTR_ATTR_CACHE");
+    yaksuri_global.ptr_cache_all = (str && atoi(str));
+
+    /* the temporary buffers are handed out in whole chunks */
+    uintptr_t align = YAKSURI_SLAB_NUM_CHUNKS * YAKSURI_STAGING_ALIGNMENT;
+    uintptr_t size = attr.staging_device_buffer_size ? attr.staging_device_buffer_size :
+        YAKSURI_STAGING_DEFAULT_BUFFER_SIZE;
+    yaksuri_global.staging.device_slab_size = (size + align - 1) / align * align;
+    size = attr.staging_host_buffer_size ? attr.staging_host_buffer_size :
+        YAKSURI_STAGING_DEFAULT_BUFFER_SIZE;
+    yaksuri_global.staging.host_slab_size = (size + align - 1) / align * align;
+    yaksuri_global.staging.chunk_size = attr.staging_chunk_size;
+    yaksuri_global.staging.depth = attr.staging_depth > 0 ? attr.staging_depth :
+        YAKSURI_STAGING_DEFAULT_DEPTH;
+
+    yaksu_atomic_uint64_store(&yaksuri_global.stats.staged_subops, 0);
+    yaksu_atomic_uint64_store(&yaksuri_global.stats.staged_overlapped_subops, 0);
+    yaksu_atomic_uint64_store(&yaksuri_global.stats.staged_max_depth, 0);
+
     /* CUDA hooks */
     id = YAKSURI_GPUDRIVER_ID__CUDA;
     yaksuri_global.gpudriver[id].info = NULL;
+    yaksu_atomic_store(&yaksuri_global.gpudriver[id].active, 0);
     rc = yaksuri_cuda_init_hook(&yaksuri_global.gpudriver[id].info);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
+    /* host-emulated GPU hooks */
+    id = YAKSURI_GPUDRIVER_ID__HOSTGPU;
+    yaksuri_global.gpudriver[id].info = NULL;
+    yaksu_atomic_store(&yaksuri_global.gpudriver[id].active, 0);
+    rc = yaksuri_hostgpu_init_hook(&yaksuri_global.gpudriver[id].info);
+    YAKSU_ERR_CHECK(rc, fn_fail);
 
-    /* final setup for all backends */
-    for (id = YAKSURI_GPUDRIVER_ID__UNSET; id < YAKSURI_GPUDRIVER_ID__LAST; id++) {
-        if (id == YAKSURI_GPUDRIVER_ID__UNSET)
-            continue;
-
-        if (yaksuri_global.gpudriver[id].info) {
-            yaksuri_global.gpudriver[id].host.slab = NULL;
-            yaksuri_global.gpudriver[id].host.slab_head_offset = 0;
-            yaksuri_global.gpudriver[id].host.slab_tail_offset = 0;
+    if (attr.eager_gpu_init) {
+        for (id = YAKSURI_GPUDRIVER_ID__UNSET; id < YAKSURI_GPUDRIVER_ID__LAST; id++) {
+            if (id == YAKSURI_GPUDRIVER_ID__UNSET || !yaksuri_global.gpudriver[id].info)
+                continue;
 
-            int ndevices;
-            rc = yaksuri_global.gpudriver[id].info->get_num_devices(&ndevices);
+            rc = yaksuri_gpudriver_activate(id);
             YAKSU_ERR_CHECK(rc, fn_fail);
-
-            yaksuri_global.gpudriver[id].device = (yaksuri_slab_s *)
-                malloc(ndevices * sizeof(yaksuri_slab_s));
-            for (int i = 0; i < ndevices; i++) {
-                yaksuri_global.gpudriver[id].device[i].slab = NULL;
-                yaksuri_global.gpudriver[id].device[i].slab_head_offset = 0;
-                yaksuri_global.gpudriver[id].device[i].slab_tail_offset = 0;
-            }
         }
     }
 
+    /* the streams register with the progress thread, so it has to
+     * be up before the builtin streams are created */
+    rc = yaksuri_progress_thread_init(attr);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
   fn_exit:
     return rc;
   fn_fail:
@@ -61,6 +111,9 @@ int yaksur_finalize_hook(void)
 {
     int rc = YAKSA_SUCCESS;
 
+    rc = yaksuri_progress_thread_finalize();
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
     rc = yaksuri_seq_finalize_hook();
     YAKSU_ERR_CHECK(rc, fn_fail);
 
@@ -70,29 +123,15 @@ int yaksur_finalize_hook(void)
             continue;
 
         if (yaksuri_global.gpudriver[id].info) {
-            if (yaksuri_global.gpudriver[id].host.slab) {
-                yaksuri_global.gpudriver[id].info->host_free(yaksuri_global.gpudriver[id].
-                                                             host.slab);
-            }
-
-            int ndevices;
-            rc = yaksuri_global.gpudriver[id].info->get_num_devices(&ndevices);
-            YAKSU_ERR_CHECK(rc, fn_fail);
-
-            for (int i = 0; i < ndevices; i++) {
-                if (yaksuri_global.gpudriver[id].device[i].slab) {
-                    yaksuri_global.gpudriver[id].info->gpu_free(yaksuri_global.gpudriver[id].
-                                                                device[i].slab);
-                }
-            }
-            free(yaksuri_global.gpudriver[id].device);
-
             rc = yaksuri_global.gpudriver[id].info->finalize();
             YAKSU_ERR_CHECK(rc, fn_fail);
             free(yaksuri_global.gpudriver[id].info);
         }
     }
 
+    /* the next yaksa_init might bring up different drivers */
+    yaksuri_ptr_cache_finalize();
+
   fn_exit:
     return rc;
   fn_fail:
@@ -147,6 +186,100 @@ int yaksur_type_free_hook(yaksi_type_s * type)
     goto fn_exit;
 }
 
+int yaksur_stream_create_hook(yaksi_stream_s * stream)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_stream_s *backend;
+
+    backend = (yaksuri_stream_s *) malloc(sizeof(yaksuri_stream_s));
+    YAKSU_ERR_CHKANDJUMP(!backend, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+    stream->backend.priv = backend;
+
+    rc = yaksuri_progress_stream_init(backend);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    for (yaksuri_gpudriver_id_e id = YAKSURI_GPUDRIVER_ID__UNSET;
+         id < YAKSURI_GPUDRIVER_ID__LAST; id++) {
+        if (id == YAKSURI_GPUDRIVER_ID__UNSET)
+            continue;
+
+        backend->gpudriver[id].host = NULL;
+        backend->gpudriver[id].device = NULL;
+
+        if (yaksuri_global.gpudriver[id].info) {
+            /* the slabs themselves are allocated lazily by the
+             * progress engine */
+            backend->gpudriver[id].host = (yaksuri_slab_s *)
+                calloc(yaksuri_global.num_numa_nodes, sizeof(yaksuri_slab_s));
+            YAKSU_ERR_CHKANDJUMP(!backend->gpudriver[id].host, rc, YAKSA_ERR__OUT_OF_MEM,
+                                 fn_fail);
+
+            int ndevices;
+            rc = yaksuri_global.gpudriver[id].info->get_num_devices(&ndevices);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            backend->gpudriver[id].device = (yaksuri_slab_s *)
+                calloc(ndevices, sizeof(yaksuri_slab_s));
+            YAKSU_ERR_CHKANDJUMP(!backend->gpudriver[id].device, rc, YAKSA_ERR__OUT_OF_MEM,
+                                 fn_fail);
+        }
+    }
+
+    rc = yaksuri_progress_thread_add_stream(backend);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_stream_free_hook(yaksi_stream_s * stream)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_stream_s *backend = (yaksuri_stream_s *) stream->backend.priv;
+
+    yaksuri_progress_thread_remove_stream(backend);
+
+    rc = yaksuri_progress_stream_finalize(backend);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    for (yaksuri_gpudriver_id_e id = YAKSURI_GPUDRIVER_ID__UNSET;
+         id < YAKSURI_GPUDRIVER_ID__LAST; id++) {
+        if (id == YAKSURI_GPUDRIVER_ID__UNSET)
+            continue;
+
+        if (yaksuri_global.gpudriver[id].info) {
+            for (int i = 0; i < yaksuri_global.num_numa_nodes; i++) {
+                if (backend->gpudriver[id].host[i].slab) {
+                    yaksuri_global.gpudriver[id].info->host_free(backend->gpudriver[id].
+                                                                 host[i].slab);
+                }
+            }
+            free(backend->gpudriver[id].host);
+
+            int ndevices;
+            rc = yaksuri_global.gpudriver[id].info->get_num_devices(&ndevices);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            for (int i = 0; i < ndevices; i++) {
+                if (backend->gpudriver[id].device[i].slab) {
+                    yaksuri_global.gpudriver[id].info->gpu_free(backend->gpudriver[id].
+                                                                device[i].slab);
+                }
+            }
+            free(backend->gpudriver[id].device);
+        }
+    }
+
+    free(backend);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
 int yaksur_request_create_hook(yaksi_request_s * request)
 {
     int rc = YAKSA_SUCCESS;
@@ -155,6 +288,7 @@ int yaksur_request_create_hook(yaksi_request_s * request)
     yaksuri_request_s *backend = (yaksuri_request_s *) request->backend.priv;
 
     backend->event = NULL;
+    yaksu_atomic_store(&backend->event_completed, 0);
     backend->kind = YAKSURI_REQUEST_KIND__UNSET;
 
     return rc;
@@ -252,3 +386,13 @@ int yaksur_info_keyval_append(yaksi_info_s * info, const char *key, const void *
   fn_fail:
     goto fn_exit;
 }
+
+int yaksur_stats_get_hook(yaksa_stats_t * stats)
+{
+    stats->staged_subops = yaksu_atomic_uint64_load(&yaksuri_global.stats.staged_subops);
+    stats->staged_overlapped_subops =
+        yaksu_atomic_uint64_load(&yaksuri_global.stats.staged_overlapped_subops);
+    stats->staged_max_depth = yaksu_atomic_uint64_load(&yaksuri_global.stats.staged_max_depth);
+
+    return YAKSA_SUCCESS;
+}
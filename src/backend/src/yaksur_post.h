@@ -8,23 +8,49 @@
 
 #include "yaksuri_seq_post.h"
 #include "yaksuri_cuda_post.h"
+#include "yaksuri_hostgpu_post.h"
 
-int yaksur_init_hook(void);
+int yaksur_init_hook(yaksa_init_attr_t attr);
 int yaksur_finalize_hook(void);
 int yaksur_type_create_hook(yaksi_type_s * type);
 int yaksur_type_free_hook(yaksi_type_s * type);
 int yaksur_request_create_hook(yaksi_request_s * request);
 int yaksur_request_free_hook(yaksi_request_s * request);
+int yaksur_stream_create_hook(yaksi_stream_s * stream);
+int yaksur_stream_free_hook(yaksi_stream_s * stream);
 int yaksur_info_create_hook(yaksi_info_s * info);
 int yaksur_info_free_hook(yaksi_info_s * info);
 int yaksur_info_keyval_append(yaksi_info_s * info, const char *key, const void *val,
                               unsigned int vallen);
+int yaksur_stats_get_hook(yaksa_stats_t * stats);
 
 int yaksur_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
                  yaksi_info_s * info, yaksi_request_s * request);
 int yaksur_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
                    yaksi_info_s * info, yaksi_request_s * request);
+int yaksur_host_pack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                     yaksi_info_s * info);
+int yaksur_host_unpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                       yaksi_info_s * info);
+int yaksur_ipack_counter(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                         yaksi_info_s * info, yaksu_atomic_int * counter);
+int yaksur_iunpack_counter(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                           yaksi_info_s * info, yaksu_atomic_int * counter);
+int yaksur_ipack_batch(const yaksi_batch_desc_s * descs, uintptr_t ndescs, void *outbuf,
+                       yaksi_info_s * info, yaksi_request_s * request, bool * is_supported);
+int yaksur_iunpack_batch(const void *inbuf, const yaksi_batch_desc_s * descs, uintptr_t ndescs,
+                         yaksi_info_s * info, yaksi_request_s * request, bool * is_supported);
+int yaksur_pack_iov(const void *inbuf, uintptr_t count, yaksi_type_s * type, uintptr_t iov_offset,
+                    void *tmpbuf, uintptr_t max_tmpbuf_bytes, struct iovec *iov,
+                    uintptr_t max_iov_len, uintptr_t * actual_iov_len,
+                    uintptr_t * actual_tmpbuf_bytes, uintptr_t * actual_segments,
+                    yaksi_info_s * info);
+int yaksur_plan_create(yaksi_plan_s * plan);
+int yaksur_plan_execute(yaksi_plan_s * plan, yaksi_request_s * request);
+int yaksur_plan_free(yaksi_plan_s * plan);
 int yaksur_request_test(yaksi_request_s * request);
+int yaksur_request_testall(int count, yaksi_request_s ** requests);
 int yaksur_request_wait(yaksi_request_s * request);
+int yaksur_buffer_unregister(const void *buf, uintptr_t size);
 
 #endif /* YAKSUR_POST_H_INCLUDED */
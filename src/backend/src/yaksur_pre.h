@@ -36,6 +36,14 @@ typedef struct {
     void *priv;
 } yaksur_request_s;
 
+typedef struct {
+    void *priv;
+} yaksur_stream_s;
+
+typedef struct {
+    void *priv;
+} yaksur_plan_s;
+
 typedef struct {
     yaksuri_seq_info_s seq;
     yaksuri_cuda_info_s cuda;
@@ -45,6 +53,11 @@ typedef struct yaksur_gpudriver_info_s {
     /* miscellaneous */
     int (*get_num_devices) (int *ndevices);
     int (*check_p2p_comm) (int sdev, int ddev, bool * is_enabled);
+    /* sets up the devices (contexts, streams, peer access); the glue
+     * calls it once, before the first operation on a buffer of the
+     * driver, so only get_num_devices, get_ptr_attr, get_ptr_range,
+     * the type and info hooks and finalize may be called before */
+    int (*activate) (void);
     int (*finalize) (void);
 
     /* pup functions */
@@ -61,6 +74,10 @@ typedef struct yaksur_gpudriver_info_s {
     void *(*gpu_malloc) (uintptr_t size, int device);
     void (*gpu_free) (void *ptr);
     int (*get_ptr_attr) (const void *buf, yaksur_ptr_attr_s * ptrattr);
+    /* optional; also returns the address range over which the
+     * attributes hold, so they can be cached */
+    int (*get_ptr_range) (const void *buf, yaksur_ptr_attr_s * ptrattr, uintptr_t * base,
+                          uintptr_t * size);
 
     /* events */
     int (*event_destroy) (void *event);
@@ -4,28 +4,58 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
 #include "yaksa.h"
 #include "yaksi.h"
 #include "yaksu.h"
 #include "yaksuri.h"
 
-static int get_ptr_attr(const void *buf, yaksur_ptr_attr_s * ptrattr, yaksuri_gpudriver_id_e * id)
+/* the answers of drivers that cannot report address ranges are
+ * cached for the page of the buffer, if the user asked for it */
+#define PTR_CACHE_PAGE_SIZE  (4096)
+
+static int query_ptr_attr(const void *buf, yaksur_ptr_attr_s * ptrattr,
+                          yaksuri_gpudriver_id_e * id)
 {
     int rc = YAKSA_SUCCESS;
+    uint64_t generation;
+    uintptr_t base = 0, end = UINTPTR_MAX;
+    bool cacheable = true;
 
-    /* Each GPU backend can claim "ownership" of the input buffer */
+    if (yaksuri_ptr_cache_lookup(buf, ptrattr, id, &generation))
+        goto fn_exit;
+
+    /* Each GPU backend can claim "ownership" of the input buffer.
+     * The attributes hold on the intersection of the ranges reported
+     * by the drivers that were asked. */
     for (*id = YAKSURI_GPUDRIVER_ID__UNSET; *id < YAKSURI_GPUDRIVER_ID__LAST; (*id)++) {
         if (*id == YAKSURI_GPUDRIVER_ID__UNSET)
             continue;
 
-        if (yaksuri_global.gpudriver[*id].info) {
-            rc = yaksuri_global.gpudriver[*id].info->get_ptr_attr(buf, ptrattr);
+        yaksur_gpudriver_info_s *info = yaksuri_global.gpudriver[*id].info;
+        if (info && info->get_ptr_range) {
+            uintptr_t dbase, dsize;
+            rc = info->get_ptr_range(buf, ptrattr, &dbase, &dsize);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            base = YAKSU_MAX(base, dbase);
+            end = YAKSU_MIN(end, dbase + dsize);
+        } else if (info) {
+            rc = info->get_ptr_attr(buf, ptrattr);
             YAKSU_ERR_CHECK(rc, fn_fail);
 
-            if (ptrattr->type == YAKSUR_PTR_TYPE__GPU ||
-                ptrattr->type == YAKSUR_PTR_TYPE__REGISTERED_HOST)
-                break;
+            if (yaksuri_global.ptr_cache_all) {
+                uintptr_t page = (uintptr_t) buf / PTR_CACHE_PAGE_SIZE * PTR_CACHE_PAGE_SIZE;
+                base = YAKSU_MAX(base, page);
+                end = YAKSU_MIN(end, page + PTR_CACHE_PAGE_SIZE);
+            } else {
+                cacheable = false;
+            }
         }
+
+        if (info && (ptrattr->type == YAKSUR_PTR_TYPE__GPU ||
+                     ptrattr->type == YAKSUR_PTR_TYPE__REGISTERED_HOST))
+            break;
     }
 
     if (*id == YAKSURI_GPUDRIVER_ID__LAST) {
@@ -33,12 +63,56 @@ static int get_ptr_attr(const void *buf, yaksur_ptr_attr_s * ptrattr, yaksuri_gp
         ptrattr->type = YAKSUR_PTR_TYPE__UNREGISTERED_HOST;
     }
 
+    if (cacheable)
+        yaksuri_ptr_cache_insert(base, end - base, *ptrattr, *id, generation);
+
   fn_exit:
     return rc;
   fn_fail:
     goto fn_exit;
 }
 
+static int get_ptr_attr(const void *buf, yaksur_ptr_attr_s * ptrattr, yaksuri_gpudriver_id_e * id)
+{
+    int rc = YAKSA_SUCCESS;
+
+    rc = query_ptr_attr(buf, ptrattr, id);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    /* the devices of a driver are set up on its first GPU buffer;
+     * host buffers never need them */
+    if (ptrattr->type == YAKSUR_PTR_TYPE__GPU) {
+        rc = yaksuri_gpudriver_activate(*id);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_buffer_unregister(const void *buf, uintptr_t size)
+{
+    yaksuri_ptr_cache_invalidate(buf, size);
+
+    return YAKSA_SUCCESS;
+}
+
+/* the "yaksa_host_buffers" hint lets the user vouch for the buffers,
+ * so the GPU drivers need not be queried */
+static int get_ptr_attr_hinted(const void *buf, yaksi_info_s * info,
+                               yaksur_ptr_attr_s * ptrattr, yaksuri_gpudriver_id_e * id)
+{
+    if (info && info->host_buffers) {
+        *id = YAKSURI_GPUDRIVER_ID__UNSET;
+        ptrattr->type = YAKSUR_PTR_TYPE__UNREGISTERED_HOST;
+        return YAKSA_SUCCESS;
+    }
+
+    return get_ptr_attr(buf, ptrattr, id);
+}
+
 /*
  * In all of the "DIRECT" cases below, there are a few important
  * things to note:
@@ -52,20 +126,15 @@ static int get_ptr_attr(const void *buf, yaksur_ptr_attr_s * ptrattr, yaksuri_gp
  *     (STAGED).
  */
 
-int yaksur_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
-                 yaksi_info_s * info, yaksi_request_s * request)
+static int ipack_with_attr(const void *inbuf, void *outbuf, uintptr_t count,
+                           yaksi_type_s * type, yaksi_info_s * info, yaksi_request_s * request,
+                           yaksur_ptr_attr_s inattr, yaksuri_gpudriver_id_e inbuf_gpudriver,
+                           yaksur_ptr_attr_s outattr, yaksuri_gpudriver_id_e outbuf_gpudriver)
 {
     int rc = YAKSA_SUCCESS;
-    yaksur_ptr_attr_s inattr, outattr;
-    yaksuri_gpudriver_id_e inbuf_gpudriver, outbuf_gpudriver, id;
+    yaksuri_gpudriver_id_e id;
     yaksuri_request_s *request_backend = (yaksuri_request_s *) request->backend.priv;
 
-    rc = get_ptr_attr((const char *) inbuf + type->true_lb, &inattr, &inbuf_gpudriver);
-    YAKSU_ERR_CHECK(rc, fn_fail);
-
-    rc = get_ptr_attr(outbuf, &outattr, &outbuf_gpudriver);
-    YAKSU_ERR_CHECK(rc, fn_fail);
-
     if (inbuf_gpudriver == YAKSURI_GPUDRIVER_ID__UNSET &&
         outbuf_gpudriver == YAKSURI_GPUDRIVER_ID__UNSET) {
         id = YAKSURI_GPUDRIVER_ID__UNSET;
@@ -75,7 +144,7 @@ int yaksur_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s
         id = inbuf_gpudriver;
     } else if (inbuf_gpudriver != YAKSURI_GPUDRIVER_ID__UNSET) {
         id = inbuf_gpudriver;
-    } else if (outbuf_gpudriver != YAKSURI_GPUDRIVER_ID__UNSET) {
+    } else {
         id = outbuf_gpudriver;
     }
 
@@ -88,6 +157,20 @@ int yaksur_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s
 
         if (!is_supported) {
             rc = YAKSA_ERR__NOT_SUPPORTED;
+            goto fn_exit;
+        }
+
+        bool is_async;
+        rc = yaksuri_seq_async_is_enabled(count, type, info, &is_async);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        if (is_async) {
+            if (request_backend->kind == YAKSURI_REQUEST_KIND__UNSET) {
+                request_backend->kind = YAKSURI_REQUEST_KIND__ASYNC;
+            }
+
+            rc = yaksuri_seq_ipack_async(inbuf, outbuf, count, info, type, request);
+            YAKSU_ERR_CHECK(rc, fn_fail);
         } else {
             rc = yaksuri_seq_ipack(inbuf, outbuf, count, info, type);
             YAKSU_ERR_CHECK(rc, fn_fail);
@@ -179,7 +262,7 @@ int yaksur_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s
                                       inattr, outattr, YAKSURI_PUPTYPE__PACK, info);
         YAKSU_ERR_CHECK(rc, fn_fail);
 
-        rc = yaksuri_progress_poke();
+        rc = yaksuri_progress_poke((yaksuri_stream_s *) request->stream->backend.priv);
         YAKSU_ERR_CHECK(rc, fn_fail);
     }
 
@@ -189,20 +272,15 @@ int yaksur_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s
     goto fn_exit;
 }
 
-int yaksur_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
-                   yaksi_info_s * info, yaksi_request_s * request)
+static int iunpack_with_attr(const void *inbuf, void *outbuf, uintptr_t count,
+                             yaksi_type_s * type, yaksi_info_s * info, yaksi_request_s * request,
+                             yaksur_ptr_attr_s inattr, yaksuri_gpudriver_id_e inbuf_gpudriver,
+                             yaksur_ptr_attr_s outattr, yaksuri_gpudriver_id_e outbuf_gpudriver)
 {
     int rc = YAKSA_SUCCESS;
-    yaksur_ptr_attr_s inattr, outattr;
-    yaksuri_gpudriver_id_e inbuf_gpudriver, outbuf_gpudriver, id;
+    yaksuri_gpudriver_id_e id;
     yaksuri_request_s *request_backend = (yaksuri_request_s *) request->backend.priv;
 
-    rc = get_ptr_attr(inbuf, &inattr, &inbuf_gpudriver);
-    YAKSU_ERR_CHECK(rc, fn_fail);
-
-    rc = get_ptr_attr((char *) outbuf + type->true_lb, &outattr, &outbuf_gpudriver);
-    YAKSU_ERR_CHECK(rc, fn_fail);
-
     if (inbuf_gpudriver == YAKSURI_GPUDRIVER_ID__UNSET &&
         outbuf_gpudriver == YAKSURI_GPUDRIVER_ID__UNSET) {
         id = YAKSURI_GPUDRIVER_ID__UNSET;
@@ -212,7 +290,7 @@ int yaksur_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_
         id = inbuf_gpudriver;
     } else if (inbuf_gpudriver != YAKSURI_GPUDRIVER_ID__UNSET) {
         id = inbuf_gpudriver;
-    } else if (outbuf_gpudriver != YAKSURI_GPUDRIVER_ID__UNSET) {
+    } else {
         id = outbuf_gpudriver;
     }
 
@@ -225,6 +303,20 @@ int yaksur_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_
 
         if (!is_supported) {
             rc = YAKSA_ERR__NOT_SUPPORTED;
+            goto fn_exit;
+        }
+
+        bool is_async;
+        rc = yaksuri_seq_async_is_enabled(count, type, info, &is_async);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        if (is_async) {
+            if (request_backend->kind == YAKSURI_REQUEST_KIND__UNSET) {
+                request_backend->kind = YAKSURI_REQUEST_KIND__ASYNC;
+            }
+
+            rc = yaksuri_seq_iunpack_async(inbuf, outbuf, count, info, type, request);
+            YAKSU_ERR_CHECK(rc, fn_fail);
         } else {
             rc = yaksuri_seq_iunpack(inbuf, outbuf, count, info, type);
             YAKSU_ERR_CHECK(rc, fn_fail);
@@ -318,10 +410,487 @@ int yaksur_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_
                                       inattr, outattr, YAKSURI_PUPTYPE__UNPACK, info);
         YAKSU_ERR_CHECK(rc, fn_fail);
 
-        rc = yaksuri_progress_poke();
+        rc = yaksuri_progress_poke((yaksuri_stream_s *) request->stream->backend.priv);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_ipack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                 yaksi_info_s * info, yaksi_request_s * request)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksur_ptr_attr_s inattr, outattr;
+    yaksuri_gpudriver_id_e inbuf_gpudriver, outbuf_gpudriver;
+
+    rc = get_ptr_attr_hinted((const char *) inbuf + type->true_lb, info, &inattr,
+                             &inbuf_gpudriver);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = get_ptr_attr_hinted(outbuf, info, &outattr, &outbuf_gpudriver);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = ipack_with_attr(inbuf, outbuf, count, type, info, request, inattr, inbuf_gpudriver,
+                         outattr, outbuf_gpudriver);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_iunpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                   yaksi_info_s * info, yaksi_request_s * request)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksur_ptr_attr_s inattr, outattr;
+    yaksuri_gpudriver_id_e inbuf_gpudriver, outbuf_gpudriver;
+
+    rc = get_ptr_attr_hinted(inbuf, info, &inattr, &inbuf_gpudriver);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = get_ptr_attr_hinted((char *) outbuf + type->true_lb, info, &outattr,
+                             &outbuf_gpudriver);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = iunpack_with_attr(inbuf, outbuf, count, type, info, request, inattr, inbuf_gpudriver,
+                           outattr, outbuf_gpudriver);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_host_pack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                     yaksi_info_s * info)
+{
+    int rc = YAKSA_SUCCESS;
+    bool is_supported;
+
+    rc = yaksuri_seq_pup_is_supported(type, &is_supported);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    if (!is_supported) {
+        rc = YAKSA_ERR__NOT_SUPPORTED;
+        goto fn_exit;
+    }
+
+    rc = yaksuri_seq_ipack(inbuf, outbuf, count, info, type);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_host_unpack(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                       yaksi_info_s * info)
+{
+    int rc = YAKSA_SUCCESS;
+    bool is_supported;
+
+    rc = yaksuri_seq_pup_is_supported(type, &is_supported);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    if (!is_supported) {
+        rc = YAKSA_ERR__NOT_SUPPORTED;
+        goto fn_exit;
+    }
+
+    rc = yaksuri_seq_iunpack(inbuf, outbuf, count, info, type);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/* host operations that the seq backend can handle completely need
+ * no request: they either complete right away or are queued to the
+ * async workers, which decrement the counter themselves */
+static int host_counter(yaksuri_puptype_e puptype, const void *inbuf, void *outbuf,
+                        uintptr_t count, yaksi_type_s * type, yaksi_info_s * info,
+                        yaksu_atomic_int * counter)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksur_ptr_attr_s inattr, outattr;
+    yaksuri_gpudriver_id_e inbuf_gpudriver, outbuf_gpudriver;
+    const char *inptr = (const char *) inbuf;
+    const char *outptr = (const char *) outbuf;
+
+    if (puptype == YAKSURI_PUPTYPE__PACK)
+        inptr += type->true_lb;
+    else
+        outptr += type->true_lb;
+
+    rc = get_ptr_attr_hinted(inptr, info, &inattr, &inbuf_gpudriver);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = get_ptr_attr_hinted(outptr, info, &outattr, &outbuf_gpudriver);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    bool is_supported = false;
+    if (inattr.type != YAKSUR_PTR_TYPE__GPU && outattr.type != YAKSUR_PTR_TYPE__GPU) {
+        rc = yaksuri_seq_pup_is_supported(type, &is_supported);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    if (!is_supported) {
+        rc = YAKSA_ERR__NOT_SUPPORTED;
+        goto fn_exit;
+    }
+
+    bool is_async;
+    rc = yaksuri_seq_async_is_enabled(count, type, info, &is_async);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    if (is_async) {
+        if (puptype == YAKSURI_PUPTYPE__PACK) {
+            rc = yaksuri_seq_ipack_async_counter(inbuf, outbuf, count, info, type, counter);
+        } else {
+            rc = yaksuri_seq_iunpack_async_counter(inbuf, outbuf, count, info, type, counter);
+        }
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    } else {
+        if (puptype == YAKSURI_PUPTYPE__PACK) {
+            rc = yaksuri_seq_ipack(inbuf, outbuf, count, info, type);
+        } else {
+            rc = yaksuri_seq_iunpack(inbuf, outbuf, count, info, type);
+        }
+        if (rc == YAKSA_ERR__NOT_SUPPORTED)
+            goto fn_exit;
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        yaksu_atomic_decr(counter);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_ipack_counter(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                         yaksi_info_s * info, yaksu_atomic_int * counter)
+{
+    return host_counter(YAKSURI_PUPTYPE__PACK, inbuf, outbuf, count, type, info, counter);
+}
+
+int yaksur_iunpack_counter(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                           yaksi_info_s * info, yaksu_atomic_int * counter)
+{
+    return host_counter(YAKSURI_PUPTYPE__UNPACK, inbuf, outbuf, count, type, info, counter);
+}
+
+/* batches usually reuse a handful of user buffers with different
+ * types (e.g., the faces of a halo), so the pointer attributes are
+ * looked up once per distinct buffer instead of once per
+ * descriptor */
+typedef struct {
+    const void *buf;
+    yaksur_ptr_attr_s attr;
+    yaksuri_gpudriver_id_e id;
+} batch_attr_s;
+
+static int batch_get_ptr_attr(batch_attr_s * cache, uintptr_t * ncached,
+                              const yaksi_batch_desc_s * desc, yaksi_info_s * info,
+                              yaksur_ptr_attr_s * attr, yaksuri_gpudriver_id_e * id)
+{
+    int rc = YAKSA_SUCCESS;
+
+    for (uintptr_t i = 0; i < *ncached; i++) {
+        if (cache[i].buf == desc->buf) {
+            *attr = cache[i].attr;
+            *id = cache[i].id;
+            goto fn_exit;
+        }
+    }
+
+    rc = get_ptr_attr_hinted((const char *) desc->buf + desc->type->true_lb, info, attr, id);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    cache[*ncached].buf = desc->buf;
+    cache[*ncached].attr = *attr;
+    cache[*ncached].id = *id;
+    (*ncached)++;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+static int batch_issue(yaksuri_puptype_e puptype, const yaksi_batch_desc_s * descs,
+                       uintptr_t ndescs, void *contigbuf, yaksi_info_s * info,
+                       yaksi_request_s * request, bool * is_supported)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksur_ptr_attr_s cattr, attr;
+    yaksuri_gpudriver_id_e cid, id;
+    yaksuri_request_s *request_backend = (yaksuri_request_s *) request->backend.priv;
+    batch_attr_s *cache = NULL;
+    yaksi_batch_desc_s *async_descs = NULL;
+    uintptr_t ncached = 0, nasync = 0;
+
+    rc = get_ptr_attr_hinted(contigbuf, info, &cattr, &cid);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    cache = (batch_attr_s *) malloc(ndescs * sizeof(batch_attr_s));
+    YAKSU_ERR_CHKANDJUMP(!cache, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    async_descs = (yaksi_batch_desc_s *) malloc(ndescs * sizeof(yaksi_batch_desc_s));
+    YAKSU_ERR_CHKANDJUMP(!async_descs, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    for (uintptr_t i = 0; i < ndescs; i++) {
+        const yaksi_batch_desc_s *desc = &descs[i];
+        char *cbuf = (char *) contigbuf + desc->offset;
+
+        is_supported[i] = true;
+
+        rc = batch_get_ptr_attr(cache, &ncached, desc, info, &attr, &id);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        /* host operations that go to the async workers are collected,
+         * so the workers get the whole batch at once */
+        if (attr.type != YAKSUR_PTR_TYPE__GPU && cattr.type != YAKSUR_PTR_TYPE__GPU) {
+            bool seq_supported;
+            rc = yaksuri_seq_pup_is_supported(desc->type, &seq_supported);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            if (!seq_supported) {
+                is_supported[i] = false;
+                continue;
+            }
+
+            bool is_async;
+            rc = yaksuri_seq_async_is_enabled(desc->count, desc->type, info, &is_async);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            if (is_async) {
+                async_descs[nasync++] = *desc;
+                continue;
+            }
+        }
+
+        if (puptype == YAKSURI_PUPTYPE__PACK) {
+            rc = ipack_with_attr(desc->buf, cbuf, desc->count, desc->type, info, request, attr,
+                                 id, cattr, cid);
+        } else {
+            rc = iunpack_with_attr(cbuf, desc->buf, desc->count, desc->type, info, request,
+                                   cattr, cid, attr, id);
+        }
+
+        if (rc == YAKSA_ERR__NOT_SUPPORTED) {
+            is_supported[i] = false;
+            rc = YAKSA_SUCCESS;
+        } else {
+            YAKSU_ERR_CHECK(rc, fn_fail);
+        }
+    }
+
+    if (nasync) {
+        if (request_backend->kind == YAKSURI_REQUEST_KIND__UNSET) {
+            request_backend->kind = YAKSURI_REQUEST_KIND__ASYNC;
+        }
+
+        if (puptype == YAKSURI_PUPTYPE__PACK) {
+            rc = yaksuri_seq_ipack_batch_async(async_descs, nasync, contigbuf, info, request);
+        } else {
+            rc = yaksuri_seq_iunpack_batch_async(contigbuf, async_descs, nasync, info, request);
+        }
         YAKSU_ERR_CHECK(rc, fn_fail);
     }
 
+  fn_exit:
+    free(async_descs);
+    free(cache);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_ipack_batch(const yaksi_batch_desc_s * descs, uintptr_t ndescs, void *outbuf,
+                       yaksi_info_s * info, yaksi_request_s * request, bool * is_supported)
+{
+    return batch_issue(YAKSURI_PUPTYPE__PACK, descs, ndescs, outbuf, info, request,
+                       is_supported);
+}
+
+int yaksur_iunpack_batch(const void *inbuf, const yaksi_batch_desc_s * descs, uintptr_t ndescs,
+                         yaksi_info_s * info, yaksi_request_s * request, bool * is_supported)
+{
+    return batch_issue(YAKSURI_PUPTYPE__UNPACK, descs, ndescs, (void *) inbuf, info, request,
+                       is_supported);
+}
+
+int yaksur_plan_create(yaksi_plan_s * plan)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_plan_s *backend;
+    bool is_pack = (plan->op == YAKSA_PACK_PLAN_OP__PACK);
+
+    backend = (yaksuri_plan_s *) malloc(sizeof(yaksuri_plan_s));
+    YAKSU_ERR_CHKANDJUMP(!backend, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    backend->seq_plan = NULL;
+    plan->is_sync = false;
+
+    const char *inptr = (const char *) plan->inbuf + (is_pack ? plan->type->true_lb : 0);
+    const char *outptr = (const char *) plan->outbuf + (is_pack ? 0 : plan->type->true_lb);
+
+    rc = get_ptr_attr_hinted(inptr, plan->info, &backend->inattr, &backend->inbuf_gpudriver);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = get_ptr_attr_hinted(outptr, plan->info, &backend->outattr,
+                             &backend->outbuf_gpudriver);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    /* host operations that the seq backend handles completely are
+     * resolved down to the kernel or the segment list; everything
+     * else only skips the pointer queries when it is executed */
+    backend->path = YAKSURI_PLAN_PATH__GENERIC;
+    if (backend->inattr.type != YAKSUR_PTR_TYPE__GPU &&
+        backend->outattr.type != YAKSUR_PTR_TYPE__GPU) {
+        bool is_supported;
+        rc = yaksuri_seq_pup_is_supported(plan->type, &is_supported);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        if (is_supported) {
+            bool is_async;
+            rc = yaksuri_seq_async_is_enabled(plan->count, plan->type, plan->info, &is_async);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            if (is_async) {
+                backend->path = YAKSURI_PLAN_PATH__SEQ_ASYNC;
+            } else {
+                rc = yaksuri_seq_plan_create(plan->inbuf, plan->outbuf, plan->count,
+                                             plan->type, plan->info, is_pack,
+                                             &backend->seq_plan);
+                if (rc == YAKSA_ERR__NOT_SUPPORTED) {
+                    rc = YAKSA_SUCCESS;
+                } else {
+                    YAKSU_ERR_CHECK(rc, fn_fail);
+                    backend->path = YAKSURI_PLAN_PATH__SEQ;
+                    plan->is_sync = true;
+                }
+            }
+        }
+    }
+
+    plan->backend.priv = backend;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    free(backend);
+    goto fn_exit;
+}
+
+int yaksur_plan_execute(yaksi_plan_s * plan, yaksi_request_s * request)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_plan_s *backend = (yaksuri_plan_s *) plan->backend.priv;
+    bool is_pack = (plan->op == YAKSA_PACK_PLAN_OP__PACK);
+
+    switch (backend->path) {
+        case YAKSURI_PLAN_PATH__SEQ:
+            rc = yaksuri_seq_plan_execute(backend->seq_plan);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+            break;
+
+        case YAKSURI_PLAN_PATH__SEQ_ASYNC:
+            {
+                yaksuri_request_s *request_backend =
+                    (yaksuri_request_s *) request->backend.priv;
+                if (request_backend->kind == YAKSURI_REQUEST_KIND__UNSET) {
+                    request_backend->kind = YAKSURI_REQUEST_KIND__ASYNC;
+                }
+
+                if (is_pack) {
+                    rc = yaksuri_seq_ipack_async(plan->inbuf, plan->outbuf, plan->count,
+                                                 plan->info, plan->type, request);
+                } else {
+                    rc = yaksuri_seq_iunpack_async(plan->inbuf, plan->outbuf, plan->count,
+                                                   plan->info, plan->type, request);
+                }
+                YAKSU_ERR_CHECK(rc, fn_fail);
+            }
+            break;
+
+        case YAKSURI_PLAN_PATH__GENERIC:
+            /* NOT_SUPPORTED is passed on, so the frontend can break
+             * the type down */
+            if (is_pack) {
+                rc = ipack_with_attr(plan->inbuf, plan->outbuf, plan->count, plan->type,
+                                     plan->info, request, backend->inattr,
+                                     backend->inbuf_gpudriver, backend->outattr,
+                                     backend->outbuf_gpudriver);
+            } else {
+                rc = iunpack_with_attr(plan->inbuf, plan->outbuf, plan->count, plan->type,
+                                       plan->info, request, backend->inattr,
+                                       backend->inbuf_gpudriver, backend->outattr,
+                                       backend->outbuf_gpudriver);
+            }
+            break;
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_plan_free(yaksi_plan_s * plan)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_plan_s *backend = (yaksuri_plan_s *) plan->backend.priv;
+
+    if (backend->seq_plan) {
+        rc = yaksuri_seq_plan_free(backend->seq_plan);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    free(backend);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_pack_iov(const void *inbuf, uintptr_t count, yaksi_type_s * type, uintptr_t iov_offset,
+                    void *tmpbuf, uintptr_t max_tmpbuf_bytes, struct iovec *iov,
+                    uintptr_t max_iov_len, uintptr_t * actual_iov_len,
+                    uintptr_t * actual_tmpbuf_bytes, uintptr_t * actual_segments,
+                    yaksi_info_s * info)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksur_ptr_attr_s inattr, tmpattr;
+    yaksuri_gpudriver_id_e id;
+
+    /* the in-place iov elements are handed to the caller as is, so
+     * this is only meaningful for host buffers */
+    rc = get_ptr_attr_hinted((const char *) inbuf + type->true_lb, info, &inattr, &id);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = get_ptr_attr_hinted(tmpbuf, info, &tmpattr, &id);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    if (inattr.type == YAKSUR_PTR_TYPE__GPU || tmpattr.type == YAKSUR_PTR_TYPE__GPU) {
+        rc = YAKSA_ERR__NOT_SUPPORTED;
+        goto fn_exit;
+    }
+
+    rc = yaksuri_seq_pack_iov(inbuf, count, type, iov_offset, tmpbuf, max_tmpbuf_bytes, iov,
+                              max_iov_len, actual_iov_len, actual_tmpbuf_bytes, actual_segments,
+                              info);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
   fn_exit:
     return rc;
   fn_fail:
@@ -4,12 +4,14 @@
  */
 
 #include <assert.h>
+#include <sched.h>
+#include <stdlib.h>
 #include "yaksa.h"
 #include "yaksi.h"
 #include "yaksu.h"
 #include "yaksuri.h"
 
-int yaksur_request_test(yaksi_request_s * request)
+static int test_event(yaksi_request_s * request)
 {
     int rc = YAKSA_SUCCESS;
     yaksuri_request_s *backend = (yaksuri_request_s *) request->backend.priv;
@@ -22,17 +24,75 @@ int yaksur_request_test(yaksi_request_s * request)
         rc = yaksuri_global.gpudriver[id].info->event_query(backend->event, &completed);
         YAKSU_ERR_CHECK(rc, fn_fail);
 
-        if (completed) {
-            yaksu_atomic_decr(&request->cc);
+        if (completed && yaksu_atomic_incr(&backend->event_completed) == 0) {
+            rc = yaksi_request_complete(request);
+            YAKSU_ERR_CHECK(rc, fn_fail);
         }
     }
 
-    if (backend->kind == YAKSURI_REQUEST_KIND__STAGED) {
-        rc = yaksuri_progress_poke();
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksur_request_test(yaksi_request_s * request)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_request_s *backend = (yaksuri_request_s *) request->backend.priv;
+    yaksuri_stream_s *stream = (yaksuri_stream_s *) request->stream->backend.priv;
+
+    rc = test_event(request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    /* the progress thread drives staged requests, if there is one */
+    if (backend->kind == YAKSURI_REQUEST_KIND__STAGED && !yaksuri_progress_thread_is_enabled()) {
+        rc = yaksuri_progress_poke(stream);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/* query the events of all requests first, and then poke each stream
+ * that has staged requests in the list exactly once */
+int yaksur_request_testall(int count, yaksi_request_s ** requests)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_stream_s **streams;
+    int nstreams = 0;
+
+    streams = (yaksuri_stream_s **) malloc(count * sizeof(yaksuri_stream_s *));
+    YAKSU_ERR_CHKANDJUMP(!streams, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    for (int i = 0; i < count; i++) {
+        yaksuri_request_s *backend = (yaksuri_request_s *) requests[i]->backend.priv;
+        yaksuri_stream_s *stream = (yaksuri_stream_s *) requests[i]->stream->backend.priv;
+
+        rc = test_event(requests[i]);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        if (backend->kind != YAKSURI_REQUEST_KIND__STAGED || yaksuri_progress_thread_is_enabled())
+            continue;
+
+        int j;
+        for (j = 0; j < nstreams; j++)
+            if (streams[j] == stream)
+                break;
+        if (j == nstreams)
+            streams[nstreams++] = stream;
+    }
+
+    for (int j = 0; j < nstreams; j++) {
+        rc = yaksuri_progress_poke(streams[j]);
         YAKSU_ERR_CHECK(rc, fn_fail);
     }
 
   fn_exit:
+    free(streams);
     return rc;
   fn_fail:
     goto fn_exit;
@@ -43,20 +103,37 @@ int yaksur_request_wait(yaksi_request_s * request)
     int rc = YAKSA_SUCCESS;
     yaksuri_request_s *backend = (yaksuri_request_s *) request->backend.priv;
     yaksuri_gpudriver_id_e id = backend->gpudriver_id;
+    yaksuri_stream_s *stream = (yaksuri_stream_s *) request->stream->backend.priv;
 
     assert(backend->kind != YAKSURI_REQUEST_KIND__UNSET);
 
     if (backend->event) {
         rc = yaksuri_global.gpudriver[id].info->event_synchronize(backend->event);
         YAKSU_ERR_CHECK(rc, fn_fail);
-        yaksu_atomic_decr(&request->cc);
+
+        if (yaksu_atomic_incr(&backend->event_completed) == 0) {
+            rc = yaksi_request_complete(request);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+        }
     }
 
     if (backend->kind == YAKSURI_REQUEST_KIND__DIRECT) {
         assert(!yaksu_atomic_load(&request->cc));
+    } else if (backend->kind == YAKSURI_REQUEST_KIND__ASYNC ||
+               yaksuri_progress_thread_is_enabled()) {
+        /* the seq worker thread or the progress thread completes the
+         * request; there is nothing for us to drive, so we can sleep
+         * if asked to */
+        if (request->blocking_wait) {
+            rc = yaksi_request_block(request);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+        } else {
+            while (yaksu_atomic_load(&request->cc))
+                sched_yield();
+        }
     } else {
         while (yaksu_atomic_load(&request->cc)) {
-            rc = yaksuri_progress_poke();
+            rc = yaksuri_progress_poke(stream);
             YAKSU_ERR_CHECK(rc, fn_fail);
         }
     }
@@ -6,11 +6,13 @@
 #ifndef YAKSURI_H_INCLUDED
 #define YAKSURI_H_INCLUDED
 
+#include <pthread.h>
 #include "yaksi.h"
 
 typedef enum yaksuri_gpudriver_id_e {
     YAKSURI_GPUDRIVER_ID__UNSET = -1,
     YAKSURI_GPUDRIVER_ID__CUDA = 0,
+    YAKSURI_GPUDRIVER_ID__HOSTGPU,
     YAKSURI_GPUDRIVER_ID__LAST,
 } yaksuri_gpudriver_id_e;
 
@@ -19,36 +21,126 @@ typedef enum yaksuri_pup_e {
     YAKSURI_PUPTYPE__UNPACK,
 } yaksuri_puptype_e;
 
+/* temporary buffers are handed out in chunks, so operations sharing
+ * a slab can release their space in any order */
+#define YAKSURI_SLAB_NUM_CHUNKS  (64)
+
+/* defaults of the staging init attributes; chunks are aligned to
+ * pages */
+#define YAKSURI_STAGING_DEFAULT_BUFFER_SIZE  (16 * 1024 * 1024)
+#define YAKSURI_STAGING_DEFAULT_DEPTH        (4)
+#define YAKSURI_STAGING_ALIGNMENT            (4096)
+
 typedef struct {
     void *slab;
-    uintptr_t slab_head_offset;
-    uintptr_t slab_tail_offset;
+    uint64_t chunk_mask;        /* one bit per chunk in use */
+    int num_users;              /* operations staging through the slab */
+    unsigned int blocked_epoch; /* progress pass in which an operation
+                                 * could not get any space */
 } yaksuri_slab_s;
 
 typedef struct {
+    int num_numa_nodes;
+    /* cache the answers of drivers that cannot report address
+     * ranges as well (YAKSA_ENV_PTR_ATTR_CACHE) */
+    bool ptr_cache_all;
+    struct {
+        uintptr_t device_slab_size;
+        uintptr_t host_slab_size;
+        uintptr_t chunk_size;   /* zero: the share of the operation / depth */
+        int depth;
+    } staging;
+    struct {
+        yaksu_atomic_uint64 staged_subops;
+        yaksu_atomic_uint64 staged_overlapped_subops;
+        yaksu_atomic_uint64 staged_max_depth;
+    } stats;
     struct {
-        yaksuri_slab_s host;
-        yaksuri_slab_s *device;
         yaksur_gpudriver_info_s *info;
+        /* the driver set up its devices */
+        yaksu_atomic_int active;
     } gpudriver[YAKSURI_GPUDRIVER_ID__LAST];
 } yaksuri_global_s;
 extern yaksuri_global_s yaksuri_global;
 
+struct yaksuri_progress_elem_s;
+
+/* each stream has its own progress queue and temporary buffers, so
+ * operations on different streams never share a lock.  Operations are
+ * submitted through a lock-free queue; the progress engine moves them
+ * to its active list, which only it accesses, under the progress
+ * mutex. */
+typedef struct {
+    yaksu_mpsc_s progress_queue;
+    struct yaksuri_progress_elem_s *progress_head;
+    struct yaksuri_progress_elem_s *progress_tail;
+    pthread_mutex_t progress_mutex;
+    unsigned int progress_epoch;
+
+    yaksu_freelist_s elem_pool;
+    yaksu_freelist_s subop_pool;
+
+    struct {
+        yaksuri_slab_s *host;   /* one slab per NUMA node */
+        yaksuri_slab_s *device;
+    } gpudriver[YAKSURI_GPUDRIVER_ID__LAST];
+} yaksuri_stream_s;
+
 typedef struct {
     yaksuri_gpudriver_id_e gpudriver_id;
     void *event;
+    /* the event releases its completion counter only once, even if
+     * the request is tested by multiple threads */
+    yaksu_atomic_int event_completed;
 
     enum {
         YAKSURI_REQUEST_KIND__UNSET,
         YAKSURI_REQUEST_KIND__DIRECT,
         YAKSURI_REQUEST_KIND__STAGED,
+        YAKSURI_REQUEST_KIND__ASYNC,
     } kind;
 } yaksuri_request_s;
 
+/* the pointer attributes and the execution path of a plan are
+ * resolved when the plan is created */
+typedef struct {
+    enum {
+        YAKSURI_PLAN_PATH__SEQ,
+        YAKSURI_PLAN_PATH__SEQ_ASYNC,
+        YAKSURI_PLAN_PATH__GENERIC,
+    } path;
+
+    yaksur_ptr_attr_s inattr;
+    yaksur_ptr_attr_s outattr;
+    yaksuri_gpudriver_id_e inbuf_gpudriver;
+    yaksuri_gpudriver_id_e outbuf_gpudriver;
+
+    void *seq_plan;
+} yaksuri_plan_s;
+
 int yaksuri_progress_enqueue(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
                              yaksi_request_s * request, yaksur_ptr_attr_s inattr,
                              yaksur_ptr_attr_s outattr, yaksuri_puptype_e puptype,
                              yaksi_info_s * info);
-int yaksuri_progress_poke(void);
+int yaksuri_progress_poke(yaksuri_stream_s * stream);
+int yaksuri_progress_stream_init(yaksuri_stream_s * stream);
+int yaksuri_progress_stream_finalize(yaksuri_stream_s * stream);
+
+int yaksuri_gpudriver_activate(yaksuri_gpudriver_id_e id);
+
+int yaksuri_progress_thread_init(yaksa_init_attr_t attr);
+int yaksuri_progress_thread_finalize(void);
+bool yaksuri_progress_thread_is_enabled(void);
+int yaksuri_progress_thread_add_stream(yaksuri_stream_s * stream);
+void yaksuri_progress_thread_remove_stream(yaksuri_stream_s * stream);
+void yaksuri_progress_thread_submit(void);
+void yaksuri_progress_thread_complete(void);
+
+bool yaksuri_ptr_cache_lookup(const void *buf, yaksur_ptr_attr_s * ptrattr,
+                              yaksuri_gpudriver_id_e * id, uint64_t * generation);
+void yaksuri_ptr_cache_insert(uintptr_t base, uintptr_t size, yaksur_ptr_attr_s ptrattr,
+                              yaksuri_gpudriver_id_e id, uint64_t generation);
+void yaksuri_ptr_cache_invalidate(const void *buf, uintptr_t size);
+void yaksuri_ptr_cache_finalize(void);
 
 #endif /* YAKSURI_H_INCLUDED */
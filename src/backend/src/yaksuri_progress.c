@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <sched.h>
 #include "yaksa.h"
 #include "yaksi.h"
 #include "yaksu.h"
@@ -20,10 +21,20 @@ typedef struct progress_subop_s {
     void *interm_event;
     void *event;
 
+    /* the slab chunks backing the temporary buffers */
+    int gpu_chunk;
+    int gpu_num_chunks;
+    int host_chunk;
+    int host_num_chunks;
+
     struct progress_subop_s *next;
 } progress_subop_s;
 
-typedef struct progress_elem_s {
+typedef struct yaksuri_progress_elem_s {
+    /* must be the first member, so submitted elements can be cast
+     * back from the submission queue */
+    yaksu_mpsc_node_s node;
+
     struct {
         yaksuri_puptype_e puptype;
 
@@ -39,102 +50,73 @@ typedef struct progress_elem_s {
         uintptr_t issued_count;
         progress_subop_s *subop_head;
         progress_subop_s *subop_tail;
+
+        /* the slabs that the operation stages through, and the
+         * subops and bytes it has in flight in them */
+        yaksuri_slab_s *dslab;
+        yaksuri_slab_s *hslab;
+        int devid;
+        int num_subops;
+        uintptr_t inflight_bytes;
     } pup;
 
     yaksi_request_s *request;
     yaksi_info_s *info;
-    struct progress_elem_s *next;
+    int host_node;
+    /* piece of a larger element, released with the element */
+    yaksi_type_s *owned_type;
+    struct yaksuri_progress_elem_s *prev;
+    struct yaksuri_progress_elem_s *next;
 } progress_elem_s;
 
-static progress_elem_s *progress_head = NULL;
-static progress_elem_s *progress_tail = NULL;
-static pthread_mutex_t progress_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* elements larger than a quarter of the smaller slab are split into
+ * pieces, so that several pieces of an element can be in flight at
+ * once */
+#define PROGRESS_PIECES_PER_SLAB  (4)
 
-#define TMPBUF_SLAB_SIZE  (16 * 1024 * 1024)
+/* elements and subops beyond these are malloc'ed */
+#define PROGRESS_ELEM_POOL_SIZE   (256)
+#define PROGRESS_SUBOP_POOL_SIZE  (256)
 
-/* the dequeue function is not thread safe, as it is always called
- * from within the progress engine */
-static int progress_dequeue(progress_elem_s * elem)
+int yaksuri_progress_stream_init(yaksuri_stream_s * stream)
 {
     int rc = YAKSA_SUCCESS;
 
-    assert(progress_head);
+    yaksu_mpsc_init(&stream->progress_queue);
+    stream->progress_head = stream->progress_tail = NULL;
+    stream->progress_epoch = 0;
+    pthread_mutex_init(&stream->progress_mutex, NULL);
 
-    if (progress_head == elem && progress_tail == elem) {
-        progress_head = progress_tail = NULL;
-    } else if (progress_head == elem) {
-        progress_head = progress_head->next;
-    } else {
-        progress_elem_s *tmp;
-        for (tmp = progress_head; tmp->next; tmp = tmp->next)
-            if (tmp->next == elem)
-                break;
-        assert(tmp->next);
-        tmp->next = tmp->next->next;
-        if (tmp->next == NULL)
-            progress_tail = tmp;
-    }
+    rc = yaksu_freelist_create(sizeof(progress_elem_s), PROGRESS_ELEM_POOL_SIZE,
+                               &stream->elem_pool);
+    YAKSU_ERR_CHECK(rc, fn_fail);
 
-    yaksu_atomic_decr(&elem->request->cc);
-    free(elem);
+    rc = yaksu_freelist_create(sizeof(progress_subop_s), PROGRESS_SUBOP_POOL_SIZE,
+                               &stream->subop_pool);
+    YAKSU_ERR_CHECK(rc, fn_fail);
 
+  fn_exit:
     return rc;
+  fn_fail:
+    goto fn_exit;
 }
 
-int yaksuri_progress_enqueue(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
-                             yaksi_request_s * request, yaksur_ptr_attr_s inattr,
-                             yaksur_ptr_attr_s outattr, yaksuri_puptype_e puptype,
-                             yaksi_info_s * info)
+int yaksuri_progress_stream_finalize(yaksuri_stream_s * stream)
 {
-    int rc = YAKSA_SUCCESS;
-
-    /* if we need to go through the progress engine, make sure we only
-     * take on types, where at least one count of the type fits into
-     * our temporary buffers. */
-    if (type->size > TMPBUF_SLAB_SIZE) {
-        rc = YAKSA_ERR__NOT_SUPPORTED;
-        goto fn_exit;
-    }
+    assert(yaksu_mpsc_is_empty(&stream->progress_queue));
+    assert(stream->progress_head == NULL);
 
-    /* enqueue to the progress engine */
-    progress_elem_s *newelem;
-    newelem = (progress_elem_s *) malloc(sizeof(progress_elem_s));
-
-    newelem->pup.puptype = puptype;
-    newelem->pup.inattr = inattr;
-    newelem->pup.outattr = outattr;
-    newelem->pup.inbuf = inbuf;
-    newelem->pup.outbuf = outbuf;
-    newelem->pup.count = count;
-    newelem->pup.type = type;
-    newelem->pup.completed_count = 0;
-    newelem->pup.issued_count = 0;
-    newelem->pup.subop_head = newelem->pup.subop_tail = NULL;
-    newelem->request = request;
-    newelem->info = info;
-    newelem->next = NULL;
+    yaksu_freelist_free(stream->subop_pool);
+    yaksu_freelist_free(stream->elem_pool);
+    pthread_mutex_destroy(&stream->progress_mutex);
 
-    /* enqueue the new element */
-    yaksu_atomic_incr(&request->cc);
-    pthread_mutex_lock(&progress_mutex);
-    if (progress_tail == NULL) {
-        progress_head = progress_tail = newelem;
-    } else {
-        progress_tail->next = newelem;
-        progress_tail = newelem;
-    }
-    pthread_mutex_unlock(&progress_mutex);
-
-  fn_exit:
-    return rc;
+    return YAKSA_SUCCESS;
 }
 
-static int alloc_subop(progress_subop_s ** subop)
+/* figure out which temporary buffers the operation needs */
+static int progress_attach_slabs(yaksuri_stream_s * stream, progress_elem_s * elem)
 {
     int rc = YAKSA_SUCCESS;
-    progress_elem_s *elem = progress_head;
-    uintptr_t gpu_tmpbuf_offset = 0, host_tmpbuf_offset = 0;
-    uintptr_t nelems = UINTPTR_MAX;
     yaksuri_request_s *request_backend = (yaksuri_request_s *) elem->request->backend.priv;
     yaksuri_gpudriver_id_e id = request_backend->gpudriver_id;
     bool need_gpu_tmpbuf = false, need_host_tmpbuf = false;
@@ -202,127 +184,583 @@ static int alloc_subop(progress_subop_s ** subop)
 
     assert(need_host_tmpbuf || need_gpu_tmpbuf);
 
-    *subop = NULL;
+    elem->pup.dslab = NULL;
+    elem->pup.hslab = NULL;
+    elem->pup.devid = devid;
+    elem->pup.num_subops = 0;
+    elem->pup.inflight_bytes = 0;
 
-    /* figure out if we actually have enough buffer space */
     if (need_gpu_tmpbuf) {
-        uintptr_t d_nelems;
-        if (yaksuri_global.gpudriver[id].device[devid].slab_head_offset == 0 &&
-            yaksuri_global.gpudriver[id].device[devid].slab_tail_offset == 0) {
-            d_nelems = TMPBUF_SLAB_SIZE / elem->pup.type->size;
-            gpu_tmpbuf_offset = yaksuri_global.gpudriver[id].device[devid].slab_tail_offset;
-        } else if (yaksuri_global.gpudriver[id].device[devid].slab_tail_offset >
-                   yaksuri_global.gpudriver[id].device[devid].slab_head_offset) {
-            uintptr_t count =
-                (TMPBUF_SLAB_SIZE -
-                 yaksuri_global.gpudriver[id].device[devid].slab_tail_offset) /
-                elem->pup.type->size;
-            if (count) {
-                d_nelems = count;
-                gpu_tmpbuf_offset = yaksuri_global.gpudriver[id].device[devid].slab_tail_offset;
-            } else {
-                d_nelems =
-                    yaksuri_global.gpudriver[id].device[devid].slab_head_offset /
-                    elem->pup.type->size;
-                gpu_tmpbuf_offset = 0;
-            }
-        } else {
-            d_nelems =
-                (yaksuri_global.gpudriver[id].device[devid].slab_head_offset -
-                 yaksuri_global.gpudriver[id].device[devid].slab_tail_offset) /
-                elem->pup.type->size;
-            gpu_tmpbuf_offset = yaksuri_global.gpudriver[id].device[devid].slab_tail_offset;
-        }
+        elem->pup.dslab = &stream->gpudriver[id].device[devid];
+        elem->pup.dslab->num_users++;
+    }
+    if (need_host_tmpbuf) {
+        elem->pup.hslab = &stream->gpudriver[id].host[elem->host_node];
+        elem->pup.hslab->num_users++;
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
 
-        if (nelems > d_nelems)
-            nelems = d_nelems;
+/* move the newly submitted elements to the end of the active list;
+ * like all functions operating on the active list, this is only
+ * called from within the progress engine */
+static int progress_drain_queue(yaksuri_stream_s * stream)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksu_mpsc_node_s *node = yaksu_mpsc_drain(&stream->progress_queue);
+
+    while (node) {
+        progress_elem_s *elem = (progress_elem_s *) node;
+        node = node->next;
+
+        rc = progress_attach_slabs(stream, elem);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        elem->prev = stream->progress_tail;
+        elem->next = NULL;
+        if (stream->progress_tail == NULL)
+            stream->progress_head = elem;
+        else
+            stream->progress_tail->next = elem;
+        stream->progress_tail = elem;
     }
 
-    if (need_host_tmpbuf) {
-        uintptr_t h_nelems;
-        if (yaksuri_global.gpudriver[id].host.slab_head_offset == 0 &&
-            yaksuri_global.gpudriver[id].host.slab_tail_offset == 0) {
-            h_nelems = TMPBUF_SLAB_SIZE / elem->pup.type->size;
-            host_tmpbuf_offset = yaksuri_global.gpudriver[id].host.slab_tail_offset;
-        } else if (yaksuri_global.gpudriver[id].host.slab_tail_offset >
-                   yaksuri_global.gpudriver[id].host.slab_head_offset) {
-            uintptr_t count =
-                (TMPBUF_SLAB_SIZE -
-                 yaksuri_global.gpudriver[id].host.slab_tail_offset) / elem->pup.type->size;
-            if (count) {
-                h_nelems = count;
-                host_tmpbuf_offset = yaksuri_global.gpudriver[id].host.slab_tail_offset;
-            } else {
-                h_nelems =
-                    yaksuri_global.gpudriver[id].host.slab_head_offset / elem->pup.type->size;
-                host_tmpbuf_offset = 0;
+  fn_exit:
+    return rc;
+  fn_fail:
+    /* elements that could not be attached are lost along with their
+     * requests, which is the best we can do for an internal error */
+    goto fn_exit;
+}
+
+/* the request is completed and the element freed by the caller, once
+ * the progress mutex is released */
+static int progress_dequeue(yaksuri_stream_s * stream, progress_elem_s * elem)
+{
+    int rc = YAKSA_SUCCESS;
+
+    if (elem->pup.dslab)
+        elem->pup.dslab->num_users--;
+    if (elem->pup.hslab)
+        elem->pup.hslab->num_users--;
+
+    if (elem->prev)
+        elem->prev->next = elem->next;
+    else
+        stream->progress_head = elem->next;
+
+    if (elem->next)
+        elem->next->prev = elem->prev;
+    else
+        stream->progress_tail = elem->prev;
+
+    return rc;
+}
+
+typedef struct {
+    yaksi_request_s *request;
+    yaksur_ptr_attr_s inattr;
+    yaksur_ptr_attr_s outattr;
+    yaksuri_puptype_e puptype;
+    yaksi_info_s *info;
+    uintptr_t piece_size;
+} progress_split_s;
+
+/* the element takes over the reference to owned_type, even if the
+ * enqueue fails */
+static int enqueue_elem(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                        yaksi_type_s * owned_type, const progress_split_s * split)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_request_s *request = split->request;
+    yaksur_ptr_attr_s inattr = split->inattr;
+    yaksur_ptr_attr_s outattr = split->outattr;
+    yaksuri_puptype_e puptype = split->puptype;
+    yaksuri_stream_s *stream = (yaksuri_stream_s *) request->stream->backend.priv;
+
+    /* enqueue to the progress engine */
+    progress_elem_s *newelem;
+    rc = yaksu_freelist_elem_alloc(stream->elem_pool, (void **) &newelem);
+    if (rc) {
+        if (owned_type)
+            yaksi_type_free(owned_type);
+        goto fn_exit;
+    }
+
+    newelem->pup.puptype = puptype;
+    newelem->pup.inattr = inattr;
+    newelem->pup.outattr = outattr;
+    newelem->pup.inbuf = inbuf;
+    newelem->pup.outbuf = outbuf;
+    newelem->pup.count = count;
+    newelem->pup.type = type;
+    newelem->pup.completed_count = 0;
+    newelem->pup.issued_count = 0;
+    newelem->pup.subop_head = newelem->pup.subop_tail = NULL;
+    newelem->request = request;
+    newelem->info = split->info;
+    newelem->owned_type = owned_type;
+
+    /* host staging buffers are kept per NUMA node; use the ones on
+     * the node of the host buffer, if there is one */
+    const void *hostbuf = NULL;
+    if (inattr.type != YAKSUR_PTR_TYPE__GPU) {
+        hostbuf = inbuf;
+        if (puptype == YAKSURI_PUPTYPE__PACK)
+            hostbuf = (const char *) inbuf + type->true_lb;
+    } else if (outattr.type != YAKSUR_PTR_TYPE__GPU) {
+        hostbuf = outbuf;
+        if (puptype == YAKSURI_PUPTYPE__UNPACK)
+            hostbuf = (const char *) outbuf + type->true_lb;
+    }
+
+    newelem->host_node = 0;
+    if (hostbuf) {
+        rc = yaksu_numa_get_node(hostbuf, &newelem->host_node);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        if (newelem->host_node < 0 || newelem->host_node >= yaksuri_global.num_numa_nodes)
+            newelem->host_node = 0;
+    }
+
+    /* enqueue the new element; the progress engine picks it up the
+     * next time it is poked */
+    yaksu_atomic_incr(&request->cc);
+    yaksu_mpsc_push(&stream->progress_queue, &newelem->node);
+    yaksuri_progress_thread_submit();
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    if (owned_type)
+        yaksi_type_free(owned_type);
+    yaksu_freelist_elem_free(stream->elem_pool, newelem);
+    goto fn_exit;
+}
+
+/* Staged subops are made up of whole elements of the type, so large
+ * elements are split into pieces along the block boundaries of their
+ * type.  Consecutive blocks that fit into a piece are described by a
+ * new type of the same kind, so the GPU driver can still move them
+ * in one go; blocks that are too large themselves are split further
+ * along the boundaries of their child type.  tbuf is the typed buffer
+ * and pbuf is the packed buffer. */
+
+static int enqueue_piece(char *tbuf, char *pbuf, uintptr_t count, yaksi_type_s * type,
+                         yaksi_type_s * owned_type, const progress_split_s * split)
+{
+    if (split->puptype == YAKSURI_PUPTYPE__PACK)
+        return enqueue_elem(tbuf, pbuf, count, type, owned_type, split);
+    else
+        return enqueue_elem(pbuf, tbuf, count, type, owned_type, split);
+}
+
+static int split_count(char *tbuf, char *pbuf, uintptr_t count, yaksi_type_s * type,
+                       const progress_split_s * split);
+
+static int split_element(char *tbuf, char *pbuf, yaksi_type_s * type,
+                         const progress_split_s * split)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_type_s *slice;
+
+    switch (type->kind) {
+        case YAKSI_TYPE_KIND__CONTIG:
+            rc = split_count(tbuf, pbuf, type->u.contig.count, type->u.contig.child, split);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+            break;
+
+        case YAKSI_TYPE_KIND__DUP:
+            rc = split_element(tbuf, pbuf, type->u.dup.child, split);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+            break;
+
+        case YAKSI_TYPE_KIND__RESIZED:
+            rc = split_element(tbuf, pbuf, type->u.resized.child, split);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+            break;
+
+        case YAKSI_TYPE_KIND__SUBARRAY:
+            rc = split_element(tbuf + type->true_lb - type->u.subarray.primary->true_lb, pbuf,
+                               type->u.subarray.primary, split);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+            break;
+
+        case YAKSI_TYPE_KIND__HVECTOR:
+            {
+                int count = type->u.hvector.count;
+                int blocklength = type->u.hvector.blocklength;
+                intptr_t stride = type->u.hvector.stride;
+                yaksi_type_s *child = type->u.hvector.child;
+                uintptr_t blocksize = blocklength * child->size;
+
+                if (blocksize > split->piece_size) {
+                    for (int i = 0; i < count; i++) {
+                        rc = split_count(tbuf + i * stride, pbuf + i * blocksize, blocklength,
+                                         child, split);
+                        YAKSU_ERR_CHECK(rc, fn_fail);
+                    }
+                    break;
+                }
+
+                int nblocks = (int) (split->piece_size / blocksize);
+                for (int i = 0; i < count; i += nblocks) {
+                    int n = YAKSU_MIN(nblocks, count - i);
+
+                    rc = yaksi_type_create_hvector(n, blocklength, stride, child, &slice);
+                    YAKSU_ERR_CHECK(rc, fn_fail);
+
+                    rc = enqueue_piece(tbuf + i * stride, pbuf + i * blocksize, 1, slice, slice,
+                                       split);
+                    YAKSU_ERR_CHECK(rc, fn_fail);
+                }
             }
-        } else {
-            h_nelems =
-                (yaksuri_global.gpudriver[id].host.slab_head_offset -
-                 yaksuri_global.gpudriver[id].host.slab_tail_offset) / elem->pup.type->size;
-            host_tmpbuf_offset = yaksuri_global.gpudriver[id].host.slab_tail_offset;
-        }
+            break;
 
-        if (nelems > h_nelems)
-            nelems = h_nelems;
+        case YAKSI_TYPE_KIND__BLKHINDX:
+            {
+                int count = type->u.blkhindx.count;
+                int blocklength = type->u.blkhindx.blocklength;
+                intptr_t *displs = type->u.blkhindx.array_of_displs;
+                yaksi_type_s *child = type->u.blkhindx.child;
+                uintptr_t blocksize = blocklength * child->size;
+
+                if (blocksize > split->piece_size) {
+                    for (int i = 0; i < count; i++) {
+                        rc = split_count(tbuf + displs[i], pbuf + i * blocksize, blocklength,
+                                         child, split);
+                        YAKSU_ERR_CHECK(rc, fn_fail);
+                    }
+                    break;
+                }
+
+                int nblocks = (int) (split->piece_size / blocksize);
+                for (int i = 0; i < count; i += nblocks) {
+                    int n = YAKSU_MIN(nblocks, count - i);
+
+                    rc = yaksi_type_create_hindexed_block(n, blocklength, displs + i, child,
+                                                          &slice);
+                    YAKSU_ERR_CHECK(rc, fn_fail);
+
+                    rc = enqueue_piece(tbuf, pbuf + i * blocksize, 1, slice, slice, split);
+                    YAKSU_ERR_CHECK(rc, fn_fail);
+                }
+            }
+            break;
+
+        case YAKSI_TYPE_KIND__HINDEXED:
+        case YAKSI_TYPE_KIND__STRUCT:
+            {
+                bool is_struct = (type->kind == YAKSI_TYPE_KIND__STRUCT);
+                int count = is_struct ? type->u.str.count : type->u.hindexed.count;
+                int *blocklengths = is_struct ? type->u.str.array_of_blocklengths :
+                    type->u.hindexed.array_of_blocklengths;
+                intptr_t *displs = is_struct ? type->u.str.array_of_displs :
+                    type->u.hindexed.array_of_displs;
+
+                for (int i = 0; i < count;) {
+                    yaksi_type_s *child = is_struct ? type->u.str.array_of_types[i] :
+                        type->u.hindexed.child;
+                    uintptr_t size = blocklengths[i] * child->size;
+
+                    if (size > split->piece_size) {
+                        rc = split_count(tbuf + displs[i], pbuf, blocklengths[i], child, split);
+                        YAKSU_ERR_CHECK(rc, fn_fail);
+
+                        pbuf += size;
+                        i++;
+                        continue;
+                    }
+
+                    /* gather the following blocks that fit */
+                    int n = 1;
+                    while (i + n < count) {
+                        yaksi_type_s *next = is_struct ? type->u.str.array_of_types[i + n] :
+                            type->u.hindexed.child;
+                        uintptr_t next_size = blocklengths[i + n] * next->size;
+
+                        if (size + next_size > split->piece_size)
+                            break;
+                        size += next_size;
+                        n++;
+                    }
+
+                    if (is_struct)
+                        rc = yaksi_type_create_struct(n, blocklengths + i, displs + i,
+                                                      type->u.str.array_of_types + i, &slice);
+                    else
+                        rc = yaksi_type_create_hindexed(n, blocklengths + i, displs + i, child,
+                                                        &slice);
+                    YAKSU_ERR_CHECK(rc, fn_fail);
+
+                    rc = enqueue_piece(tbuf, pbuf, 1, slice, slice, split);
+                    YAKSU_ERR_CHECK(rc, fn_fail);
+
+                    pbuf += size;
+                    i += n;
+                }
+            }
+            break;
+
+        default:
+            /* builtin types are never larger than a piece */
+            assert(0);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+static int split_count(char *tbuf, char *pbuf, uintptr_t count, yaksi_type_s * type,
+                       const progress_split_s * split)
+{
+    int rc = YAKSA_SUCCESS;
+
+    if (type->size <= split->piece_size) {
+        rc = enqueue_piece(tbuf, pbuf, count, type, NULL, split);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+        goto fn_exit;
+    }
+
+    for (uintptr_t i = 0; i < count; i++) {
+        rc = split_element(tbuf + i * type->extent, pbuf + i * type->size, type, split);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksuri_progress_enqueue(const void *inbuf, void *outbuf, uintptr_t count, yaksi_type_s * type,
+                             yaksi_request_s * request, yaksur_ptr_attr_s inattr,
+                             yaksur_ptr_attr_s outattr, yaksuri_puptype_e puptype,
+                             yaksi_info_s * info)
+{
+    progress_split_s split;
+
+    split.request = request;
+    split.inattr = inattr;
+    split.outattr = outattr;
+    split.puptype = puptype;
+    split.info = info;
+    split.piece_size = YAKSU_MIN(yaksuri_global.staging.device_slab_size,
+                                 yaksuri_global.staging.host_slab_size) / PROGRESS_PIECES_PER_SLAB;
+
+    if (puptype == YAKSURI_PUPTYPE__PACK)
+        return split_count((char *) inbuf, (char *) outbuf, count, type, &split);
+    else
+        return split_count((char *) outbuf, (char *) inbuf, count, type, &split);
+}
+
+static uint64_t chunk_bits(int first, int num_chunks)
+{
+    if (num_chunks == YAKSURI_SLAB_NUM_CHUNKS)
+        return ~(uint64_t) 0;
+
+    return (((uint64_t) 1 << num_chunks) - 1) << first;
+}
+
+/* find the first run of at least want free chunks, or else the
+ * longest run; returns the length of the run, capped at want */
+static int find_free_chunks(uint64_t chunk_mask, int want, int *first)
+{
+    int longest = 0, run = 0;
+
+    for (int i = 0; i < YAKSURI_SLAB_NUM_CHUNKS && longest < want; i++) {
+        if (chunk_mask & ((uint64_t) 1 << i)) {
+            run = 0;
+        } else if (++run > longest) {
+            longest = run;
+            *first = i - run + 1;
+        }
     }
 
-    if (nelems > elem->pup.count - elem->pup.completed_count - elem->pup.issued_count)
-        nelems = elem->pup.count - elem->pup.completed_count - elem->pup.issued_count;
+    return longest;
+}
+
+/* the info keys override the init attributes */
+static int staging_depth(yaksi_info_s * info)
+{
+    if (info && info->staging_depth > 0)
+        return info->staging_depth;
+
+    return yaksuri_global.staging.depth;
+}
+
+static uintptr_t staging_chunk_size(yaksi_info_s * info)
+{
+    if (info && info->staging_chunk_size)
+        return info->staging_chunk_size;
+
+    return yaksuri_global.staging.chunk_size;
+}
+
+static void record_subop(progress_elem_s * elem)
+{
+    yaksu_atomic_uint64_add(&yaksuri_global.stats.staged_subops, 1);
+    if (elem->pup.num_subops > 1)
+        yaksu_atomic_uint64_add(&yaksuri_global.stats.staged_overlapped_subops, 1);
+
+    uint64_t depth = yaksu_atomic_uint64_load(&yaksuri_global.stats.staged_max_depth);
+    while (depth < (uint64_t) elem->pup.num_subops &&
+           !yaksu_atomic_uint64_cas(&yaksuri_global.stats.staged_max_depth, &depth,
+                                    (uint64_t) elem->pup.num_subops));
+}
+
+static int alloc_subop(yaksuri_stream_s * stream, progress_elem_s * elem,
+                       progress_subop_s ** subop)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksuri_request_s *request_backend = (yaksuri_request_s *) elem->request->backend.priv;
+    yaksuri_gpudriver_id_e id = request_backend->gpudriver_id;
+    yaksuri_slab_s *dslab = elem->pup.dslab, *hslab = elem->pup.hslab;
+    uintptr_t dslab_size = yaksuri_global.staging.device_slab_size;
+    uintptr_t hslab_size = yaksuri_global.staging.host_slab_size;
+    uintptr_t dunit = dslab_size / YAKSURI_SLAB_NUM_CHUNKS;
+    uintptr_t hunit = hslab_size / YAKSURI_SLAB_NUM_CHUNKS;
+    uintptr_t type_size = elem->pup.type->size;
+    uintptr_t remaining = elem->pup.count - elem->pup.completed_count - elem->pup.issued_count;
+    int gpu_chunk = 0, host_chunk = 0;
+    int gpu_num_chunks = 0, host_num_chunks = 0;
+
+    *subop = NULL;
+
+    /* the pipeline of this operation is full */
+    int depth = staging_depth(elem->info);
+    if (elem->pup.num_subops >= depth)
+        goto fn_exit;
+
+    /* an older operation is waiting for these slabs to drain */
+    if ((dslab && dslab->blocked_epoch == stream->progress_epoch) ||
+        (hslab && hslab->blocked_epoch == stream->progress_epoch))
+        goto fn_exit;
+
+    /* every operation gets a fair share of the slabs that it stages
+     * through, but at least enough space for one element of its
+     * type, so small operations are not stuck behind bulk ones */
+    uintptr_t share = UINTPTR_MAX;
+    if (dslab)
+        share = YAKSU_MIN(share, dslab_size / YAKSU_MAX(dslab->num_users, 1));
+    if (hslab)
+        share = YAKSU_MIN(share, hslab_size / YAKSU_MAX(hslab->num_users, 1));
+    share = YAKSU_MAX(share, type_size);
+
+    if (elem->pup.inflight_bytes + type_size > share)
+        goto fn_exit;
+
+    /* the share is divided among the steps of the pipeline, unless
+     * the user picked the size of the steps */
+    uintptr_t bytes = staging_chunk_size(elem->info);
+    if (bytes == 0)
+        bytes = share / depth;
+    bytes = YAKSU_MIN(bytes, share - elem->pup.inflight_bytes);
+    bytes = YAKSU_MIN(bytes, remaining * type_size);
+    bytes = YAKSU_MAX(bytes, type_size);
+
+    /* figure out if we actually have enough buffer space */
+    if (dslab) {
+        int run = find_free_chunks(dslab->chunk_mask, (int) ((bytes + dunit - 1) / dunit),
+                                   &gpu_chunk);
+        bytes = YAKSU_MIN(bytes, (uintptr_t) run * dunit);
+    }
+    if (hslab && bytes >= type_size) {
+        int run = find_free_chunks(hslab->chunk_mask, (int) ((bytes + hunit - 1) / hunit),
+                                   &host_chunk);
+        bytes = YAKSU_MIN(bytes, (uintptr_t) run * hunit);
+    }
 
-    /* if we don't have enough space, return */
-    if (nelems == 0) {
+    /* if we don't have enough space, return; an operation that has
+     * nothing in flight keeps younger operations from taking the
+     * space that is freed up in the meantime */
+    if (bytes < type_size) {
+        if (elem->pup.num_subops == 0) {
+            if (dslab)
+                dslab->blocked_epoch = stream->progress_epoch;
+            if (hslab)
+                hslab->blocked_epoch = stream->progress_epoch;
+        }
         goto fn_exit;
     }
 
+    uintptr_t nelems = YAKSU_MIN(bytes / type_size, remaining);
+    bytes = nelems * type_size;
+    if (dslab)
+        gpu_num_chunks = (int) ((bytes + dunit - 1) / dunit);
+    if (hslab)
+        host_num_chunks = (int) ((bytes + hunit - 1) / hunit);
+
 
     /* allocate the actual buffer space */
-    if (need_gpu_tmpbuf) {
-        if (yaksuri_global.gpudriver[id].device[devid].slab == NULL) {
-            yaksuri_global.gpudriver[id].device[devid].slab =
-                yaksuri_global.gpudriver[id].info->gpu_malloc(TMPBUF_SLAB_SIZE, id);
+    if (dslab) {
+        if (dslab->slab == NULL) {
+            dslab->slab = yaksuri_global.gpudriver[id].info->gpu_malloc(dslab_size,
+                                                                        elem->pup.devid);
+            YAKSU_ERR_CHKANDJUMP(!dslab->slab, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
         }
-        yaksuri_global.gpudriver[id].device[devid].slab_tail_offset =
-            gpu_tmpbuf_offset + nelems * elem->pup.type->size;
     }
 
-    if (need_host_tmpbuf) {
-        if (yaksuri_global.gpudriver[id].host.slab == NULL) {
-            yaksuri_global.gpudriver[id].host.slab =
-                yaksuri_global.gpudriver[id].info->host_malloc(TMPBUF_SLAB_SIZE);
+    if (hslab) {
+        if (hslab->slab == NULL) {
+            /* the host driver allocation touches the pages, so place
+             * them on the node of the user buffer */
+            rc = yaksu_numa_set_preferred_node(elem->host_node);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            hslab->slab = yaksuri_global.gpudriver[id].info->host_malloc(hslab_size);
+
+            rc = yaksu_numa_set_preferred_node(YAKSU_NUMA_NODE__UNKNOWN);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+            YAKSU_ERR_CHKANDJUMP(!hslab->slab, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
         }
-        yaksuri_global.gpudriver[id].host.slab_tail_offset =
-            host_tmpbuf_offset + nelems * elem->pup.type->size;
     }
 
 
     /* allocate the subop */
-    *subop = (progress_subop_s *) malloc(sizeof(progress_subop_s));
+    rc = yaksu_freelist_elem_alloc(stream->subop_pool, (void **) subop);
+    YAKSU_ERR_CHECK(rc, fn_fail);
 
     (*subop)->count_offset = elem->pup.completed_count + elem->pup.issued_count;
     (*subop)->count = nelems;
-    if (need_gpu_tmpbuf)
-        (*subop)->gpu_tmpbuf =
-            (void *) ((char *) yaksuri_global.gpudriver[id].device[devid].slab + gpu_tmpbuf_offset);
+    if (dslab)
+        (*subop)->gpu_tmpbuf = (void *) ((char *) dslab->slab + gpu_chunk * dunit);
     else
         (*subop)->gpu_tmpbuf = NULL;
 
-    if (need_host_tmpbuf)
-        (*subop)->host_tmpbuf =
-            (void *) ((char *) yaksuri_global.gpudriver[id].host.slab + host_tmpbuf_offset);
+    if (hslab)
+        (*subop)->host_tmpbuf = (void *) ((char *) hslab->slab + host_chunk * hunit);
     else
         (*subop)->host_tmpbuf = NULL;
 
     (*subop)->interm_event = NULL;
     (*subop)->event = NULL;
+    (*subop)->gpu_chunk = gpu_chunk;
+    (*subop)->gpu_num_chunks = gpu_num_chunks;
+    (*subop)->host_chunk = host_chunk;
+    (*subop)->host_num_chunks = host_num_chunks;
     (*subop)->next = NULL;
 
+    if (dslab)
+        dslab->chunk_mask |= chunk_bits(gpu_chunk, gpu_num_chunks);
+    if (hslab)
+        hslab->chunk_mask |= chunk_bits(host_chunk, host_num_chunks);
+    elem->pup.num_subops++;
+    elem->pup.inflight_bytes += bytes;
+    record_subop(elem);
+
     if (elem->pup.subop_tail == NULL) {
         assert(elem->pup.subop_head == NULL);
         elem->pup.subop_head = elem->pup.subop_tail = *subop;
     } else {
         elem->pup.subop_tail->next = *subop;
+        elem->pup.subop_tail = *subop;
     }
 
   fn_exit:
@@ -331,10 +769,9 @@ static int alloc_subop(progress_subop_s ** subop)
     goto fn_exit;
 }
 
-static int free_subop(progress_subop_s * subop)
+static int free_subop(yaksuri_stream_s * stream, progress_elem_s * elem, progress_subop_s * subop)
 {
     int rc = YAKSA_SUCCESS;
-    progress_elem_s *elem = progress_head;
     yaksuri_request_s *request_backend = (yaksuri_request_s *) elem->request->backend.priv;
     yaksuri_gpudriver_id_e id = request_backend->gpudriver_id;
 
@@ -346,90 +783,37 @@ static int free_subop(progress_subop_s * subop)
     rc = yaksuri_global.gpudriver[id].info->event_destroy(subop->event);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
-    /* free the device buffer */
-    if (subop->gpu_tmpbuf) {
-        int devid;
+    /* release the slab chunks; subops of different operations are
+     * freed in any order */
+    if (subop->gpu_tmpbuf)
+        elem->pup.dslab->chunk_mask &= ~chunk_bits(subop->gpu_chunk, subop->gpu_num_chunks);
+    if (subop->host_tmpbuf)
+        elem->pup.hslab->chunk_mask &= ~chunk_bits(subop->host_chunk, subop->host_num_chunks);
+    elem->pup.num_subops--;
+    elem->pup.inflight_bytes -= subop->count * elem->pup.type->size;
 
-        if (elem->pup.puptype == YAKSURI_PUPTYPE__PACK)
-            devid = elem->pup.inattr.device;
-        else
-            devid = elem->pup.outattr.device;
-
-        assert(subop->gpu_tmpbuf ==
-               (char *) yaksuri_global.gpudriver[id].device[devid].slab +
-               yaksuri_global.gpudriver[id].device[devid].slab_head_offset);
-        if (subop->next) {
-            yaksuri_global.gpudriver[id].device[devid].slab_head_offset =
-                (uintptr_t) ((char *) subop->next->gpu_tmpbuf -
-                             (char *) yaksuri_global.gpudriver[id].device[devid].slab);
-        } else {
-            yaksuri_global.gpudriver[id].device[devid].slab_head_offset =
-                yaksuri_global.gpudriver[id].device[devid].slab_tail_offset = 0;
-        }
-    }
+    /* subops of the same operation complete in order, so the
+     * completed subop is always the first one */
+    assert(elem->pup.subop_head == subop);
+    elem->pup.subop_head = subop->next;
+    if (elem->pup.subop_head == NULL)
+        elem->pup.subop_tail = NULL;
 
-    /* free the host buffer */
-    if (subop->host_tmpbuf) {
-        assert(subop->host_tmpbuf ==
-               (char *) yaksuri_global.gpudriver[id].host.slab +
-               yaksuri_global.gpudriver[id].host.slab_head_offset);
-        if (subop->next) {
-            yaksuri_global.gpudriver[id].host.slab_head_offset =
-                (uintptr_t) ((char *) subop->next->gpu_tmpbuf -
-                             (char *) yaksuri_global.gpudriver[id].host.slab);
-        } else {
-            yaksuri_global.gpudriver[id].host.slab_head_offset =
-                yaksuri_global.gpudriver[id].host.slab_tail_offset = 0;
-        }
-    }
-
-    if (elem->pup.subop_head == subop && elem->pup.subop_tail == subop) {
-        elem->pup.subop_head = elem->pup.subop_tail = NULL;
-    } else if (elem->pup.subop_head == subop) {
-        elem->pup.subop_head = subop->next;
-    } else {
-        for (progress_subop_s * tmp = elem->pup.subop_head; tmp->next; tmp = tmp->next) {
-            if (tmp->next == subop) {
-                tmp->next = subop->next;
-                if (elem->pup.subop_tail == subop)
-                    elem->pup.subop_tail = tmp;
-                break;
-            }
-        }
-    }
-
-    free(subop);
+    yaksu_freelist_elem_free(stream->subop_pool, subop);
 
   fn_exit:
     return rc;
   fn_fail:
     goto fn_exit;
 }
-
-int yaksuri_progress_poke(void)
+/* the progress engine has three steps for each operation: (1) check
+ * for completions and free up any held up resources; (2) if we don't
+ * have anything else to do, return; and (3) issue any pending
+ * subops. */
+static int progress_elem(yaksuri_stream_s * stream, progress_elem_s * elem,
+                         yaksi_type_s * byte_type, bool * is_complete)
 {
     int rc = YAKSA_SUCCESS;
-
-    /* We only poke the head of the progress engine as all of our
-     * operations are independent.  This reduces the complexity of the
-     * progress engine and keeps the amount of time we spend in the
-     * progress engine small. */
-
-    pthread_mutex_lock(&progress_mutex);
-
-    /* if there's nothing to do, return */
-    if (progress_head == NULL)
-        goto fn_exit;
-
-    /* the progress engine has three steps: (1) check for completions
-     * and free up any held up resources; (2) if we don't have
-     * anything else to do, return; and (3) issue any pending
-     * subops. */
-    yaksi_type_s *byte_type;
-    rc = yaksi_type_get(YAKSA_TYPE__BYTE, &byte_type);
-    YAKSU_ERR_CHECK(rc, fn_fail);
-
-    progress_elem_s *elem = progress_head;
     yaksuri_request_s *request_backend = (yaksuri_request_s *) elem->request->backend.priv;
     yaksuri_gpudriver_id_e id = request_backend->gpudriver_id;
 
@@ -464,7 +848,7 @@ int yaksuri_progress_poke(void)
             elem->pup.issued_count -= subop->count;
 
             progress_subop_s *tmp = subop->next;
-            rc = free_subop(subop);
+            rc = free_subop(stream, elem, subop);
             YAKSU_ERR_CHECK(rc, fn_fail);
             subop = tmp;
         } else {
@@ -476,11 +860,9 @@ int yaksuri_progress_poke(void)
     /****************************************************************************/
     /* Step 2: If we don't have any more work to do, return */
     /****************************************************************************/
-    if (elem->pup.completed_count == elem->pup.count) {
-        rc = progress_dequeue(elem);
-        YAKSU_ERR_CHECK(rc, fn_fail);
+    *is_complete = (elem->pup.completed_count == elem->pup.count);
+    if (*is_complete)
         goto fn_exit;
-    }
 
 
     /****************************************************************************/
@@ -489,7 +871,7 @@ int yaksuri_progress_poke(void)
     while (elem->pup.completed_count + elem->pup.issued_count < elem->pup.count) {
         progress_subop_s *subop;
 
-        rc = alloc_subop(&subop);
+        rc = alloc_subop(stream, elem, &subop);
         YAKSU_ERR_CHECK(rc, fn_fail);
 
         if (subop == NULL) {
@@ -669,7 +1051,76 @@ int yaksuri_progress_poke(void)
     }
 
   fn_exit:
-    pthread_mutex_unlock(&progress_mutex);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksuri_progress_poke(yaksuri_stream_s * stream)
+{
+    int rc = YAKSA_SUCCESS;
+    progress_elem_s *completed = NULL;
+
+    /* Subops are issued for all of the active operations, so
+     * operations to different devices or in different directions
+     * proceed concurrently, and a bulk operation only holds its share
+     * of the temporary buffers. */
+
+    /* if some other thread is already making progress on this
+     * stream, there is no need to wait for it; callers poke in a
+     * loop, so let that thread have the CPU */
+    if (pthread_mutex_trylock(&stream->progress_mutex)) {
+        sched_yield();
+        return rc;
+    }
+
+    rc = progress_drain_queue(stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    /* if there's nothing to do, return */
+    if (stream->progress_head == NULL)
+        goto fn_exit;
+
+    yaksi_type_s *byte_type;
+    rc = yaksi_type_get(YAKSA_TYPE__BYTE, &byte_type);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    stream->progress_epoch++;
+
+    for (progress_elem_s * elem = stream->progress_head; elem;) {
+        progress_elem_s *next = elem->next;
+        bool is_complete = false;
+
+        rc = progress_elem(stream, elem, byte_type, &is_complete);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        if (is_complete) {
+            rc = progress_dequeue(stream, elem);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            elem->next = completed;
+            completed = elem;
+        }
+
+        elem = next;
+    }
+
+  fn_exit:
+    pthread_mutex_unlock(&stream->progress_mutex);
+
+    /* operations that depend on these requests might be issued on the
+     * same stream, so complete them outside the progress mutex */
+    while (completed) {
+        progress_elem_s *next = completed->next;
+
+        if (completed->owned_type)
+            yaksi_type_free(completed->owned_type);
+        if (rc == YAKSA_SUCCESS)
+            rc = yaksi_request_complete(completed->request);
+        yaksu_freelist_elem_free(stream->elem_pool, completed);
+        yaksuri_progress_thread_complete();
+        completed = next;
+    }
     return rc;
   fn_fail:
     goto fn_exit;
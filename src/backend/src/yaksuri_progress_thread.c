@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#define _GNU_SOURCE
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+#include "yaksa.h"
+#include "yaksi.h"
+#include "yaksu.h"
+#include "yaksuri.h"
+
+/* The progress thread pokes every stream while staged operations are
+ * in flight, so their pipelines advance while the application is
+ * busy; yaksa_request_test and yaksa_request_wait then only observe
+ * the completion.  While there is nothing in flight, the thread
+ * sleeps on the count of pending operations, and the first submitted
+ * operation wakes it up.
+ *
+ * The streams are registered in an array that is protected by a
+ * recursive mutex, which the thread holds for each pass over the
+ * streams.  Stream creation and destruction wait for the pass to
+ * end, except when they are called from a request callback on the
+ * thread itself. */
+
+typedef struct {
+    bool enabled;
+    int cpu;
+    int interval_us;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    yaksu_atomic_int shutdown;
+
+    /* operations submitted to the progress engine and not yet
+     * completed */
+    yaksu_atomic_int pending;
+
+    yaksuri_stream_s **streams;
+    int nstreams;
+    int maxstreams;
+} progress_thread_s;
+
+static progress_thread_s progress_thread;
+
+static void *progress_thread_fn(void *arg)
+{
+    int rc;
+
+    /* binding is only a performance hint, so ignore failures */
+    if (progress_thread.cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(progress_thread.cpu, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
+
+    while (!yaksu_atomic_load(&progress_thread.shutdown)) {
+        int pending = yaksu_atomic_load(&progress_thread.pending);
+        if (pending == 0) {
+            rc = yaksu_futex_wait(&progress_thread.pending, pending);
+            assert(rc == YAKSA_SUCCESS);
+            continue;
+        }
+
+        /* streams created by request callbacks are picked up in the
+         * same pass */
+        pthread_mutex_lock(&progress_thread.mutex);
+        for (int i = 0; i < progress_thread.nstreams; i++) {
+            rc = yaksuri_progress_poke(progress_thread.streams[i]);
+            assert(rc == YAKSA_SUCCESS);
+        }
+        pthread_mutex_unlock(&progress_thread.mutex);
+
+        if (!yaksu_atomic_load(&progress_thread.pending))
+            continue;
+
+        /* give the devices and the application threads some time
+         * between passes */
+        if (progress_thread.interval_us) {
+            struct timespec ts;
+            ts.tv_sec = progress_thread.interval_us / 1000000;
+            ts.tv_nsec = (long) (progress_thread.interval_us % 1000000) * 1000;
+            nanosleep(&ts, NULL);
+        } else {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+int yaksuri_progress_thread_init(yaksa_init_attr_t attr)
+{
+    int rc = YAKSA_SUCCESS;
+
+    progress_thread.enabled = (attr.progress_thread != 0);
+    if (!progress_thread.enabled)
+        goto fn_exit;
+
+    progress_thread.cpu = attr.progress_thread_cpu;
+    progress_thread.interval_us = attr.progress_thread_interval_us > 0 ?
+        attr.progress_thread_interval_us : 0;
+    yaksu_atomic_store(&progress_thread.shutdown, 0);
+    yaksu_atomic_store(&progress_thread.pending, 0);
+    progress_thread.streams = NULL;
+    progress_thread.nstreams = 0;
+    progress_thread.maxstreams = 0;
+
+    pthread_mutexattr_t mutexattr;
+    pthread_mutexattr_init(&mutexattr);
+    pthread_mutexattr_settype(&mutexattr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&progress_thread.mutex, &mutexattr);
+    pthread_mutexattr_destroy(&mutexattr);
+
+    int ret = pthread_create(&progress_thread.thread, NULL, progress_thread_fn, NULL);
+    if (ret) {
+        pthread_mutex_destroy(&progress_thread.mutex);
+        progress_thread.enabled = false;
+        rc = YAKSA_ERR__INTERNAL;
+        goto fn_fail;
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksuri_progress_thread_finalize(void)
+{
+    if (!progress_thread.enabled)
+        goto fn_exit;
+
+    /* changing the count makes sure that the thread does not go to
+     * sleep after checking for the shutdown */
+    yaksu_atomic_store(&progress_thread.shutdown, 1);
+    yaksu_atomic_incr(&progress_thread.pending);
+    yaksu_futex_wake(&progress_thread.pending);
+
+    pthread_join(progress_thread.thread, NULL);
+
+    assert(progress_thread.nstreams == 0);
+    free(progress_thread.streams);
+    pthread_mutex_destroy(&progress_thread.mutex);
+    progress_thread.enabled = false;
+
+  fn_exit:
+    return YAKSA_SUCCESS;
+}
+
+bool yaksuri_progress_thread_is_enabled(void)
+{
+    return progress_thread.enabled;
+}
+
+int yaksuri_progress_thread_add_stream(yaksuri_stream_s * stream)
+{
+    int rc = YAKSA_SUCCESS;
+
+    if (!progress_thread.enabled)
+        goto fn_exit;
+
+    pthread_mutex_lock(&progress_thread.mutex);
+    if (progress_thread.nstreams == progress_thread.maxstreams) {
+        int maxstreams = progress_thread.maxstreams ? 2 * progress_thread.maxstreams : 16;
+        yaksuri_stream_s **streams = (yaksuri_stream_s **)
+            realloc(progress_thread.streams, maxstreams * sizeof(yaksuri_stream_s *));
+        if (streams == NULL) {
+            pthread_mutex_unlock(&progress_thread.mutex);
+            rc = YAKSA_ERR__OUT_OF_MEM;
+            goto fn_fail;
+        }
+        progress_thread.streams = streams;
+        progress_thread.maxstreams = maxstreams;
+    }
+    progress_thread.streams[progress_thread.nstreams++] = stream;
+    pthread_mutex_unlock(&progress_thread.mutex);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+void yaksuri_progress_thread_remove_stream(yaksuri_stream_s * stream)
+{
+    if (!progress_thread.enabled)
+        return;
+
+    pthread_mutex_lock(&progress_thread.mutex);
+    for (int i = 0; i < progress_thread.nstreams; i++) {
+        if (progress_thread.streams[i] == stream) {
+            progress_thread.streams[i] = progress_thread.streams[--progress_thread.nstreams];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&progress_thread.mutex);
+}
+
+/* the first operation in flight wakes the thread up */
+void yaksuri_progress_thread_submit(void)
+{
+    if (!progress_thread.enabled)
+        return;
+
+    if (yaksu_atomic_incr(&progress_thread.pending) == 0)
+        yaksu_futex_wake(&progress_thread.pending);
+}
+
+void yaksuri_progress_thread_complete(void)
+{
+    if (!progress_thread.enabled)
+        return;
+
+    yaksu_atomic_decr(&progress_thread.pending);
+}
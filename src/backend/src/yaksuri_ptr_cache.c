@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "yaksa.h"
+#include "yaksi.h"
+#include "yaksu.h"
+#include "yaksuri.h"
+
+/* The pointer-attribute cache remembers the classification of address
+ * ranges, so repeated operations on the same buffers do not query the
+ * GPU drivers again.  The ranges are kept sorted by their base address
+ * and never overlap, so a lookup is a binary search.
+ *
+ * Entries are only ever inserted for ranges whose classification the
+ * drivers vouched for.  They are dropped when a range is unregistered
+ * (yaksa_buffer_unregister), which bumps the generation; an insertion
+ * that raced with an unregistration is discarded.  When the cache
+ * fills up, it is simply emptied.  Like the hostgpu registry, the
+ * cache is statically initialized, as buffers can be unregistered
+ * outside of yaksa_init and yaksa_finalize. */
+
+#define PTR_CACHE_MAX_ENTRIES  (4096)
+
+typedef struct {
+    uintptr_t base;
+    uintptr_t size;
+    yaksur_ptr_attr_s attr;
+    yaksuri_gpudriver_id_e id;
+} ptr_cache_entry_s;
+
+static ptr_cache_entry_s *ptr_cache = NULL;
+static uintptr_t ptr_cache_len = 0;
+static uint64_t ptr_cache_generation = 0;
+static pthread_rwlock_t ptr_cache_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/* index of the first entry whose base is larger than addr */
+static uintptr_t ptr_cache_upper_bound(uintptr_t addr)
+{
+    uintptr_t lo = 0, hi = ptr_cache_len;
+
+    while (lo < hi) {
+        uintptr_t mid = lo + (hi - lo) / 2;
+        if (ptr_cache[mid].base <= addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+bool yaksuri_ptr_cache_lookup(const void *buf, yaksur_ptr_attr_s * ptrattr,
+                              yaksuri_gpudriver_id_e * id, uint64_t * generation)
+{
+    uintptr_t addr = (uintptr_t) buf;
+    bool found = false;
+
+    pthread_rwlock_rdlock(&ptr_cache_lock);
+
+    uintptr_t idx = ptr_cache_upper_bound(addr);
+    if (idx && addr - ptr_cache[idx - 1].base < ptr_cache[idx - 1].size) {
+        *ptrattr = ptr_cache[idx - 1].attr;
+        *id = ptr_cache[idx - 1].id;
+        found = true;
+    }
+    *generation = ptr_cache_generation;
+
+    pthread_rwlock_unlock(&ptr_cache_lock);
+
+    return found;
+}
+
+void yaksuri_ptr_cache_insert(uintptr_t base, uintptr_t size, yaksur_ptr_attr_s ptrattr,
+                              yaksuri_gpudriver_id_e id, uint64_t generation)
+{
+    if (size == 0)
+        return;
+
+    pthread_rwlock_wrlock(&ptr_cache_lock);
+
+    /* the classification might be stale, if a range was unregistered
+     * since the drivers were queried */
+    if (generation != ptr_cache_generation)
+        goto fn_exit;
+
+    if (ptr_cache == NULL) {
+        ptr_cache = (ptr_cache_entry_s *) malloc(PTR_CACHE_MAX_ENTRIES *
+                                                 sizeof(ptr_cache_entry_s));
+        if (ptr_cache == NULL)
+            goto fn_exit;
+    }
+
+    if (ptr_cache_len == PTR_CACHE_MAX_ENTRIES)
+        ptr_cache_len = 0;
+
+    /* another thread might have inserted an overlapping range in the
+     * meantime */
+    uintptr_t idx = ptr_cache_upper_bound(base);
+    if (idx && base - ptr_cache[idx - 1].base < ptr_cache[idx - 1].size)
+        goto fn_exit;
+    if (idx < ptr_cache_len && ptr_cache[idx].base - base < size)
+        goto fn_exit;
+
+    memmove(&ptr_cache[idx + 1], &ptr_cache[idx], (ptr_cache_len - idx) * sizeof(ptr_cache_entry_s));
+    ptr_cache[idx].base = base;
+    ptr_cache[idx].size = size;
+    ptr_cache[idx].attr = ptrattr;
+    ptr_cache[idx].id = id;
+    ptr_cache_len++;
+
+  fn_exit:
+    pthread_rwlock_unlock(&ptr_cache_lock);
+}
+
+void yaksuri_ptr_cache_invalidate(const void *buf, uintptr_t size)
+{
+    uintptr_t base = (uintptr_t) buf;
+    uintptr_t end = (size > UINTPTR_MAX - base) ? UINTPTR_MAX : base + size;
+
+    pthread_rwlock_wrlock(&ptr_cache_lock);
+
+    ptr_cache_generation++;
+    if (ptr_cache_len == 0)
+        goto fn_exit;
+
+    /* drop every entry that overlaps [base, end) */
+    uintptr_t first = ptr_cache_upper_bound(base);
+    if (first && base - ptr_cache[first - 1].base < ptr_cache[first - 1].size)
+        first--;
+    uintptr_t last = first;
+    while (last < ptr_cache_len && ptr_cache[last].base < end)
+        last++;
+
+    memmove(&ptr_cache[first], &ptr_cache[last], (ptr_cache_len - last) * sizeof(ptr_cache_entry_s));
+    ptr_cache_len -= last - first;
+
+  fn_exit:
+    pthread_rwlock_unlock(&ptr_cache_lock);
+}
+
+void yaksuri_ptr_cache_finalize(void)
+{
+    pthread_rwlock_wrlock(&ptr_cache_lock);
+
+    ptr_cache_generation++;
+    free(ptr_cache);
+    ptr_cache = NULL;
+    ptr_cache_len = 0;
+
+    pthread_rwlock_unlock(&ptr_cache_lock);
+}
@@ -9,5 +9,8 @@ include $(top_srcdir)/src/frontend/include/Makefile.mk
 include $(top_srcdir)/src/frontend/info/Makefile.mk
 include $(top_srcdir)/src/frontend/init/Makefile.mk
 include $(top_srcdir)/src/frontend/iov/Makefile.mk
+include $(top_srcdir)/src/frontend/plan/Makefile.mk
 include $(top_srcdir)/src/frontend/pup/Makefile.mk
+include $(top_srcdir)/src/frontend/stats/Makefile.mk
+include $(top_srcdir)/src/frontend/stream/Makefile.mk
 include $(top_srcdir)/src/frontend/types/Makefile.mk
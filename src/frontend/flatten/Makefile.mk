@@ -8,4 +8,8 @@ AM_CPPFLAGS += -I$(top_srcdir)/src/frontend/flatten
 libyaksa_la_SOURCES += \
 	src/frontend/flatten/yaksa_flatten_size.c \
 	src/frontend/flatten/yaksa_flatten.c \
-	src/frontend/flatten/yaksa_unflatten.c
+	src/frontend/flatten/yaksa_unflatten.c \
+	src/frontend/flatten/yaksa_type_library.c
+
+noinst_HEADERS += \
+	src/frontend/flatten/yaksi_flatten.h
@@ -5,85 +5,281 @@
 
 #include "yaksi.h"
 #include "yaksu.h"
+#include "yaksi_flatten.h"
 #include <assert.h>
 #include <string.h>
+#include <stdlib.h>
 
-static int flatten(yaksi_type_s * type, void *flattened_type)
+/* the non-builtin nodes emitted so far, in an open-addressing hash
+ * table keyed by their address */
+typedef struct {
+    const yaksi_type_s *type;
+    uintptr_t idx;
+} node_s;
+
+typedef struct {
+    node_s *table;
+    uintptr_t capacity;         /* a power of two */
+    uintptr_t count;
+} node_map_s;
+
+/* the encoder only counts the bytes when there is no buffer */
+typedef struct {
+    char *buf;
+    uintptr_t len;
+    bool raw_arrays;
+    node_map_s nodes;
+} sink_s;
+
+static inline void put_uint(sink_s * sink, uint64_t val)
+{
+    if (sink->buf == NULL) {
+        do {
+            sink->len++;
+            val >>= 7;
+        } while (val);
+        return;
+    }
+
+    unsigned char *p = (unsigned char *) sink->buf + sink->len;
+    while (val >= 0x80) {
+        *p++ = (unsigned char) (val | 0x80);
+        val >>= 7;
+    }
+    *p++ = (unsigned char) val;
+    sink->len = (uintptr_t) ((char *) p - sink->buf);
+}
+
+static inline void put_int(sink_s * sink, int64_t val)
+{
+    put_uint(sink, yaksi_flatten_zigzag(val));
+}
+
+/* blocklengths are ints and displacements are intptr_ts */
+static inline int64_t seq_get(const void *array, bool is_int, uintptr_t idx)
+{
+    return is_int ? ((const int *) array)[idx] : (int64_t) ((const intptr_t *) array)[idx];
+}
+
+/* the deltas wrap around like the decoder's sums, so any values
+ * survive the trip */
+static inline int64_t seq_delta(int64_t val, int64_t prev)
+{
+    return (int64_t) ((uint64_t) val - (uint64_t) prev);
+}
+
+static void put_raw(sink_s * sink, const void *array, uintptr_t elem_size, uintptr_t count)
+{
+    put_uint(sink, 0);
+    put_uint(sink, elem_size);
+
+    while (sink->len % YAKSI_FLATTEN_RAW_ALIGNMENT) {
+        if (sink->buf)
+            sink->buf[sink->len] = 0;
+        sink->len++;
+    }
+
+    if (sink->buf)
+        memcpy(sink->buf + sink->len, array, count * elem_size);
+    sink->len += count * elem_size;
+}
+
+static void put_seq(sink_s * sink, const void *array, bool is_int, uintptr_t count)
+{
+    int64_t prev = 0;
+    uintptr_t lit_start = 0, i = 0;
+
+    if (sink->raw_arrays) {
+        put_raw(sink, array, is_int ? sizeof(int) : sizeof(intptr_t), count);
+        return;
+    }
+
+    while (i < count) {
+        /* measure the progression that starts here */
+        uintptr_t len = 1;
+        int64_t stride = 0;
+        if (i + YAKSI_FLATTEN_MIN_RUN <= count) {
+            stride = seq_delta(seq_get(array, is_int, i + 1), seq_get(array, is_int, i));
+            len = 2;
+            while (i + len < count &&
+                   seq_delta(seq_get(array, is_int, i + len),
+                             seq_get(array, is_int, i + len - 1)) == stride)
+                len++;
+        }
+
+        if (len < YAKSI_FLATTEN_MIN_RUN) {
+            i++;
+            continue;
+        }
+
+        /* flush the literals that came before the run */
+        if (lit_start < i) {
+            put_uint(sink, (uint64_t) (i - lit_start) << 1);
+            for (uintptr_t j = lit_start; j < i; j++) {
+                int64_t val = seq_get(array, is_int, j);
+                put_int(sink, seq_delta(val, prev));
+                prev = val;
+            }
+        }
+
+        int64_t first = seq_get(array, is_int, i);
+        put_uint(sink, ((uint64_t) len << 1) | 1);
+        put_int(sink, seq_delta(first, prev));
+        put_int(sink, stride);
+        prev = seq_get(array, is_int, i + len - 1);
+
+        i += len;
+        lit_start = i;
+    }
+
+    if (lit_start < count) {
+        put_uint(sink, (uint64_t) (count - lit_start) << 1);
+        for (uintptr_t j = lit_start; j < count; j++) {
+            int64_t val = seq_get(array, is_int, j);
+            put_int(sink, seq_delta(val, prev));
+            prev = val;
+        }
+    }
+}
+
+static inline uintptr_t node_map_slot(const node_map_s * map, const yaksi_type_s * type)
+{
+    uintptr_t slot = (((uintptr_t) type) >> 4) * (uintptr_t) 0x9e3779b97f4a7c15ULL;
+
+    while (1) {
+        slot &= map->capacity - 1;
+        if (map->table[slot].type == NULL || map->table[slot].type == type)
+            return slot;
+        slot++;
+    }
+}
+
+/* looks up the index of the type, or assigns it the next one; the
+ * table is kept at most half full */
+static int node_map_get(node_map_s * map, const yaksi_type_s * type, uintptr_t * idx,
+                        bool * is_new)
 {
     int rc = YAKSA_SUCCESS;
-    char *flatbuf = (char *) flattened_type;
 
-    /* copy this type */
-    memcpy(flatbuf, type, sizeof(yaksi_type_s));
-    flatbuf += sizeof(yaksi_type_s);
+    if (2 * (map->count + 1) > map->capacity) {
+        node_map_s newmap;
 
-    switch (type->kind) {
-        case YAKSI_TYPE_KIND__BUILTIN:
-            break;
+        newmap.capacity = map->capacity ? 2 * map->capacity : 64;
+        newmap.count = map->count;
+        newmap.table = (node_s *) calloc(newmap.capacity, sizeof(node_s));
+        YAKSU_ERR_CHKANDJUMP(!newmap.table, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+        for (uintptr_t i = 0; i < map->capacity; i++)
+            if (map->table[i].type)
+                newmap.table[node_map_slot(&newmap, map->table[i].type)] = map->table[i];
 
+        free(map->table);
+        *map = newmap;
+    }
+
+    uintptr_t slot = node_map_slot(map, type);
+    *is_new = (map->table[slot].type == NULL);
+    if (*is_new) {
+        map->table[slot].type = type;
+        map->table[slot].idx = map->count++;
+    }
+    *idx = map->table[slot].idx;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+static int flatten(yaksi_type_s * type, sink_s * sink)
+{
+    int rc = YAKSA_SUCCESS;
+
+    /* builtin types exist in every process */
+    if (type->kind == YAKSI_TYPE_KIND__BUILTIN) {
+        put_uint(sink, (uint64_t) type->kind);
+        put_uint(sink, (uint64_t) type->id);
+        goto fn_exit;
+    }
+
+    /* types that were emitted before are referred to by their index */
+    uintptr_t idx;
+    bool is_new;
+    rc = node_map_get(&sink->nodes, type, &idx, &is_new);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    if (!is_new) {
+        put_uint(sink, YAKSI_FLATTEN_BACKREF);
+        put_uint(sink, idx);
+        goto fn_exit;
+    }
+
+    put_uint(sink, (uint64_t) type->kind);
+    put_uint(sink, (uint64_t) type->tree_depth);
+    put_uint(sink, type->alignment);
+    put_uint(sink, type->size);
+    put_uint(sink, type->extent);
+    put_int(sink, type->lb);
+    put_int(sink, type->ub);
+    put_int(sink, type->true_lb);
+    put_int(sink, type->true_ub);
+    put_uint(sink, type->is_contig);
+    put_uint(sink, type->num_contig);
+
+    switch (type->kind) {
         case YAKSI_TYPE_KIND__CONTIG:
-            rc = flatten(type->u.contig.child, flatbuf);
+            put_int(sink, type->u.contig.count);
+            rc = flatten(type->u.contig.child, sink);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__DUP:
-            rc = flatten(type->u.dup.child, flatbuf);
+            rc = flatten(type->u.dup.child, sink);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__RESIZED:
-            rc = flatten(type->u.resized.child, flatbuf);
+            rc = flatten(type->u.resized.child, sink);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__HVECTOR:
-            rc = flatten(type->u.hvector.child, flatbuf);
+            put_int(sink, type->u.hvector.count);
+            put_int(sink, type->u.hvector.blocklength);
+            put_int(sink, type->u.hvector.stride);
+            rc = flatten(type->u.hvector.child, sink);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__BLKHINDX:
-            memcpy(flatbuf, type->u.blkhindx.array_of_displs,
-                   type->u.blkhindx.count * sizeof(intptr_t));
-            flatbuf += type->u.blkhindx.count * sizeof(intptr_t);
-
-            rc = flatten(type->u.blkhindx.child, flatbuf);
+            put_int(sink, type->u.blkhindx.count);
+            put_int(sink, type->u.blkhindx.blocklength);
+            put_seq(sink, type->u.blkhindx.array_of_displs, false, type->u.blkhindx.count);
+            rc = flatten(type->u.blkhindx.child, sink);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__HINDEXED:
-            memcpy(flatbuf, type->u.hindexed.array_of_blocklengths,
-                   type->u.hindexed.count * sizeof(int));
-            flatbuf += type->u.hindexed.count * sizeof(int);
-
-            memcpy(flatbuf, type->u.hindexed.array_of_displs,
-                   type->u.hindexed.count * sizeof(intptr_t));
-            flatbuf += type->u.hindexed.count * sizeof(intptr_t);
-
-            rc = flatten(type->u.hindexed.child, flatbuf);
+            put_int(sink, type->u.hindexed.count);
+            put_seq(sink, type->u.hindexed.array_of_blocklengths, true, type->u.hindexed.count);
+            put_seq(sink, type->u.hindexed.array_of_displs, false, type->u.hindexed.count);
+            rc = flatten(type->u.hindexed.child, sink);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__STRUCT:
-            memcpy(flatbuf, type->u.str.array_of_blocklengths, type->u.str.count * sizeof(int));
-            flatbuf += type->u.str.count * sizeof(int);
-
-            memcpy(flatbuf, type->u.str.array_of_displs, type->u.str.count * sizeof(intptr_t));
-            flatbuf += type->u.str.count * sizeof(intptr_t);
-
+            put_int(sink, type->u.str.count);
+            put_seq(sink, type->u.str.array_of_blocklengths, true, type->u.str.count);
+            put_seq(sink, type->u.str.array_of_displs, false, type->u.str.count);
             for (int i = 0; i < type->u.str.count; i++) {
-                rc = flatten(type->u.str.array_of_types[i], flatbuf);
+                rc = flatten(type->u.str.array_of_types[i], sink);
                 YAKSU_ERR_CHECK(rc, fn_fail);
-
-                uintptr_t tmp;
-                rc = yaksi_flatten_size(type->u.str.array_of_types[i], &tmp);
-                YAKSU_ERR_CHECK(rc, fn_fail);
-
-                flatbuf += tmp;
             }
             break;
 
         case YAKSI_TYPE_KIND__SUBARRAY:
-            rc = flatten(type->u.subarray.primary, flatbuf);
+            put_int(sink, type->u.subarray.ndims);
+            rc = flatten(type->u.subarray.primary, sink);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
@@ -97,6 +293,41 @@ static int flatten(yaksi_type_s * type, void *flattened_type)
     goto fn_exit;
 }
 
+int yaksi_flatten(yaksi_type_s * type, bool raw_arrays, void *flattened_type,
+                  uintptr_t * flattened_type_size)
+{
+    int rc = YAKSA_SUCCESS;
+    sink_s sink;
+
+    sink.buf = (char *) flattened_type;
+    sink.len = YAKSI_FLATTEN_HEADER_SIZE;
+    sink.raw_arrays = raw_arrays;
+    sink.nodes.table = NULL;
+    sink.nodes.capacity = 0;
+    sink.nodes.count = 0;
+
+    rc = flatten(type, &sink);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    *flattened_type_size = sink.len;
+
+    if (sink.buf) {
+        unsigned char *p = (unsigned char *) sink.buf;
+
+        memcpy(p, YAKSI_FLATTEN_MAGIC, YAKSI_FLATTEN_MAGIC_LEN);
+        p += YAKSI_FLATTEN_MAGIC_LEN;
+        *p++ = YAKSI_FLATTEN_VERSION;
+        for (int i = 0; i < 8; i++)
+            *p++ = (unsigned char) ((uint64_t) sink.len >> (8 * i));
+    }
+
+  fn_exit:
+    free(sink.nodes.table);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
 int yaksa_flatten(yaksa_type_t type, void *flattened_type)
 {
     int rc = YAKSA_SUCCESS;
@@ -107,7 +338,8 @@ int yaksa_flatten(yaksa_type_t type, void *flattened_type)
     rc = yaksi_type_get(type, &yaksi_type);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
-    rc = flatten(yaksi_type, flattened_type);
+    uintptr_t flattened_type_size;
+    rc = yaksi_flatten(yaksi_type, false, flattened_type, &flattened_type_size);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
   fn_exit:
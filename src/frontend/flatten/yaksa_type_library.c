@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include "yaksi_flatten.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* A type library is a file of flattened types with raw arrays, which
+ * processes map read-only; the types they get from the library borrow
+ * their arrays from the mapping, so all processes share the pages:
+ *
+ *   header:  the four magic bytes, one version byte, three bytes of
+ *            padding and the number of types, as a little-endian
+ *            64-bit integer
+ *   index:   the offset of each flattened type from the start of the
+ *            file, as little-endian 64-bit integers
+ *   types:   the flattened types, each at an offset that is a
+ *            multiple of the alignment of raw arrays */
+
+#define LIBRARY_MAGIC        "YKTL"
+#define LIBRARY_MAGIC_LEN    (4)
+#define LIBRARY_VERSION      (1)
+#define LIBRARY_HEADER_SIZE  (LIBRARY_MAGIC_LEN + 4 + 8)
+
+typedef struct {
+    const char *addr;
+    uintptr_t len;
+    uint64_t count;
+} yaksi_type_library_s;
+
+static void put_uint64(char *buf, uint64_t val)
+{
+    for (int i = 0; i < 8; i++)
+        buf[i] = (char) (unsigned char) (val >> (8 * i));
+}
+
+static uint64_t get_uint64(const char *buf)
+{
+    const unsigned char *p = (const unsigned char *) buf;
+    uint64_t val = 0;
+
+    for (int i = 7; i >= 0; i--)
+        val = (val << 8) | p[i];
+
+    return val;
+}
+
+int yaksa_type_library_write(const char *path, int count, const yaksa_type_t * types)
+{
+    int rc = YAKSA_SUCCESS;
+    uint64_t *offsets = NULL;
+    char *buf = NULL;
+    FILE *file = NULL;
+
+    assert(yaksi_global.is_initialized);
+
+    offsets = (uint64_t *) malloc(count * sizeof(uint64_t));
+    YAKSU_ERR_CHKANDJUMP(count && !offsets, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    uintptr_t len = LIBRARY_HEADER_SIZE + count * sizeof(uint64_t);
+    for (int i = 0; i < count; i++) {
+        yaksi_type_s *yaksi_type;
+        rc = yaksi_type_get(types[i], &yaksi_type);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        len += (YAKSI_FLATTEN_RAW_ALIGNMENT - len % YAKSI_FLATTEN_RAW_ALIGNMENT) %
+            YAKSI_FLATTEN_RAW_ALIGNMENT;
+        offsets[i] = len;
+
+        uintptr_t flattened_size;
+        rc = yaksi_flatten(yaksi_type, true, NULL, &flattened_size);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+        len += flattened_size;
+    }
+
+    buf = (char *) calloc(1, len);
+    YAKSU_ERR_CHKANDJUMP(!buf, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    memcpy(buf, LIBRARY_MAGIC, LIBRARY_MAGIC_LEN);
+    buf[LIBRARY_MAGIC_LEN] = LIBRARY_VERSION;
+    put_uint64(buf + LIBRARY_MAGIC_LEN + 4, (uint64_t) count);
+
+    for (int i = 0; i < count; i++) {
+        yaksi_type_s *yaksi_type;
+        rc = yaksi_type_get(types[i], &yaksi_type);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        put_uint64(buf + LIBRARY_HEADER_SIZE + i * sizeof(uint64_t), offsets[i]);
+
+        uintptr_t flattened_size;
+        rc = yaksi_flatten(yaksi_type, true, buf + offsets[i], &flattened_size);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    file = fopen(path, "wb");
+    YAKSU_ERR_CHKANDJUMP(!file, rc, YAKSA_ERR__INTERNAL, fn_fail);
+    YAKSU_ERR_CHKANDJUMP(fwrite(buf, 1, len, file) != len, rc, YAKSA_ERR__INTERNAL, fn_fail);
+
+    int ret = fclose(file);
+    file = NULL;
+    YAKSU_ERR_CHKANDJUMP(ret, rc, YAKSA_ERR__INTERNAL, fn_fail);
+
+  fn_exit:
+    free(buf);
+    free(offsets);
+    return rc;
+  fn_fail:
+    if (file)
+        fclose(file);
+    goto fn_exit;
+}
+
+int yaksa_type_library_open(const char *path, yaksa_type_library_t * library, int *count)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_type_library_s *yaksi_library = NULL;
+    void *addr = MAP_FAILED;
+    struct stat st;
+
+    assert(yaksi_global.is_initialized);
+
+    int fd = open(path, O_RDONLY);
+    YAKSU_ERR_CHKANDJUMP(fd < 0, rc, YAKSA_ERR__INTERNAL, fn_fail);
+
+    int ret = fstat(fd, &st);
+    YAKSU_ERR_CHKANDJUMP(ret, rc, YAKSA_ERR__INTERNAL, fn_fail);
+    YAKSU_ERR_CHKANDJUMP(st.st_size < LIBRARY_HEADER_SIZE, rc, YAKSA_ERR__NOT_SUPPORTED,
+                         fn_fail);
+
+    addr = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    YAKSU_ERR_CHKANDJUMP(addr == MAP_FAILED, rc, YAKSA_ERR__INTERNAL, fn_fail);
+
+    const char *header = (const char *) addr;
+    YAKSU_ERR_CHKANDJUMP(memcmp(header, LIBRARY_MAGIC, LIBRARY_MAGIC_LEN), rc,
+                         YAKSA_ERR__NOT_SUPPORTED, fn_fail);
+    YAKSU_ERR_CHKANDJUMP(header[LIBRARY_MAGIC_LEN] != LIBRARY_VERSION, rc,
+                         YAKSA_ERR__NOT_SUPPORTED, fn_fail);
+
+    uint64_t num_types = get_uint64(header + LIBRARY_MAGIC_LEN + 4);
+    YAKSU_ERR_CHKANDJUMP(num_types > INT_MAX ||
+                         LIBRARY_HEADER_SIZE + num_types * sizeof(uint64_t) >
+                         (uint64_t) st.st_size, rc, YAKSA_ERR__NOT_SUPPORTED, fn_fail);
+
+    yaksi_library = (yaksi_type_library_s *) malloc(sizeof(yaksi_type_library_s));
+    YAKSU_ERR_CHKANDJUMP(!yaksi_library, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    yaksi_library->addr = header;
+    yaksi_library->len = (uintptr_t) st.st_size;
+    yaksi_library->count = num_types;
+
+    *library = (yaksa_type_library_t) yaksi_library;
+    *count = (int) num_types;
+
+  fn_exit:
+    /* the mapping stays valid without the file descriptor */
+    if (fd >= 0)
+        close(fd);
+    return rc;
+  fn_fail:
+    if (addr != MAP_FAILED)
+        munmap(addr, (size_t) st.st_size);
+    goto fn_exit;
+}
+
+int yaksa_type_library_get(yaksa_type_library_t library, int index, yaksa_type_t * type)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_type_library_s *yaksi_library = (yaksi_type_library_s *) library;
+    yaksi_type_s *yaksi_type;
+
+    assert(yaksi_global.is_initialized);
+    assert(index >= 0 && (uint64_t) index < yaksi_library->count);
+
+    uint64_t offset = get_uint64(yaksi_library->addr + LIBRARY_HEADER_SIZE +
+                                 index * sizeof(uint64_t));
+    YAKSU_ERR_CHKANDJUMP(offset + YAKSI_FLATTEN_HEADER_SIZE > yaksi_library->len, rc,
+                         YAKSA_ERR__NOT_SUPPORTED, fn_fail);
+
+    rc = yaksi_unflatten(yaksi_library->addr + offset, true, &yaksi_type);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    *type = yaksi_type->id;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksa_type_library_close(yaksa_type_library_t library)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_type_library_s *yaksi_library = (yaksi_type_library_s *) library;
+
+    int ret = munmap((void *) yaksi_library->addr, yaksi_library->len);
+    YAKSU_ERR_CHKANDJUMP(ret, rc, YAKSA_ERR__INTERNAL, fn_fail);
+
+    free(yaksi_library);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
@@ -5,125 +5,256 @@
 
 #include "yaksi.h"
 #include "yaksu.h"
+#include "yaksi_flatten.h"
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
 
-static inline int unflatten(yaksi_type_s ** type, const void *flattened_type)
+/* the non-builtin nodes built so far, in the order they were emitted,
+ * for back-references to resolve against */
+typedef struct {
+    yaksi_type_s **types;
+    uintptr_t count;
+    uintptr_t capacity;
+} node_list_s;
+
+typedef struct {
+    const char *base;
+    const char *cursor;
+    /* raw arrays are used in place rather than copied */
+    bool borrow_arrays;
+    bool has_raw_arrays;
+    node_list_s nodes;
+} source_s;
+
+static int node_list_append(node_list_s * nodes, yaksi_type_s * type)
+{
+    int rc = YAKSA_SUCCESS;
+
+    if (nodes->count == nodes->capacity) {
+        uintptr_t capacity = nodes->capacity ? 2 * nodes->capacity : 64;
+        yaksi_type_s **types =
+            (yaksi_type_s **) realloc(nodes->types, capacity * sizeof(yaksi_type_s *));
+        YAKSU_ERR_CHKANDJUMP(!types, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+        nodes->types = types;
+        nodes->capacity = capacity;
+    }
+
+    nodes->types[nodes->count++] = type;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/* decodes an array of count elements (see yaksi_flatten.h) into a new
+ * allocation, or points it into the flattened type if it is raw and
+ * the arrays are borrowed; a flattened type stores either all or none
+ * of its arrays raw */
+static int get_seq(source_s * src, yaksi_type_s * type, void **array, bool is_int,
+                   uintptr_t count)
+{
+    int rc = YAKSA_SUCCESS;
+    uintptr_t elem_size = is_int ? sizeof(int) : sizeof(intptr_t);
+    uint64_t prev = 0;
+    uintptr_t i = 0;
+
+    const char *cursor = src->cursor;
+    if (count && yaksi_flatten_read_uint(&cursor) == 0) {
+        src->cursor = cursor;
+        src->has_raw_arrays = true;
+
+        YAKSU_ERR_CHKANDJUMP(yaksi_flatten_read_uint(&src->cursor) != elem_size, rc,
+                             YAKSA_ERR__NOT_SUPPORTED, fn_fail);
+        uintptr_t offset = (uintptr_t) (src->cursor - src->base);
+        offset += (YAKSI_FLATTEN_RAW_ALIGNMENT - offset % YAKSI_FLATTEN_RAW_ALIGNMENT) %
+            YAKSI_FLATTEN_RAW_ALIGNMENT;
+        src->cursor = src->base + offset;
+
+        if (src->borrow_arrays) {
+            *array = (void *) src->cursor;
+            type->borrows_arrays = true;
+        } else {
+            *array = malloc(count * elem_size);
+            YAKSU_ERR_CHKANDJUMP(!*array, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+            memcpy(*array, src->cursor, count * elem_size);
+        }
+
+        src->cursor += count * elem_size;
+        goto fn_exit;
+    }
+
+    *array = malloc(count * elem_size);
+    YAKSU_ERR_CHKANDJUMP(count && !*array, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    int *ints = (int *) *array;
+    intptr_t *ptrs = (intptr_t *) *array;
+
+    while (i < count) {
+        uint64_t header = yaksi_flatten_read_uint(&src->cursor);
+        uintptr_t n = (uintptr_t) (header >> 1);
+        YAKSU_ERR_CHKANDJUMP(n == 0 || n > count - i, rc, YAKSA_ERR__INTERNAL, fn_fail);
+
+        if (header & 1) {
+            uint64_t val = prev + (uint64_t) yaksi_flatten_read_int(&src->cursor);
+            uint64_t stride = (uint64_t) yaksi_flatten_read_int(&src->cursor);
+            for (uintptr_t j = 0; j < n; j++, i++, val += stride) {
+                if (is_int)
+                    ints[i] = (int) val;
+                else
+                    ptrs[i] = (intptr_t) val;
+            }
+            prev = val - stride;
+        } else {
+            for (uintptr_t j = 0; j < n; j++, i++) {
+                prev += (uint64_t) yaksi_flatten_read_int(&src->cursor);
+                if (is_int)
+                    ints[i] = (int) prev;
+                else
+                    ptrs[i] = (intptr_t) prev;
+            }
+        }
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+static int unflatten(yaksi_type_s ** type, source_s * src)
 {
     int rc = YAKSA_SUCCESS;
     yaksi_type_s *newtype = NULL;
-    const char *flatbuf = (const char *) flattened_type;
 
-    if (((yaksi_type_s *) flattened_type)->kind == YAKSI_TYPE_KIND__BUILTIN) {
-        yaksa_type_t id = ((yaksi_type_s *) flattened_type)->id;
-        yaksi_type_s *tmp;
-        rc = yaksi_type_get(id, &tmp);
-        YAKSU_ERR_CHECK(rc, fn_fail);
-        yaksu_atomic_incr(&tmp->refcount);
-        newtype = tmp;
+    uint64_t tag = yaksi_flatten_read_uint(&src->cursor);
+
+    /* a type that was built before is shared */
+    if (tag == YAKSI_FLATTEN_BACKREF) {
+        uint64_t idx = yaksi_flatten_read_uint(&src->cursor);
+        YAKSU_ERR_CHKANDJUMP(idx >= src->nodes.count, rc, YAKSA_ERR__INTERNAL, fn_fail);
+        newtype = src->nodes.types[idx];
+        yaksu_atomic_incr(&newtype->refcount);
         goto fn_exit;
-    } else {
-        rc = yaksi_type_alloc(&newtype);
-        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
 
-        /* don't overwrite the local ID with the unflattened type ID,
-         * which potentially belongs to a different process or a
-         * different type. */
-        yaksa_type_t local_id;
-        local_id = newtype->id;
-        memcpy(newtype, flatbuf, sizeof(yaksi_type_s));
-        flatbuf += sizeof(yaksi_type_s);
-        newtype->id = local_id;
-        yaksu_atomic_store(&newtype->refcount, 1);
+    yaksi_type_kind_e kind = (yaksi_type_kind_e) (int) tag;
+
+    if (kind == YAKSI_TYPE_KIND__BUILTIN) {
+        yaksa_type_t id = (yaksa_type_t) (int) yaksi_flatten_read_uint(&src->cursor);
+        YAKSU_ERR_CHKANDJUMP(id >= YAKSI_TYPE__LAST, rc, YAKSA_ERR__INTERNAL, fn_fail);
+        rc = yaksi_type_get(id, &newtype);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+        yaksu_atomic_incr(&newtype->refcount);
+        goto fn_exit;
     }
 
-    switch (newtype->kind) {
+    rc = yaksi_type_alloc(&newtype);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = node_list_append(&src->nodes, newtype);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    newtype->kind = kind;
+    newtype->tree_depth = (int) yaksi_flatten_read_uint(&src->cursor);
+    newtype->alignment = (uint8_t) yaksi_flatten_read_uint(&src->cursor);
+    newtype->size = (uintptr_t) yaksi_flatten_read_uint(&src->cursor);
+    newtype->extent = (uintptr_t) yaksi_flatten_read_uint(&src->cursor);
+    newtype->lb = (intptr_t) yaksi_flatten_read_int(&src->cursor);
+    newtype->ub = (intptr_t) yaksi_flatten_read_int(&src->cursor);
+    newtype->true_lb = (intptr_t) yaksi_flatten_read_int(&src->cursor);
+    newtype->true_ub = (intptr_t) yaksi_flatten_read_int(&src->cursor);
+    newtype->is_contig = (yaksi_flatten_read_uint(&src->cursor) != 0);
+    newtype->num_contig = (uintptr_t) yaksi_flatten_read_uint(&src->cursor);
+
+    switch (kind) {
         case YAKSI_TYPE_KIND__CONTIG:
-            rc = unflatten(&newtype->u.contig.child, flatbuf);
+            newtype->u.contig.count = (int) yaksi_flatten_read_int(&src->cursor);
+            rc = unflatten(&newtype->u.contig.child, src);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__DUP:
-            rc = unflatten(&newtype->u.dup.child, flatbuf);
+            rc = unflatten(&newtype->u.dup.child, src);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__RESIZED:
-            rc = unflatten(&newtype->u.resized.child, flatbuf);
+            rc = unflatten(&newtype->u.resized.child, src);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__HVECTOR:
-            rc = unflatten(&newtype->u.hvector.child, flatbuf);
+            newtype->u.hvector.count = (int) yaksi_flatten_read_int(&src->cursor);
+            newtype->u.hvector.blocklength = (int) yaksi_flatten_read_int(&src->cursor);
+            newtype->u.hvector.stride = (intptr_t) yaksi_flatten_read_int(&src->cursor);
+            rc = unflatten(&newtype->u.hvector.child, src);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__BLKHINDX:
-            newtype->u.blkhindx.array_of_displs =
-                (intptr_t *) malloc(newtype->u.blkhindx.count * sizeof(intptr_t));
-            memcpy(newtype->u.blkhindx.array_of_displs, flatbuf,
-                   newtype->u.blkhindx.count * sizeof(intptr_t));
-            flatbuf += newtype->u.blkhindx.count * sizeof(intptr_t);
+            newtype->u.blkhindx.count = (int) yaksi_flatten_read_int(&src->cursor);
+            newtype->u.blkhindx.blocklength = (int) yaksi_flatten_read_int(&src->cursor);
 
-            rc = unflatten(&newtype->u.blkhindx.child, flatbuf);
+            rc = get_seq(src, newtype, (void **) &newtype->u.blkhindx.array_of_displs, false,
+                         newtype->u.blkhindx.count);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            rc = unflatten(&newtype->u.blkhindx.child, src);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__HINDEXED:
-            newtype->u.hindexed.array_of_blocklengths =
-                (int *) malloc(newtype->u.hindexed.count * sizeof(int));
-            memcpy(newtype->u.hindexed.array_of_blocklengths, flatbuf,
-                   newtype->u.hindexed.count * sizeof(int));
-            flatbuf += newtype->u.hindexed.count * sizeof(int);
-
-            newtype->u.hindexed.array_of_displs =
-                (intptr_t *) malloc(newtype->u.hindexed.count * sizeof(intptr_t));
-            memcpy(newtype->u.hindexed.array_of_displs, flatbuf,
-                   newtype->u.hindexed.count * sizeof(intptr_t));
-            flatbuf += newtype->u.hindexed.count * sizeof(intptr_t);
-
-            rc = unflatten(&newtype->u.hindexed.child, flatbuf);
+            newtype->u.hindexed.count = (int) yaksi_flatten_read_int(&src->cursor);
+
+            rc = get_seq(src, newtype, (void **) &newtype->u.hindexed.array_of_blocklengths, true,
+                         newtype->u.hindexed.count);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            rc = get_seq(src, newtype, (void **) &newtype->u.hindexed.array_of_displs, false,
+                         newtype->u.hindexed.count);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            rc = unflatten(&newtype->u.hindexed.child, src);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         case YAKSI_TYPE_KIND__STRUCT:
-            newtype->u.str.array_of_blocklengths =
-                (int *) malloc(newtype->u.str.count * sizeof(int));
-            memcpy(newtype->u.str.array_of_blocklengths, flatbuf,
-                   newtype->u.str.count * sizeof(int));
-            flatbuf += newtype->u.str.count * sizeof(int);
-
-            newtype->u.str.array_of_displs =
-                (intptr_t *) malloc(newtype->u.str.count * sizeof(intptr_t));
-            memcpy(newtype->u.str.array_of_displs, flatbuf,
-                   newtype->u.str.count * sizeof(intptr_t));
-            flatbuf += newtype->u.str.count * sizeof(intptr_t);
+            newtype->u.str.count = (int) yaksi_flatten_read_int(&src->cursor);
+
+            rc = get_seq(src, newtype, (void **) &newtype->u.str.array_of_blocklengths, true,
+                         newtype->u.str.count);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+
+            rc = get_seq(src, newtype, (void **) &newtype->u.str.array_of_displs, false,
+                         newtype->u.str.count);
+            YAKSU_ERR_CHECK(rc, fn_fail);
 
             newtype->u.str.array_of_types =
                 (yaksi_type_s **) malloc(newtype->u.str.count * sizeof(yaksi_type_s *));
+            YAKSU_ERR_CHKANDJUMP(!newtype->u.str.array_of_types, rc, YAKSA_ERR__OUT_OF_MEM,
+                                 fn_fail);
             for (int i = 0; i < newtype->u.str.count; i++) {
-                rc = unflatten(&newtype->u.str.array_of_types[i], flatbuf);
-                YAKSU_ERR_CHECK(rc, fn_fail);
-
-                uintptr_t tmp;
-                rc = yaksi_flatten_size(newtype->u.str.array_of_types[i], &tmp);
+                rc = unflatten(&newtype->u.str.array_of_types[i], src);
                 YAKSU_ERR_CHECK(rc, fn_fail);
-
-                flatbuf += tmp;
             }
             break;
 
         case YAKSI_TYPE_KIND__SUBARRAY:
-            rc = unflatten(&newtype->u.subarray.primary, flatbuf);
+            newtype->u.subarray.ndims = (int) yaksi_flatten_read_int(&src->cursor);
+            rc = unflatten(&newtype->u.subarray.primary, src);
             YAKSU_ERR_CHECK(rc, fn_fail);
             break;
 
         default:
-            assert(0);
+            YAKSU_ERR_CHKANDJUMP(1, rc, YAKSA_ERR__INTERNAL, fn_fail);
     }
 
-    yaksur_type_create_hook(newtype);
+    rc = yaksur_type_create_hook(newtype);
+    YAKSU_ERR_CHECK(rc, fn_fail);
 
   fn_exit:
     *type = newtype;
@@ -132,17 +263,343 @@ static inline int unflatten(yaksi_type_s ** type, const void *flattened_type)
     goto fn_exit;
 }
 
+/* The unflatten cache hands out the type that an identical flattened
+ * type was unflattened to before, instead of building the tree and
+ * running the backend hooks again; types are immutable, so they can
+ * be shared.  Each entry keeps a copy of the flattened type, so hash
+ * collisions are told apart, and a reference to the type.  When the
+ * copies take more bytes than the limit given to yaksa_init, the
+ * least recently used entries are dropped. */
+
+#define UNFLATTEN_CACHE_NUM_BUCKETS  (1024)
+
+typedef struct unflatten_cache_entry_s {
+    uint64_t hash;
+    uintptr_t size;
+    void *flattened_type;
+    yaksi_type_s *type;
+
+    struct unflatten_cache_entry_s *bucket_next;
+    /* the LRU list starts with the most recently used entry */
+    struct unflatten_cache_entry_s *lru_prev;
+    struct unflatten_cache_entry_s *lru_next;
+} unflatten_cache_entry_s;
+
+static struct {
+    uintptr_t max_bytes;
+    uintptr_t bytes;
+    unflatten_cache_entry_s **buckets;
+    unflatten_cache_entry_s *lru_head;
+    unflatten_cache_entry_s *lru_tail;
+    uint64_t hits;
+    uint64_t misses;
+    pthread_mutex_t mutex;
+} unflatten_cache = {.mutex = PTHREAD_MUTEX_INITIALIZER };
+
+/* FNV-1a */
+static uint64_t unflatten_cache_hash(const void *flattened_type, uintptr_t size)
+{
+    const unsigned char *p = (const unsigned char *) flattened_type;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (uintptr_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static void unflatten_cache_lru_unlink(unflatten_cache_entry_s * entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        unflatten_cache.lru_head = entry->lru_next;
+
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        unflatten_cache.lru_tail = entry->lru_prev;
+}
+
+static void unflatten_cache_lru_push(unflatten_cache_entry_s * entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = unflatten_cache.lru_head;
+    if (unflatten_cache.lru_head)
+        unflatten_cache.lru_head->lru_prev = entry;
+    else
+        unflatten_cache.lru_tail = entry;
+    unflatten_cache.lru_head = entry;
+}
+
+/* called with the cache mutex held */
+static int unflatten_cache_evict(unflatten_cache_entry_s * entry)
+{
+    int rc = YAKSA_SUCCESS;
+    unflatten_cache_entry_s **link =
+        &unflatten_cache.buckets[entry->hash % UNFLATTEN_CACHE_NUM_BUCKETS];
+
+    while (*link != entry)
+        link = &(*link)->bucket_next;
+    *link = entry->bucket_next;
+
+    unflatten_cache_lru_unlink(entry);
+    unflatten_cache.bytes -= entry->size;
+
+    /* the type lives on if the application still holds it */
+    rc = yaksi_type_free(entry->type);
+    free(entry->flattened_type);
+    free(entry);
+
+    return rc;
+}
+
+/* returns a new reference to the cached type, or NULL */
+static yaksi_type_s *unflatten_cache_lookup(uint64_t hash, const void *flattened_type,
+                                            uintptr_t size)
+{
+    yaksi_type_s *type = NULL;
+
+    pthread_mutex_lock(&unflatten_cache.mutex);
+
+    unflatten_cache_entry_s *entry = unflatten_cache.buckets[hash % UNFLATTEN_CACHE_NUM_BUCKETS];
+    for (; entry; entry = entry->bucket_next) {
+        if (entry->hash == hash && entry->size == size &&
+            !memcmp(entry->flattened_type, flattened_type, size))
+            break;
+    }
+
+    if (entry) {
+        unflatten_cache_lru_unlink(entry);
+        unflatten_cache_lru_push(entry);
+
+        type = entry->type;
+        yaksu_atomic_incr(&type->refcount);
+        unflatten_cache.hits++;
+    } else {
+        unflatten_cache.misses++;
+    }
+
+    pthread_mutex_unlock(&unflatten_cache.mutex);
+
+    return type;
+}
+
+/* the cache is best effort: if the entry cannot be allocated, the type
+ * is simply not cached */
+static int unflatten_cache_insert(uint64_t hash, const void *flattened_type, uintptr_t size,
+                                  yaksi_type_s * type)
+{
+    int rc = YAKSA_SUCCESS;
+    unflatten_cache_entry_s *entry;
+
+    if (size > unflatten_cache.max_bytes)
+        return rc;
+
+    pthread_mutex_lock(&unflatten_cache.mutex);
+
+    /* another thread might have cached the same type in the meantime */
+    entry = unflatten_cache.buckets[hash % UNFLATTEN_CACHE_NUM_BUCKETS];
+    for (; entry; entry = entry->bucket_next) {
+        if (entry->hash == hash && entry->size == size &&
+            !memcmp(entry->flattened_type, flattened_type, size))
+            goto fn_exit;
+    }
+
+    entry = (unflatten_cache_entry_s *) malloc(sizeof(unflatten_cache_entry_s));
+    if (entry == NULL)
+        goto fn_exit;
+
+    entry->flattened_type = malloc(size);
+    if (entry->flattened_type == NULL) {
+        free(entry);
+        goto fn_exit;
+    }
+
+    while (unflatten_cache.bytes + size > unflatten_cache.max_bytes) {
+        rc = unflatten_cache_evict(unflatten_cache.lru_tail);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    memcpy(entry->flattened_type, flattened_type, size);
+    entry->hash = hash;
+    entry->size = size;
+    entry->type = type;
+    yaksu_atomic_incr(&type->refcount);
+
+    entry->bucket_next = unflatten_cache.buckets[hash % UNFLATTEN_CACHE_NUM_BUCKETS];
+    unflatten_cache.buckets[hash % UNFLATTEN_CACHE_NUM_BUCKETS] = entry;
+    unflatten_cache_lru_push(entry);
+    unflatten_cache.bytes += size;
+
+  fn_exit:
+    pthread_mutex_unlock(&unflatten_cache.mutex);
+    return rc;
+  fn_fail:
+    free(entry->flattened_type);
+    free(entry);
+    goto fn_exit;
+}
+
+int yaksi_unflatten_cache_init(uintptr_t max_bytes)
+{
+    int rc = YAKSA_SUCCESS;
+
+    unflatten_cache.hits = 0;
+    unflatten_cache.misses = 0;
+
+    if (max_bytes == 0)
+        goto fn_exit;
+
+    unflatten_cache.buckets = (unflatten_cache_entry_s **)
+        calloc(UNFLATTEN_CACHE_NUM_BUCKETS, sizeof(unflatten_cache_entry_s *));
+    YAKSU_ERR_CHKANDJUMP(!unflatten_cache.buckets, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    unflatten_cache.max_bytes = max_bytes;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksi_unflatten_cache_finalize(void)
+{
+    int rc = YAKSA_SUCCESS;
+
+    pthread_mutex_lock(&unflatten_cache.mutex);
+
+    while (unflatten_cache.lru_tail) {
+        rc = unflatten_cache_evict(unflatten_cache.lru_tail);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    free(unflatten_cache.buckets);
+    unflatten_cache.buckets = NULL;
+    unflatten_cache.max_bytes = 0;
+
+  fn_exit:
+    pthread_mutex_unlock(&unflatten_cache.mutex);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+void yaksi_unflatten_cache_stats_get(yaksa_stats_t * stats)
+{
+    pthread_mutex_lock(&unflatten_cache.mutex);
+    stats->unflatten_cache_hits = unflatten_cache.hits;
+    stats->unflatten_cache_misses = unflatten_cache.misses;
+    pthread_mutex_unlock(&unflatten_cache.mutex);
+}
+
+/* types flattened by other versions of the format are rejected */
+static int check_header(const void *flattened_type)
+{
+    int rc = YAKSA_SUCCESS;
+    const char *header = (const char *) flattened_type;
+
+    YAKSU_ERR_CHKANDJUMP(memcmp(header, YAKSI_FLATTEN_MAGIC, YAKSI_FLATTEN_MAGIC_LEN), rc,
+                         YAKSA_ERR__NOT_SUPPORTED, fn_fail);
+    YAKSU_ERR_CHKANDJUMP(header[YAKSI_FLATTEN_MAGIC_LEN] != YAKSI_FLATTEN_VERSION, rc,
+                         YAKSA_ERR__NOT_SUPPORTED, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksi_unflatten(const void *flattened_type, bool borrow_arrays, yaksi_type_s ** type)
+{
+    int rc = YAKSA_SUCCESS;
+    source_s src;
+
+    src.base = (const char *) flattened_type;
+    src.cursor = src.base + YAKSI_FLATTEN_HEADER_SIZE;
+    /* misaligned raw arrays are copied */
+    src.borrow_arrays = borrow_arrays &&
+        ((uintptr_t) flattened_type % YAKSI_FLATTEN_RAW_ALIGNMENT) == 0;
+    src.has_raw_arrays = false;
+    src.nodes.types = NULL;
+    src.nodes.count = 0;
+    src.nodes.capacity = 0;
+
+    rc = check_header(flattened_type);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = unflatten(type, &src);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    assert(*type);
+
+    uint64_t flattened_size = yaksi_flatten_read_size(flattened_type);
+    assert(flattened_size == (uint64_t) (src.cursor - src.base));
+
+    /* unless its arrays were raw, the new type flattens to exactly the
+     * bytes it was built from */
+    if ((*type)->kind != YAKSI_TYPE_KIND__BUILTIN && !src.has_raw_arrays)
+        yaksu_atomic_uint64_store(&(*type)->flattened_size, flattened_size);
+
+  fn_exit:
+    free(src.nodes.types);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
 int yaksa_unflatten(yaksa_type_t * type, const void *flattened_type)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_type_s *yaksi_type;
+    uint64_t hash = 0;
+    uintptr_t flattened_size = 0;
+
+    assert(yaksi_global.is_initialized);
+
+    if (unflatten_cache.max_bytes) {
+        rc = check_header(flattened_type);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        flattened_size = (uintptr_t) yaksi_flatten_read_size(flattened_type);
+        hash = unflatten_cache_hash(flattened_type, flattened_size);
+        yaksi_type = unflatten_cache_lookup(hash, flattened_type, flattened_size);
+        if (yaksi_type) {
+            *type = yaksi_type->id;
+            goto fn_exit;
+        }
+    }
+
+    rc = yaksi_unflatten(flattened_type, false, &yaksi_type);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    *type = yaksi_type->id;
+
+    /* builtin types are not worth caching */
+    if (unflatten_cache.max_bytes && yaksi_type->kind != YAKSI_TYPE_KIND__BUILTIN) {
+        rc = unflatten_cache_insert(hash, flattened_type, flattened_size, yaksi_type);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/* the type holds on to the buffer, so it is not cached */
+int yaksa_unflatten_borrowed(yaksa_type_t * type, const void *flattened_type)
 {
     int rc = YAKSA_SUCCESS;
     yaksi_type_s *yaksi_type;
 
     assert(yaksi_global.is_initialized);
 
-    rc = unflatten(&yaksi_type, flattened_type);
+    rc = yaksi_unflatten(flattened_type, true, &yaksi_type);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
-    assert(yaksi_type);
     *type = yaksi_type->id;
 
   fn_exit:
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#ifndef YAKSI_FLATTEN_H_INCLUDED
+#define YAKSI_FLATTEN_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Flattened types are shipped to other processes, so the format holds
+ * no pointers and no backend state, and it is versioned:
+ *
+ *   header:  the four magic bytes, one version byte and the size of
+ *            the flattened type, header included, as a little-endian
+ *            64-bit integer
+ *   node:    kind, then for builtin types only the type ID; for all
+ *            other types tree_depth, alignment, size, extent, lb, ub,
+ *            true_lb, true_ub, is_contig and num_contig, then the
+ *            parameters of the kind and the child nodes, depth first
+ *
+ * A type that is reachable along several paths, such as a struct
+ * that uses the same member type more than once, is emitted only the
+ * first time it is reached.  Later occurrences are back-references:
+ * the BACKREF tag and the index of the node, counting the non-builtin
+ * nodes in the order they were emitted.  The flattened type thus grows
+ * with the number of distinct types, not with the size of the
+ * expanded tree.
+ *
+ * All integers are LEB128 varints; signed ones are zigzag-encoded
+ * first.  Arrays of blocklengths and displacements are encoded as a
+ * sequence of segments, each starting with (n << 1 | is_run):
+ *
+ *   run:      n elements in arithmetic progression, encoded as the
+ *             delta of the first element to the previous element and
+ *             the stride
+ *   literal:  n elements, each encoded as the delta to the previous
+ *             element
+ *
+ * The "previous element" of the first segment is zero.  Sorted
+ * displacements thus cost a byte or two each, and regular runs of
+ * any length cost a few bytes in all.
+ *
+ * Flattened types that are meant to be unflattened in place, without
+ * copying the arrays, store all their arrays raw instead: a segment
+ * header of zero, the size of one element, padding up to the next
+ * multiple of RAW_ALIGNMENT bytes from the start of the flattened
+ * type, and the elements as they are laid out in memory.  Raw arrays
+ * can only be read on machines with the same layout.  The size that
+ * yaksa_flatten_size reports and caches is always that of the compact
+ * form. */
+
+#define YAKSI_FLATTEN_MAGIC        "YKFL"
+#define YAKSI_FLATTEN_MAGIC_LEN    (4)
+#define YAKSI_FLATTEN_VERSION      (2)
+#define YAKSI_FLATTEN_HEADER_SIZE  (YAKSI_FLATTEN_MAGIC_LEN + 1 + 8)
+
+/* tag of a back-reference, in place of the kind of a node */
+#define YAKSI_FLATTEN_BACKREF      (127)
+
+/* raw arrays start at this alignment, relative to the start of the
+ * flattened type */
+#define YAKSI_FLATTEN_RAW_ALIGNMENT  (8)
+
+/* shorter progressions are cheaper as literals */
+#define YAKSI_FLATTEN_MIN_RUN      (4)
+
+static inline uint64_t yaksi_flatten_zigzag(int64_t val)
+{
+    return ((uint64_t) val << 1) ^ (uint64_t) (val >> 63);
+}
+
+static inline int64_t yaksi_flatten_unzigzag(uint64_t val)
+{
+    return (int64_t) (val >> 1) ^ -(int64_t) (val & 1);
+}
+
+static inline uint64_t yaksi_flatten_read_uint(const char **cursor)
+{
+    const unsigned char *p = (const unsigned char *) *cursor;
+    uint64_t val = 0;
+    int shift = 0;
+
+    while (*p & 0x80) {
+        val |= (uint64_t) (*p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    val |= (uint64_t) (*p++) << shift;
+
+    *cursor = (const char *) p;
+    return val;
+}
+
+static inline int64_t yaksi_flatten_read_int(const char **cursor)
+{
+    return yaksi_flatten_unzigzag(yaksi_flatten_read_uint(cursor));
+}
+
+/* the size in the header of a flattened type */
+static inline uint64_t yaksi_flatten_read_size(const void *flattened_type)
+{
+    const unsigned char *p = (const unsigned char *) flattened_type + YAKSI_FLATTEN_MAGIC_LEN + 1;
+    uint64_t size = 0;
+
+    for (int i = 7; i >= 0; i--)
+        size = (size << 8) | p[i];
+
+    return size;
+}
+
+#endif /* YAKSI_FLATTEN_H_INCLUDED */
@@ -8,6 +8,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <pthread.h>
 #include <sys/uio.h>
 #include "yaksa_config.h"
 #include "yaksa.h"
@@ -38,11 +39,18 @@ typedef enum {
 
 struct yaksi_type_s;
 struct yaksi_request_s;
+struct yaksi_stream_s;
+struct yaksi_request_dep_s;
+
+/* request handles carry the stream they were allocated from in their
+ * upper bits, so they can be looked up without a global pool */
+#define YAKSI_REQUEST_STREAM_SHIFT  (20)
+#define YAKSI_REQUEST_IDX_MASK      ((1U << YAKSI_REQUEST_STREAM_SHIFT) - 1)
 
 /* global variables */
 typedef struct {
     yaksu_pool_s type_pool;
-    yaksu_pool_s request_pool;
+    yaksu_pool_s stream_pool;
     int is_initialized;
 } yaksi_global_s;
 extern yaksi_global_s yaksi_global;
@@ -68,6 +76,13 @@ typedef struct yaksi_type_s {
     bool is_contig;
     uintptr_t num_contig;
 
+    /* bytes of the flattened type; zero until it is first needed */
+    yaksu_atomic_uint64 flattened_size;
+
+    /* the arrays of displacements and blocklengths are borrowed from
+     * a buffer that outlives the type, and are not freed with it */
+    bool borrows_arrays;
+
     union {
         struct {
             int count;
@@ -118,14 +133,115 @@ typedef struct yaksi_request_s {
     yaksa_request_t id;
     yaksu_atomic_int cc;        /* completion counter */
 
+    /* stream from whose pool the request was allocated */
+    struct yaksi_stream_s *stream;
+
+    /* references held by the user and by dependent requests */
+    yaksu_atomic_int refcount;
+
+    /* operations waiting for this request to complete, and the
+     * request that this request is waiting for; both are protected by
+     * the dependency mutex of the respective request's stream */
+    struct yaksi_request_dep_s *deps;
+    struct yaksi_request_s *parent;
+
+    /* detached requests are not visible to the user, who is notified
+     * through the counter or the callback instead; they are kept in
+     * the detached list of their stream till they are reclaimed.  The
+     * callback is protected by the dependency mutex. */
+    yaksu_atomic_int *counter;
+    void (*callback) (void *);
+    void *callback_arg;
+    struct yaksi_request_s *next_detached;
+
+    /* waiters can sleep on the completion counter instead of polling
+     * it; the number of sleeping waiters is protected by the
+     * dependency mutex */
+    bool blocking_wait;
+    int nwaiters;
+
     /* give some private space for the backend to store content */
     yaksur_request_s backend;
 } yaksi_request_s;
 
+typedef struct yaksi_stream_s {
+    /* yaksa stream associated with this structure */
+    yaksa_stream_t id;
+
+    /* each stream has its own request pool */
+    yaksu_pool_s request_pool;
+    pthread_mutex_t dep_mutex;
+
+    /* detached requests, protected by the dependency mutex */
+    struct yaksi_request_s *detached;
+
+    /* give some private space for the backend to store content */
+    yaksur_stream_s backend;
+} yaksi_stream_s;
+
 typedef struct yaksi_info_s {
+    yaksa_stream_t stream;
+    yaksa_request_t dependency;
+    /* the user guarantees that all buffers are in host memory */
+    bool host_buffers;
+    /* waits on the requests of this operation sleep instead of
+     * polling */
+    bool blocking_wait;
+    /* staging pipeline; zero selects the init attributes */
+    uintptr_t staging_chunk_size;
+    int staging_depth;
+
     yaksur_info_s backend;
 } yaksi_info_s;
 
+typedef struct yaksi_plan_s {
+    yaksa_pack_plan_op_e op;
+    const void *inbuf;
+    void *outbuf;
+    uintptr_t count;
+    struct yaksi_type_s *type;
+    struct yaksi_info_s *info;
+    struct yaksi_stream_s *stream;
+
+    /* set by the backend when executing the plan never needs a
+     * request */
+    bool is_sync;
+
+    yaksur_plan_s backend;
+} yaksi_plan_s;
+
+/* an operation that is deferred until its parent request completes */
+typedef struct yaksi_request_dep_s {
+    enum {
+        YAKSI_REQUEST_DEP__PACK,
+        YAKSI_REQUEST_DEP__UNPACK,
+    } kind;
+
+    /* for packing, inlen is the input count and outlen is the maximum
+     * number of bytes to pack; for unpacking, inlen is the number of
+     * bytes to unpack and outlen is the output count */
+    const void *inbuf;
+    uintptr_t inlen;
+    void *outbuf;
+    uintptr_t outlen;
+    struct yaksi_type_s *type;
+    uintptr_t offset;
+    uintptr_t *actual_bytes;
+    struct yaksi_info_s *info;
+
+    struct yaksi_request_s *request;
+    struct yaksi_request_dep_s *next;
+} yaksi_request_dep_s;
+
+/* a descriptor of a batched operation, with the type resolved and
+ * the offset of its data in the contiguous buffer made explicit */
+typedef struct {
+    void *buf;
+    uintptr_t count;
+    struct yaksi_type_s *type;
+    uintptr_t offset;
+} yaksi_batch_desc_s;
+
 
 /* pair types */
 typedef struct {
@@ -217,11 +333,23 @@ int yaksi_iunpack_element(const void *inbuf, uintptr_t insize, void *outbuf, yak
                           uintptr_t outoffset, uintptr_t * actual_unpack_bytes,
                           yaksi_info_s * info, yaksi_request_s * request);
 
+int yaksi_batch_desc_resolve(const yaksa_batch_desc_t * descs, uintptr_t ndescs,
+                             yaksi_batch_desc_s * yaksi_descs, uintptr_t * nresolved,
+                             uintptr_t * total_bytes);
+
 int yaksi_iov_len(uintptr_t count, yaksi_type_s * type, uintptr_t * iov_len);
 int yaksi_iov(const char *buf, uintptr_t count, yaksi_type_s * type, uintptr_t iov_offset,
               struct iovec *iov, uintptr_t max_iov_len, uintptr_t * actual_iov_len);
 
+int yaksi_flatten(yaksi_type_s * type, bool raw_arrays, void *flattened_type,
+                  uintptr_t * flattened_type_size);
 int yaksi_flatten_size(yaksi_type_s * type, uintptr_t * flattened_type_size);
+int yaksi_unflatten(const void *flattened_type, bool borrow_arrays, yaksi_type_s ** type);
+
+/* unflatten cache */
+int yaksi_unflatten_cache_init(uintptr_t max_bytes);
+int yaksi_unflatten_cache_finalize(void);
+void yaksi_unflatten_cache_stats_get(yaksa_stats_t * stats);
 
 /* type pool */
 int yaksi_type_alloc(yaksi_type_s ** type);
@@ -229,8 +357,24 @@ int yaksi_type_dealloc(yaksi_type_s * type);
 int yaksi_type_get(yaksa_type_t type, yaksi_type_s ** yaksi_type);
 
 /* request pool */
-int yaksi_request_create(yaksi_request_s ** request);
+int yaksi_request_create(yaksi_stream_s * stream, yaksi_request_s ** request);
 int yaksi_request_free(yaksi_request_s * request);
 int yaksi_request_get(yaksa_request_t request, yaksi_request_s ** yaksi_request);
 
+/* request dependencies */
+int yaksi_request_add_dependency(yaksi_request_s * parent, const yaksi_request_dep_s * dep,
+                                 bool * is_deferred);
+int yaksi_request_complete(yaksi_request_s * request);
+int yaksi_request_progress(yaksi_request_s * request, bool * is_deferred);
+int yaksi_request_progress_all(int count, yaksi_request_s ** requests);
+int yaksi_request_detach(yaksi_request_s * request, yaksu_atomic_int * counter);
+int yaksi_request_block(yaksi_request_s * request);
+int yaksi_request_set_callback(yaksi_request_s * request, void (*fn) (void *), void *arg);
+
+/* stream pool */
+int yaksi_stream_create(yaksi_stream_s ** stream);
+int yaksi_stream_free(yaksi_stream_s * stream);
+int yaksi_stream_get(yaksa_stream_t stream, yaksi_stream_s ** yaksi_stream);
+int yaksi_stream_progress(yaksi_stream_s * stream);
+
 #endif /* YAKSI_H_INCLUDED */
@@ -17,10 +17,20 @@ int yaksa_info_create(yaksa_info_t * info)
     assert(yaksi_global.is_initialized);
 
     yaksi_info = (yaksi_info_s *) malloc(sizeof(yaksi_info_s));
+    YAKSU_ERR_CHKANDJUMP(!yaksi_info, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    yaksi_info->stream = YAKSA_STREAM__DEFAULT;
+    yaksi_info->dependency = YAKSA_REQUEST__NULL;
+    yaksi_info->host_buffers = false;
+    yaksi_info->blocking_wait = false;
+    yaksi_info->staging_chunk_size = 0;
+    yaksi_info->staging_depth = 0;
 
     rc = yaksur_info_create_hook(yaksi_info);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
+    *info = (yaksa_info_t) yaksi_info;
+
   fn_exit:
     return rc;
   fn_fail:
@@ -53,6 +63,26 @@ int yaksa_info_keyval_append(yaksa_info_t info, const char *key, const void *val
 
     assert(yaksi_global.is_initialized);
 
+    if (!strncmp(key, "yaksa_stream", YAKSA_INFO_MAX_KEYLEN)) {
+        assert(vallen == sizeof(uintptr_t));
+        yaksi_info->stream = (yaksa_stream_t) (uintptr_t) val;
+    } else if (!strncmp(key, "yaksa_dependency", YAKSA_INFO_MAX_KEYLEN)) {
+        assert(vallen == sizeof(uintptr_t));
+        yaksi_info->dependency = (yaksa_request_t) (uintptr_t) val;
+    } else if (!strncmp(key, "yaksa_host_buffers", YAKSA_INFO_MAX_KEYLEN)) {
+        assert(vallen == sizeof(uintptr_t));
+        yaksi_info->host_buffers = ((uintptr_t) val != 0);
+    } else if (!strncmp(key, "yaksa_blocking_wait", YAKSA_INFO_MAX_KEYLEN)) {
+        assert(vallen == sizeof(uintptr_t));
+        yaksi_info->blocking_wait = ((uintptr_t) val != 0);
+    } else if (!strncmp(key, "yaksa_staging_chunk_size", YAKSA_INFO_MAX_KEYLEN)) {
+        assert(vallen == sizeof(uintptr_t));
+        yaksi_info->staging_chunk_size = (uintptr_t) val;
+    } else if (!strncmp(key, "yaksa_staging_depth", YAKSA_INFO_MAX_KEYLEN)) {
+        assert(vallen == sizeof(uintptr_t));
+        yaksi_info->staging_depth = (int) (uintptr_t) val;
+    }
+
     rc = yaksur_info_keyval_append(yaksi_info, key, val, vallen);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
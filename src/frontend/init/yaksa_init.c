@@ -87,9 +87,10 @@
     } while (0)
 
 yaksi_global_s yaksi_global = { 0 };
-yaksa_init_attr_t YAKSA_INIT_ATTR__DEFAULT = { 0 };
+yaksa_init_attr_t YAKSA_INIT_ATTR__DEFAULT = {.progress_thread_cpu = -1 };
 
 #define CHUNK_SIZE (1024)
+#define STREAM_CHUNK_SIZE (64)
 
 int yaksa_init(yaksa_init_attr_t attr)
 {
@@ -112,29 +113,46 @@ int yaksa_init(yaksa_init_attr_t attr)
         assert(type->id == i);
     }
 
-    /* initialize the request pool */
-    rc = yaksu_pool_alloc(sizeof(yaksi_request_s), CHUNK_SIZE, UINT_MAX, malloc, free,
-                          &yaksi_global.request_pool);
+    /* initialize the backend */
+    rc = yaksur_init_hook(attr);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+
+    /* initialize the stream pool; the stream index has to fit in the
+     * upper bits of the request handle */
+    rc = yaksu_pool_alloc(sizeof(yaksi_stream_s), STREAM_CHUNK_SIZE,
+                          (INT_MAX >> YAKSI_REQUEST_STREAM_SHIFT) + 1, malloc, free,
+                          &yaksi_global.stream_pool);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
     /* these are the first set of allocations for our builtin
-     * requests, so the indices should match that of the request
+     * streams, so the indices should match that of the streams
      * themselves */
+    for (yaksa_stream_t i = YAKSA_STREAM__DEFAULT; i < YAKSI_STREAM__LAST; i++) {
+        struct yaksi_stream_s *stream;
+
+        rc = yaksi_stream_create(&stream);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        assert(stream->id == i);
+    }
+
+    /* builtin requests are allocated from the default stream, so
+     * their handles match the requests themselves */
+    yaksi_stream_s *default_stream;
+    rc = yaksi_stream_get(YAKSA_STREAM__DEFAULT, &default_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
     for (yaksa_request_t i = YAKSA_REQUEST__NULL; i < YAKSI_REQUEST__LAST; i++) {
         struct yaksi_request_s *request;
 
-        rc = yaksi_request_create(&request);
+        rc = yaksi_request_create(default_stream, &request);
         YAKSU_ERR_CHECK(rc, fn_fail);
 
         assert(request->id == i);
     }
 
 
-    /* initialize the backend */
-    rc = yaksur_init_hook();
-    YAKSU_ERR_CHECK(rc, fn_fail);
-
-
     /* setup builtin datatypes */
     INIT_BUILTIN(char, CHAR, rc, fn_fail);
     INIT_BUILTIN(unsigned char, UNSIGNED_CHAR, rc, fn_fail);
@@ -199,6 +217,10 @@ int yaksa_init(yaksa_init_attr_t attr)
     yaksur_type_create_hook(null_type);
 
 
+    rc = yaksi_unflatten_cache_init(attr.unflatten_cache_size);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+
     /* done */
     yaksi_global.is_initialized = 1;
 
@@ -212,38 +234,57 @@ int yaksa_finalize(void)
 {
     int rc = YAKSA_SUCCESS;
 
-    /* finalize the backend */
-    rc = yaksur_finalize_hook();
+    /* drop the cached types; their backend state has to go before the
+     * backend is finalized */
+    rc = yaksi_unflatten_cache_finalize();
     YAKSU_ERR_CHECK(rc, fn_fail);
 
 
-    /* free the builtin datatypes */
-    for (yaksa_type_t i = YAKSA_TYPE__NULL; i < YAKSI_TYPE__LAST; i++) {
-        yaksi_type_s *type;
+    /* free the builtin requests */
+    for (yaksa_request_t i = YAKSA_REQUEST__NULL; i < YAKSI_REQUEST__LAST; i++) {
+        yaksi_request_s *request;
 
-        rc = yaksi_type_get(i, &type);
+        rc = yaksi_request_get(i, &request);
         YAKSU_ERR_CHECK(rc, fn_fail);
 
-        rc = yaksi_type_free(type);
+        rc = yaksi_request_free(request);
         YAKSU_ERR_CHECK(rc, fn_fail);
     }
 
-    rc = yaksu_pool_free(yaksi_global.type_pool);
+
+    /* free the builtin streams; this needs to happen before the
+     * backend is finalized, as the streams hold backend resources */
+    for (yaksa_stream_t i = YAKSA_STREAM__DEFAULT; i < YAKSI_STREAM__LAST; i++) {
+        yaksi_stream_s *stream;
+
+        rc = yaksi_stream_get(i, &stream);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        rc = yaksi_stream_free(stream);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    rc = yaksu_pool_free(yaksi_global.stream_pool);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
 
-    /* free the builtin requests */
-    for (yaksa_request_t i = YAKSA_REQUEST__NULL; i < YAKSI_REQUEST__LAST; i++) {
-        yaksi_request_s *request;
+    /* finalize the backend */
+    rc = yaksur_finalize_hook();
+    YAKSU_ERR_CHECK(rc, fn_fail);
 
-        rc = yaksi_request_get(i, &request);
+
+    /* free the builtin datatypes */
+    for (yaksa_type_t i = YAKSA_TYPE__NULL; i < YAKSI_TYPE__LAST; i++) {
+        yaksi_type_s *type;
+
+        rc = yaksi_type_get(i, &type);
         YAKSU_ERR_CHECK(rc, fn_fail);
 
-        rc = yaksi_request_free(request);
+        rc = yaksi_type_free(type);
         YAKSU_ERR_CHECK(rc, fn_fail);
     }
 
-    rc = yaksu_pool_free(yaksi_global.request_pool);
+    rc = yaksu_pool_free(yaksi_global.type_pool);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
   fn_exit:
@@ -7,4 +7,5 @@ AM_CPPFLAGS += -I$(top_srcdir)/src/frontend/iov
 
 libyaksa_la_SOURCES += \
 	src/frontend/iov/yaksa_iov_len.c \
-	src/frontend/iov/yaksa_iov.c
+	src/frontend/iov/yaksa_iov.c \
+	src/frontend/iov/yaksa_pack_iov.c
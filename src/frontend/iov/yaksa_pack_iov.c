@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <assert.h>
+
+int yaksa_pack_iov(const void *inbuf, uintptr_t count, yaksa_type_t type, uintptr_t iov_offset,
+                   void *tmpbuf, uintptr_t max_tmpbuf_bytes, struct iovec *iov,
+                   uintptr_t max_iov_len, uintptr_t * actual_iov_len,
+                   uintptr_t * actual_tmpbuf_bytes, uintptr_t * actual_segments,
+                   yaksa_info_t info)
+{
+    int rc = YAKSA_SUCCESS;
+
+    assert(yaksi_global.is_initialized);
+
+    *actual_iov_len = 0;
+    *actual_tmpbuf_bytes = 0;
+    *actual_segments = 0;
+
+    if (count == 0)
+        goto fn_exit;
+
+    yaksi_type_s *yaksi_type;
+    rc = yaksi_type_get(type, &yaksi_type);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    if (yaksi_type->size == 0)
+        goto fn_exit;
+
+    rc = yaksur_pack_iov(inbuf, count, yaksi_type, iov_offset, tmpbuf, max_tmpbuf_bytes, iov,
+                         max_iov_len, actual_iov_len, actual_tmpbuf_bytes, actual_segments,
+                         (yaksi_info_s *) info);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
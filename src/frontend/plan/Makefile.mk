@@ -0,0 +1,9 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+AM_CPPFLAGS += -I$(top_srcdir)/src/frontend/plan
+
+libyaksa_la_SOURCES += \
+	src/frontend/plan/yaksa_pack_plan.c
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <stdlib.h>
+#include <assert.h>
+
+int yaksa_pack_plan_create(yaksa_pack_plan_op_e op, const void *inbuf, void *outbuf,
+                           uintptr_t count, yaksa_type_t type, yaksa_info_t info,
+                           yaksa_pack_plan_t * plan)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_plan_s *yaksi_plan = NULL;
+
+    assert(yaksi_global.is_initialized);
+
+    yaksi_type_s *yaksi_type;
+    rc = yaksi_type_get(type, &yaksi_type);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    yaksi_plan = (yaksi_plan_s *) malloc(sizeof(yaksi_plan_s));
+    YAKSU_ERR_CHKANDJUMP(!yaksi_plan, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    yaksi_plan->op = op;
+    yaksi_plan->inbuf = inbuf;
+    yaksi_plan->outbuf = outbuf;
+    yaksi_plan->count = count;
+    yaksi_plan->type = yaksi_type;
+    yaksi_plan->info = (yaksi_info_s *) info;
+    yaksi_plan->is_sync = true;
+    yaksi_plan->backend.priv = NULL;
+
+    rc = yaksi_stream_get(info ? yaksi_plan->info->stream : YAKSA_STREAM__DEFAULT,
+                          &yaksi_plan->stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    /* empty plans never reach the backend */
+    if (count && yaksi_type->size) {
+        rc = yaksur_plan_create(yaksi_plan);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    yaksu_atomic_incr(&yaksi_type->refcount);
+    *plan = (yaksa_pack_plan_t) yaksi_plan;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    free(yaksi_plan);
+    goto fn_exit;
+}
+
+int yaksa_pack_plan_execute(yaksa_pack_plan_t plan, yaksa_request_t * request)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_plan_s *yaksi_plan = (yaksi_plan_s *) plan;
+
+    *request = YAKSA_REQUEST__NULL;
+
+    if (yaksi_plan->backend.priv == NULL)
+        goto fn_exit;
+
+    if (yaksi_plan->is_sync) {
+        rc = yaksur_plan_execute(yaksi_plan, NULL);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+        goto fn_exit;
+    }
+
+    yaksi_request_s *yaksi_request;
+    rc = yaksi_request_create(yaksi_plan->stream, &yaksi_request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+    yaksi_request->blocking_wait = (yaksi_plan->info && yaksi_plan->info->blocking_wait);
+
+    rc = yaksur_plan_execute(yaksi_plan, yaksi_request);
+    if (rc == YAKSA_ERR__NOT_SUPPORTED) {
+        if (yaksi_plan->op == YAKSA_PACK_PLAN_OP__PACK) {
+            rc = yaksi_ipack_backend(yaksi_plan->inbuf, yaksi_plan->outbuf, yaksi_plan->count,
+                                     yaksi_plan->type, yaksi_plan->info, yaksi_request);
+        } else {
+            rc = yaksi_iunpack_backend(yaksi_plan->inbuf, yaksi_plan->outbuf, yaksi_plan->count,
+                                       yaksi_plan->type, yaksi_plan->info, yaksi_request);
+        }
+    }
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    int cc = yaksu_atomic_load(&yaksi_request->cc);
+    if (cc) {
+        *request = yaksi_request->id;
+    } else {
+        rc = yaksi_request_free(yaksi_request);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksa_pack_plan_free(yaksa_pack_plan_t plan)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_plan_s *yaksi_plan = (yaksi_plan_s *) plan;
+
+    if (yaksi_plan->backend.priv) {
+        rc = yaksur_plan_free(yaksi_plan);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    rc = yaksi_type_free(yaksi_plan->type);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    free(yaksi_plan);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
@@ -6,9 +6,17 @@
 AM_CPPFLAGS += -I$(top_srcdir)/src/frontend/pup
 
 libyaksa_la_SOURCES += \
+	src/frontend/pup/yaksa_buffer_unregister.c \
+	src/frontend/pup/yaksa_pack.c \
 	src/frontend/pup/yaksa_ipack.c \
+	src/frontend/pup/yaksa_ipack_batch.c \
+	src/frontend/pup/yaksa_ipack_counter.c \
+	src/frontend/pup/yaksa_unpack.c \
 	src/frontend/pup/yaksa_iunpack.c \
+	src/frontend/pup/yaksa_iunpack_batch.c \
+	src/frontend/pup/yaksa_iunpack_counter.c \
 	src/frontend/pup/yaksa_request.c \
+	src/frontend/pup/yaksi_batch.c \
 	src/frontend/pup/yaksi_ipack.c \
 	src/frontend/pup/yaksi_ipack_element.c \
 	src/frontend/pup/yaksi_ipack_backend.c \
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+
+/* buffers can be unregistered outside of yaksa_init and
+ * yaksa_finalize, e.g., when the memory is freed after finalize */
+int yaksa_buffer_unregister(const void *buf, uintptr_t size)
+{
+    int rc = YAKSA_SUCCESS;
+
+    rc = yaksur_buffer_unregister(buf, size);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
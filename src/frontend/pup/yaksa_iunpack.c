@@ -33,14 +33,45 @@ int yaksa_iunpack(const void *inbuf, uintptr_t insize, void *outbuf, uintptr_t o
         goto fn_exit;
     }
 
-    yaksi_request_s *yaksi_request = NULL;
-    rc = yaksi_request_create(&yaksi_request);
+    yaksi_info_s *yaksi_info = (yaksi_info_s *) info;
+    yaksi_stream_s *yaksi_stream;
+    rc = yaksi_stream_get(yaksi_info ? yaksi_info->stream : YAKSA_STREAM__DEFAULT, &yaksi_stream);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
-    yaksi_info_s *yaksi_info = (yaksi_info_s *) info;
-    rc = yaksi_iunpack(inbuf, insize, outbuf, outcount, yaksi_type, outoffset, actual_unpack_bytes,
-                       yaksi_info, yaksi_request);
+    yaksi_request_s *yaksi_request = NULL;
+    rc = yaksi_request_create(yaksi_stream, &yaksi_request);
     YAKSU_ERR_CHECK(rc, fn_fail);
+    yaksi_request->blocking_wait = (yaksi_info && yaksi_info->blocking_wait);
+
+    /* if the operation depends on an incomplete request, it is
+     * issued once that request completes */
+    bool is_deferred = false;
+    if (yaksi_info && yaksi_info->dependency != YAKSA_REQUEST__NULL) {
+        yaksi_request_s *parent;
+        rc = yaksi_request_get(yaksi_info->dependency, &parent);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        yaksi_request_dep_s dep;
+        dep.kind = YAKSI_REQUEST_DEP__UNPACK;
+        dep.inbuf = inbuf;
+        dep.inlen = insize;
+        dep.outbuf = outbuf;
+        dep.outlen = outcount;
+        dep.type = yaksi_type;
+        dep.offset = outoffset;
+        dep.actual_bytes = actual_unpack_bytes;
+        dep.info = yaksi_info;
+        dep.request = yaksi_request;
+
+        rc = yaksi_request_add_dependency(parent, &dep, &is_deferred);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    if (!is_deferred) {
+        rc = yaksi_iunpack(inbuf, insize, outbuf, outcount, yaksi_type, outoffset,
+                           actual_unpack_bytes, yaksi_info, yaksi_request);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
 
     int cc = yaksu_atomic_load(&yaksi_request->cc);
     if (cc) {
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <stdlib.h>
+#include <assert.h>
+
+int yaksa_iunpack_batch(const void *inbuf, const yaksa_batch_desc_t * descs, uintptr_t ndescs,
+                        uintptr_t * actual_unpack_bytes, yaksa_info_t info,
+                        yaksa_request_t * request)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_batch_desc_s *yaksi_descs = NULL;
+    bool *is_supported = NULL;
+
+    assert(yaksi_global.is_initialized);
+
+    *actual_unpack_bytes = 0;
+    *request = YAKSA_REQUEST__NULL;
+
+    if (ndescs == 0)
+        goto fn_exit;
+
+    yaksi_descs = (yaksi_batch_desc_s *) malloc(ndescs * sizeof(yaksi_batch_desc_s));
+    YAKSU_ERR_CHKANDJUMP(!yaksi_descs, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    rc = yaksi_batch_desc_resolve(descs, ndescs, yaksi_descs, &ndescs, actual_unpack_bytes);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    if (ndescs == 0)
+        goto fn_exit;
+
+    is_supported = (bool *) malloc(ndescs * sizeof(bool));
+    YAKSU_ERR_CHKANDJUMP(!is_supported, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    yaksi_info_s *yaksi_info = (yaksi_info_s *) info;
+    yaksi_stream_s *yaksi_stream;
+    rc = yaksi_stream_get(yaksi_info ? yaksi_info->stream : YAKSA_STREAM__DEFAULT, &yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    yaksi_request_s *yaksi_request;
+    rc = yaksi_request_create(yaksi_stream, &yaksi_request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+    yaksi_request->blocking_wait = (yaksi_info && yaksi_info->blocking_wait);
+
+    rc = yaksur_iunpack_batch(inbuf, yaksi_descs, ndescs, yaksi_info, yaksi_request,
+                              is_supported);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    /* descriptors that the backend could not handle as a whole are
+     * broken down by the frontend */
+    for (uintptr_t i = 0; i < ndescs; i++) {
+        if (!is_supported[i]) {
+            rc = yaksi_iunpack_backend((const char *) inbuf + yaksi_descs[i].offset,
+                                       yaksi_descs[i].buf, yaksi_descs[i].count,
+                                       yaksi_descs[i].type, yaksi_info, yaksi_request);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+        }
+    }
+
+    int cc = yaksu_atomic_load(&yaksi_request->cc);
+    if (cc) {
+        *request = yaksi_request->id;
+    } else {
+        rc = yaksi_request_free(yaksi_request);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    free(is_supported);
+    free(yaksi_descs);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
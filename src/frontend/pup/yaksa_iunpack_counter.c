@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <assert.h>
+
+int yaksa_iunpack_counter(const void *inbuf, uintptr_t insize, void *outbuf, uintptr_t outcount,
+                          yaksa_type_t type, uintptr_t outoffset,
+                          uintptr_t * actual_unpack_bytes, yaksa_info_t info,
+                          yaksa_counter_t * counter)
+{
+    int rc = YAKSA_SUCCESS;
+
+    assert(yaksi_global.is_initialized);
+
+    yaksi_type_s *yaksi_type;
+    rc = yaksi_type_get(type, &yaksi_type);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    if (outcount == 0 || yaksi_type->size == 0) {
+        *actual_unpack_bytes = 0;
+        yaksu_atomic_decr((yaksu_atomic_int *) counter);
+        goto fn_exit;
+    }
+
+    yaksi_info_s *yaksi_info = (yaksi_info_s *) info;
+    assert(yaksi_info == NULL || yaksi_info->dependency == YAKSA_REQUEST__NULL);
+
+    /* ranges of whole elements on host buffers are handed to the
+     * backend without a request */
+    uintptr_t bytes = YAKSU_MIN(insize, outcount * yaksi_type->size - outoffset);
+    if (outoffset % yaksi_type->size == 0 && bytes % yaksi_type->size == 0) {
+        char *dbuf = (char *) outbuf + outoffset / yaksi_type->size * yaksi_type->extent;
+
+        rc = yaksur_iunpack_counter(inbuf, dbuf, bytes / yaksi_type->size, yaksi_type,
+                                    yaksi_info, (yaksu_atomic_int *) counter);
+        if (rc != YAKSA_ERR__NOT_SUPPORTED) {
+            YAKSU_ERR_CHECK(rc, fn_fail);
+            *actual_unpack_bytes = bytes;
+            goto fn_exit;
+        }
+        rc = YAKSA_SUCCESS;
+    }
+
+    /* everything else uses a detached request, which decrements the
+     * counter when it completes */
+    yaksi_stream_s *yaksi_stream;
+    rc = yaksi_stream_get(yaksi_info ? yaksi_info->stream : YAKSA_STREAM__DEFAULT, &yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksi_stream_progress(yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    yaksi_request_s *yaksi_request;
+    rc = yaksi_request_create(yaksi_stream, &yaksi_request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    /* hold a completion count while issuing, so the request cannot
+     * complete before all of its operations are issued */
+    yaksu_atomic_incr(&yaksi_request->cc);
+
+    rc = yaksi_request_detach(yaksi_request, (yaksu_atomic_int *) counter);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksi_iunpack(inbuf, insize, outbuf, outcount, yaksi_type, outoffset,
+                       actual_unpack_bytes, yaksi_info, yaksi_request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksi_request_complete(yaksi_request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <string.h>
+#include <assert.h>
+
+int yaksa_pack(const void *inbuf, uintptr_t incount, yaksa_type_t type, uintptr_t inoffset,
+               void *outbuf, uintptr_t max_pack_bytes, uintptr_t * actual_pack_bytes,
+               yaksa_info_t info)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_info_s *yaksi_info = (yaksi_info_s *) info;
+
+    assert(yaksi_global.is_initialized);
+
+    /* host buffers can be copied right here, without a request */
+    if (yaksi_info && yaksi_info->host_buffers && yaksi_info->dependency == YAKSA_REQUEST__NULL) {
+        yaksi_type_s *yaksi_type;
+        rc = yaksi_type_get(type, &yaksi_type);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        uintptr_t total_bytes = incount * yaksi_type->size;
+        if (total_bytes == 0) {
+            *actual_pack_bytes = 0;
+            goto fn_exit;
+        }
+
+        /* ranges of whole elements are copied directly; partial
+         * elements need the element-wise logic of the regular path */
+        uintptr_t bytes = YAKSU_MIN(max_pack_bytes, total_bytes - inoffset);
+        if (inoffset % yaksi_type->size == 0 && bytes % yaksi_type->size == 0) {
+            const char *sbuf =
+                (const char *) inbuf + inoffset / yaksi_type->size * yaksi_type->extent;
+
+            if (yaksi_type->is_contig) {
+                memcpy(outbuf, sbuf + yaksi_type->true_lb, bytes);
+                rc = YAKSA_SUCCESS;
+            } else {
+                rc = yaksur_host_pack(sbuf, outbuf, bytes / yaksi_type->size, yaksi_type,
+                                      yaksi_info);
+            }
+
+            if (rc != YAKSA_ERR__NOT_SUPPORTED) {
+                YAKSU_ERR_CHECK(rc, fn_fail);
+                *actual_pack_bytes = bytes;
+                goto fn_exit;
+            }
+            rc = YAKSA_SUCCESS;
+        }
+    }
+
+    /* everything else goes through the nonblocking path */
+    yaksa_request_t request;
+    rc = yaksa_ipack(inbuf, incount, type, inoffset, outbuf, max_pack_bytes, actual_pack_bytes,
+                     info, &request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksa_request_wait(request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
@@ -5,6 +5,7 @@
 
 #include "yaksi.h"
 #include "yaksu.h"
+#include <stdlib.h>
 #include <assert.h>
 
 int yaksa_request_test(yaksa_request_t request, int *completed)
@@ -22,10 +23,9 @@ int yaksa_request_test(yaksa_request_t request, int *completed)
     rc = yaksi_request_get(request, &yaksi_request);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
-    if (yaksu_atomic_load(&yaksi_request->cc)) {
-        rc = yaksur_request_test(yaksi_request);
-        YAKSU_ERR_CHECK(rc, fn_fail);
-    }
+    bool is_deferred;
+    rc = yaksi_request_progress(yaksi_request, &is_deferred);
+    YAKSU_ERR_CHECK(rc, fn_fail);
 
     *completed = !yaksu_atomic_load(&yaksi_request->cc);
 
@@ -54,6 +54,14 @@ int yaksa_request_wait(yaksa_request_t request)
     rc = yaksi_request_get(request, &yaksi_request);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
+    /* deferred operations cannot be handed to the backend till they
+     * are issued, so keep driving the requests they depend on */
+    bool is_deferred = true;
+    while (is_deferred && yaksu_atomic_load(&yaksi_request->cc)) {
+        rc = yaksi_request_progress(yaksi_request, &is_deferred);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
     if (yaksu_atomic_load(&yaksi_request->cc)) {
         rc = yaksur_request_wait(yaksi_request);
         YAKSU_ERR_CHECK(rc, fn_fail);
@@ -68,3 +76,169 @@ int yaksa_request_wait(yaksa_request_t request)
   fn_fail:
     goto fn_exit;
 }
+
+int yaksa_request_set_callback(yaksa_request_t request, void (*fn) (void *), void *arg)
+{
+    int rc = YAKSA_SUCCESS;
+
+    assert(yaksi_global.is_initialized);
+
+    if (request == YAKSA_REQUEST__NULL) {
+        fn(arg);
+        goto fn_exit;
+    }
+
+    yaksi_request_s *yaksi_request;
+    rc = yaksi_request_get(request, &yaksi_request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksi_request_set_callback(yaksi_request, fn, arg);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/* resolve the handles in the list and drive them with a single
+ * progress sweep; NULL handles resolve to NULL */
+static int progress_list(int count, const yaksa_request_t * requests,
+                         yaksi_request_s ** yaksi_requests)
+{
+    int rc = YAKSA_SUCCESS;
+
+    for (int i = 0; i < count; i++) {
+        yaksi_requests[i] = NULL;
+        if (requests[i] != YAKSA_REQUEST__NULL) {
+            rc = yaksi_request_get(requests[i], &yaksi_requests[i]);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+        }
+    }
+
+    rc = yaksi_request_progress_all(count, yaksi_requests);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksa_request_waitall(int count, yaksa_request_t * requests)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_request_s **yaksi_requests;
+
+    assert(yaksi_global.is_initialized);
+
+    yaksi_requests = (yaksi_request_s **) malloc(count * sizeof(yaksi_request_s *));
+    YAKSU_ERR_CHKANDJUMP(count && !yaksi_requests, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    rc = progress_list(count, requests, yaksi_requests);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    int npending;
+    do {
+        npending = 0;
+        for (int i = 0; i < count; i++) {
+            if (yaksi_requests[i] == NULL)
+                continue;
+
+            if (yaksu_atomic_load(&yaksi_requests[i]->cc)) {
+                npending++;
+            } else {
+                rc = yaksi_request_free(yaksi_requests[i]);
+                YAKSU_ERR_CHECK(rc, fn_fail);
+
+                yaksi_requests[i] = NULL;
+                requests[i] = YAKSA_REQUEST__NULL;
+            }
+        }
+
+        if (npending) {
+            rc = yaksi_request_progress_all(count, yaksi_requests);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+        }
+    } while (npending);
+
+  fn_exit:
+    free(yaksi_requests);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksa_request_testany(int count, yaksa_request_t * requests, int *index, int *completed)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_request_s **yaksi_requests;
+
+    assert(yaksi_global.is_initialized);
+
+    *index = -1;
+    *completed = 1;
+
+    yaksi_requests = (yaksi_request_s **) malloc(count * sizeof(yaksi_request_s *));
+    YAKSU_ERR_CHKANDJUMP(count && !yaksi_requests, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    rc = progress_list(count, requests, yaksi_requests);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    for (int i = 0; i < count; i++) {
+        if (yaksi_requests[i] == NULL)
+            continue;
+
+        if (yaksu_atomic_load(&yaksi_requests[i]->cc)) {
+            *completed = 0;
+            continue;
+        }
+
+        rc = yaksi_request_free(yaksi_requests[i]);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        requests[i] = YAKSA_REQUEST__NULL;
+        *index = i;
+        *completed = 1;
+        break;
+    }
+
+  fn_exit:
+    free(yaksi_requests);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksa_request_testsome(int count, yaksa_request_t * requests, int *outcount, int *indices)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_request_s **yaksi_requests;
+
+    assert(yaksi_global.is_initialized);
+
+    *outcount = 0;
+
+    yaksi_requests = (yaksi_request_s **) malloc(count * sizeof(yaksi_request_s *));
+    YAKSU_ERR_CHKANDJUMP(count && !yaksi_requests, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    rc = progress_list(count, requests, yaksi_requests);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    for (int i = 0; i < count; i++) {
+        if (yaksi_requests[i] == NULL || yaksu_atomic_load(&yaksi_requests[i]->cc))
+            continue;
+
+        rc = yaksi_request_free(yaksi_requests[i]);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        requests[i] = YAKSA_REQUEST__NULL;
+        indices[(*outcount)++] = i;
+    }
+
+  fn_exit:
+    free(yaksi_requests);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <string.h>
+#include <assert.h>
+
+int yaksa_unpack(const void *inbuf, uintptr_t insize, void *outbuf, uintptr_t outcount,
+                 yaksa_type_t type, uintptr_t outoffset, uintptr_t * actual_unpack_bytes,
+                 yaksa_info_t info)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_info_s *yaksi_info = (yaksi_info_s *) info;
+
+    assert(yaksi_global.is_initialized);
+
+    /* host buffers can be copied right here, without a request */
+    if (yaksi_info && yaksi_info->host_buffers && yaksi_info->dependency == YAKSA_REQUEST__NULL) {
+        yaksi_type_s *yaksi_type;
+        rc = yaksi_type_get(type, &yaksi_type);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        uintptr_t total_bytes = outcount * yaksi_type->size;
+        if (total_bytes == 0) {
+            *actual_unpack_bytes = 0;
+            goto fn_exit;
+        }
+
+        /* ranges of whole elements are copied directly; partial
+         * elements need the element-wise logic of the regular path */
+        uintptr_t bytes = YAKSU_MIN(insize, total_bytes - outoffset);
+        if (outoffset % yaksi_type->size == 0 && bytes % yaksi_type->size == 0) {
+            char *dbuf = (char *) outbuf + outoffset / yaksi_type->size * yaksi_type->extent;
+
+            if (yaksi_type->is_contig) {
+                memcpy(dbuf + yaksi_type->true_lb, inbuf, bytes);
+                rc = YAKSA_SUCCESS;
+            } else {
+                rc = yaksur_host_unpack(inbuf, dbuf, bytes / yaksi_type->size, yaksi_type,
+                                        yaksi_info);
+            }
+
+            if (rc != YAKSA_ERR__NOT_SUPPORTED) {
+                YAKSU_ERR_CHECK(rc, fn_fail);
+                *actual_unpack_bytes = bytes;
+                goto fn_exit;
+            }
+            rc = YAKSA_SUCCESS;
+        }
+    }
+
+    /* everything else goes through the nonblocking path */
+    yaksa_request_t request;
+    rc = yaksa_iunpack(inbuf, insize, outbuf, outcount, type, outoffset, actual_unpack_bytes,
+                       info, &request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksa_request_wait(request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
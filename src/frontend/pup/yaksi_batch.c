@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <assert.h>
+
+/* resolve the types and offsets of the user descriptors; descriptors
+ * without any data are dropped, so the backend never sees them */
+int yaksi_batch_desc_resolve(const yaksa_batch_desc_t * descs, uintptr_t ndescs,
+                             yaksi_batch_desc_s * yaksi_descs, uintptr_t * nresolved,
+                             uintptr_t * total_bytes)
+{
+    int rc = YAKSA_SUCCESS;
+    uintptr_t next = 0;
+
+    *nresolved = 0;
+    *total_bytes = 0;
+
+    for (uintptr_t i = 0; i < ndescs; i++) {
+        yaksi_type_s *type;
+        rc = yaksi_type_get(descs[i].type, &type);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        uintptr_t offset = (descs[i].offset == YAKSA_BATCH_OFFSET__NEXT) ? next : descs[i].offset;
+        uintptr_t size = descs[i].count * type->size;
+
+        next = offset + size;
+        if (size == 0)
+            continue;
+
+        if (next > *total_bytes)
+            *total_bytes = next;
+
+        yaksi_descs[*nresolved].buf = descs[i].buf;
+        yaksi_descs[*nresolved].count = descs[i].count;
+        yaksi_descs[*nresolved].type = type;
+        yaksi_descs[*nresolved].offset = offset;
+        (*nresolved)++;
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
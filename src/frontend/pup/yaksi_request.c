@@ -5,17 +5,30 @@
 
 #include "yaksi.h"
 #include "yaksu.h"
+#include <stdlib.h>
+#include <assert.h>
 
-int yaksi_request_create(yaksi_request_s ** request)
+int yaksi_request_create(yaksi_stream_s * stream, yaksi_request_s ** request)
 {
     int rc = YAKSA_SUCCESS;
     unsigned int idx;
 
-    rc = yaksu_pool_elem_alloc(yaksi_global.request_pool, (void **) request, &idx);
+    rc = yaksu_pool_elem_alloc(stream->request_pool, (void **) request, &idx);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
-    (*request)->id = (yaksa_request_t) idx;
+    (*request)->id = (yaksa_request_t) (((unsigned int) stream->id << YAKSI_REQUEST_STREAM_SHIFT) |
+                                        idx);
+    (*request)->stream = stream;
     yaksu_atomic_store(&(*request)->cc, 0);
+    yaksu_atomic_store(&(*request)->refcount, 1);
+    (*request)->deps = NULL;
+    (*request)->parent = NULL;
+    (*request)->counter = NULL;
+    (*request)->next_detached = NULL;
+    (*request)->blocking_wait = false;
+    (*request)->nwaiters = 0;
+    (*request)->callback = NULL;
+    (*request)->callback_arg = NULL;
 
     rc = yaksur_request_create_hook(*request);
     YAKSU_ERR_CHECK(rc, fn_fail);
@@ -30,10 +43,19 @@ int yaksi_request_free(yaksi_request_s * request)
 {
     int rc = YAKSA_SUCCESS;
 
+    int ret = yaksu_atomic_decr(&request->refcount);
+    assert(ret >= 1);
+
+    if (ret > 1)
+        goto fn_exit;
+
+    assert(request->deps == NULL);
+
     rc = yaksur_request_free_hook(request);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
-    rc = yaksu_pool_elem_free(yaksi_global.request_pool, request->id);
+    rc = yaksu_pool_elem_free(request->stream->request_pool,
+                              (unsigned int) request->id & YAKSI_REQUEST_IDX_MASK);
     YAKSU_ERR_CHECK(rc, fn_fail);
 
   fn_exit:
@@ -45,10 +67,311 @@ int yaksi_request_free(yaksi_request_s * request)
 int yaksi_request_get(yaksa_request_t request, struct yaksi_request_s **yaksi_request)
 {
     int rc = YAKSA_SUCCESS;
+    yaksi_stream_s *yaksi_stream;
+
+    rc = yaksi_stream_get((yaksa_stream_t) ((unsigned int) request >> YAKSI_REQUEST_STREAM_SHIFT),
+                          &yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksu_pool_elem_get(yaksi_stream->request_pool,
+                             (unsigned int) request & YAKSI_REQUEST_IDX_MASK,
+                             (void **) yaksi_request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/*
+ * Dependencies: an operation that depends on an incomplete request is
+ * not issued, but queued on the parent request.  The dependent
+ * request holds a reference to its parent and a completion counter
+ * of its own, both of which are released once the operation has been
+ * issued.  The operation is issued by whoever completes the parent,
+ * which can be a thread waiting on an unrelated request, the progress
+ * engine, or a backend worker thread.
+ */
+
+int yaksi_request_add_dependency(yaksi_request_s * parent, const yaksi_request_dep_s * dep,
+                                 bool * is_deferred)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_request_dep_s *newdep = NULL;
+
+    *is_deferred = false;
+
+    pthread_mutex_lock(&parent->stream->dep_mutex);
+
+    if (!yaksu_atomic_load(&parent->cc))
+        goto fn_exit;
+
+    newdep = (yaksi_request_dep_s *) malloc(sizeof(yaksi_request_dep_s));
+    YAKSU_ERR_CHKANDJUMP(!newdep, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    *newdep = *dep;
+
+    /* the user is allowed to free the type once the operation has
+     * been issued, so hold a reference till it is actually issued */
+    yaksu_atomic_incr(&newdep->type->refcount);
+
+    /* the request is not yet visible to any other thread */
+    yaksu_atomic_incr(&newdep->request->cc);
+    newdep->request->parent = parent;
+    yaksu_atomic_incr(&parent->refcount);
+
+    newdep->next = parent->deps;
+    parent->deps = newdep;
+    *is_deferred = true;
+
+  fn_exit:
+    pthread_mutex_unlock(&parent->stream->dep_mutex);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+static int issue_dep(yaksi_request_dep_s * dep)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_request_s *request = dep->request;
+    yaksi_request_s *parent = request->parent;
 
-    rc = yaksu_pool_elem_get(yaksi_global.request_pool, (int) request, (void **) yaksi_request);
+    if (dep->kind == YAKSI_REQUEST_DEP__PACK) {
+        rc = yaksi_ipack(dep->inbuf, dep->inlen, dep->type, dep->offset, dep->outbuf,
+                         dep->outlen, dep->actual_bytes, dep->info, request);
+    } else {
+        rc = yaksi_iunpack(dep->inbuf, dep->inlen, dep->outbuf, dep->outlen, dep->type,
+                           dep->offset, dep->actual_bytes, dep->info, request);
+    }
     YAKSU_ERR_CHECK(rc, fn_fail);
 
+    /* from here on, the request can be handed to the backend */
+    pthread_mutex_lock(&request->stream->dep_mutex);
+    request->parent = NULL;
+    pthread_mutex_unlock(&request->stream->dep_mutex);
+
+    rc = yaksi_request_free(parent);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksi_type_free(dep->type);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    /* release the completion counter held while the operation was
+     * deferred */
+    rc = yaksi_request_complete(request);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    free(dep);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksi_request_complete(yaksi_request_s * request)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_request_dep_s *deps = NULL;
+    yaksu_atomic_int *counter = request->counter;
+    bool has_waiters = false;
+    void (*callback) (void *) = NULL;
+    void *callback_arg = NULL;
+
+    /* the dependency list has to be detached before the request is
+     * visibly complete, as the user can free it right after */
+    pthread_mutex_lock(&request->stream->dep_mutex);
+    int ret = yaksu_atomic_decr(&request->cc);
+    assert(ret >= 1);
+    if (ret == 1) {
+        deps = request->deps;
+        request->deps = NULL;
+        has_waiters = (request->nwaiters > 0);
+        callback = request->callback;
+        callback_arg = request->callback_arg;
+        request->callback = NULL;
+    }
+    pthread_mutex_unlock(&request->stream->dep_mutex);
+
+    /* detached requests only notify the user; the request itself is
+     * reclaimed by the next progress sweep of its stream, so it must
+     * not be touched anymore */
+    if (ret == 1 && counter) {
+        yaksu_atomic_decr(counter);
+    }
+
+    /* a woken up waiter can free the request right away, but the
+     * pool element stays allocated, so waking up is still safe */
+    if (has_waiters) {
+        rc = yaksu_futex_wake(&request->cc);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+    while (deps) {
+        yaksi_request_dep_s *next = deps->next;
+
+        rc = issue_dep(deps);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+
+        deps = next;
+    }
+
+    /* requests with a callback are detached, so the request is
+     * reclaimed by the progress sweep of its stream */
+    if (callback) {
+        callback(callback_arg);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksi_request_progress(yaksi_request_s * request, bool * is_deferred)
+{
+    int rc = YAKSA_SUCCESS;
+
+    pthread_mutex_lock(&request->stream->dep_mutex);
+    yaksi_request_s *parent = request->parent;
+    if (parent)
+        yaksu_atomic_incr(&parent->refcount);
+    pthread_mutex_unlock(&request->stream->dep_mutex);
+
+    *is_deferred = (parent != NULL);
+
+    if (parent) {
+        /* drive the request we are waiting for; the parent can itself
+         * be deferred */
+        if (yaksu_atomic_load(&parent->cc)) {
+            bool parent_is_deferred;
+            rc = yaksi_request_progress(parent, &parent_is_deferred);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+        }
+
+        rc = yaksi_request_free(parent);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    } else if (yaksu_atomic_load(&request->cc)) {
+        rc = yaksur_request_test(request);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/* drive a list of requests in one sweep: deferred requests drive
+ * the requests they are waiting for, and the issued ones are handed
+ * to the backend together, so each stream is poked only once.
+ * Entries can be NULL. */
+int yaksi_request_progress_all(int count, yaksi_request_s ** requests)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_request_s **issued;
+    int nissued = 0;
+
+    issued = (yaksi_request_s **) malloc(count * sizeof(yaksi_request_s *));
+    YAKSU_ERR_CHKANDJUMP(count && !issued, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    for (int i = 0; i < count; i++) {
+        yaksi_request_s *request = requests[i];
+        if (request == NULL || !yaksu_atomic_load(&request->cc))
+            continue;
+
+        pthread_mutex_lock(&request->stream->dep_mutex);
+        bool is_deferred = (request->parent != NULL);
+        pthread_mutex_unlock(&request->stream->dep_mutex);
+
+        if (is_deferred) {
+            rc = yaksi_request_progress(request, &is_deferred);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+        } else {
+            issued[nissued++] = request;
+        }
+    }
+
+    if (nissued) {
+        rc = yaksur_request_testall(nissued, issued);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    free(issued);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksi_request_detach(yaksi_request_s * request, yaksu_atomic_int * counter)
+{
+    yaksi_stream_s *stream = request->stream;
+
+    request->counter = counter;
+
+    pthread_mutex_lock(&stream->dep_mutex);
+    request->next_detached = stream->detached;
+    stream->detached = request;
+    pthread_mutex_unlock(&stream->dep_mutex);
+
+    return YAKSA_SUCCESS;
+}
+
+/* sleep till the request completes; this is only useful when another
+ * thread (e.g., an async worker) drives the request to completion */
+int yaksi_request_block(yaksi_request_s * request)
+{
+    int rc = YAKSA_SUCCESS;
+
+    /* the waiter is registered under the same mutex that the
+     * completion path reads the count under, so either we see the
+     * request complete below, or the completion path wakes us up */
+    pthread_mutex_lock(&request->stream->dep_mutex);
+    request->nwaiters++;
+    pthread_mutex_unlock(&request->stream->dep_mutex);
+
+    int cc;
+    while ((cc = yaksu_atomic_load(&request->cc))) {
+        rc = yaksu_futex_wait(&request->cc, cc);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
+  fn_exit:
+    pthread_mutex_lock(&request->stream->dep_mutex);
+    request->nwaiters--;
+    pthread_mutex_unlock(&request->stream->dep_mutex);
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksi_request_set_callback(yaksi_request_s * request, void (*fn) (void *), void *arg)
+{
+    int rc = YAKSA_SUCCESS;
+    bool is_complete;
+
+    /* the user hands the request over, so an incomplete request is
+     * detached and reclaimed by the progress sweep of its stream,
+     * which also drives it */
+    pthread_mutex_lock(&request->stream->dep_mutex);
+    is_complete = !yaksu_atomic_load(&request->cc);
+    if (!is_complete) {
+        request->callback = fn;
+        request->callback_arg = arg;
+        request->next_detached = request->stream->detached;
+        request->stream->detached = request;
+    }
+    pthread_mutex_unlock(&request->stream->dep_mutex);
+
+    if (is_complete) {
+        fn(arg);
+
+        rc = yaksi_request_free(request);
+        YAKSU_ERR_CHECK(rc, fn_fail);
+    }
+
   fn_exit:
     return rc;
   fn_fail:
@@ -0,0 +1,9 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+AM_CPPFLAGS += -I$(top_srcdir)/src/frontend/stats
+
+libyaksa_la_SOURCES += \
+	src/frontend/stats/yaksa_stats.c
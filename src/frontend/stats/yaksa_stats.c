@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <string.h>
+#include <assert.h>
+
+int yaksa_stats_get(yaksa_stats_t * stats)
+{
+    int rc = YAKSA_SUCCESS;
+
+    assert(yaksi_global.is_initialized);
+
+    memset(stats, 0, sizeof(yaksa_stats_t));
+
+    rc = yaksur_stats_get_hook(stats);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    yaksi_unflatten_cache_stats_get(stats);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
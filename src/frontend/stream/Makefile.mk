@@ -0,0 +1,10 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+AM_CPPFLAGS += -I$(top_srcdir)/src/frontend/stream
+
+libyaksa_la_SOURCES += \
+	src/frontend/stream/yaksa_stream.c \
+	src/frontend/stream/yaksi_stream.c
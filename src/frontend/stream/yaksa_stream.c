@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <assert.h>
+
+int yaksa_stream_create(yaksa_stream_t * stream)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_stream_s *yaksi_stream;
+
+    assert(yaksi_global.is_initialized);
+
+    rc = yaksi_stream_create(&yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    *stream = yaksi_stream->id;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksa_stream_free(yaksa_stream_t stream)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_stream_s *yaksi_stream;
+
+    assert(yaksi_global.is_initialized);
+    assert(stream != YAKSA_STREAM__DEFAULT);
+
+    rc = yaksi_stream_get(stream, &yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksi_stream_free(yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksa_stream_progress(yaksa_stream_t stream)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_stream_s *yaksi_stream;
+
+    assert(yaksi_global.is_initialized);
+
+    rc = yaksi_stream_get(stream, &yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksi_stream_progress(yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksi.h"
+#include "yaksu.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <sched.h>
+
+#define REQUEST_CHUNK_SIZE (1024)
+
+int yaksi_stream_create(yaksi_stream_s ** stream)
+{
+    int rc = YAKSA_SUCCESS;
+    unsigned int idx;
+
+    *stream = NULL;
+    rc = yaksu_pool_elem_alloc(yaksi_global.stream_pool, (void **) stream, &idx);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+    YAKSU_ERR_CHKANDJUMP(!*stream, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    (*stream)->id = (yaksa_stream_t) idx;
+
+    /* the request index has to fit in the lower bits of the request
+     * handle */
+    rc = yaksu_pool_alloc(sizeof(yaksi_request_s), REQUEST_CHUNK_SIZE,
+                          YAKSI_REQUEST_IDX_MASK + 1, malloc, free, &(*stream)->request_pool);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    pthread_mutex_init(&(*stream)->dep_mutex, NULL);
+    (*stream)->detached = NULL;
+
+    rc = yaksur_stream_create_hook(*stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksi_stream_free(yaksi_stream_s * stream)
+{
+    int rc = YAKSA_SUCCESS;
+
+    /* reclaim the detached requests that have completed; all
+     * operations on the stream must be complete by now */
+    rc = yaksi_stream_progress(stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+    assert(stream->detached == NULL);
+
+    rc = yaksur_stream_free_hook(stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    rc = yaksu_pool_free(stream->request_pool);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+    pthread_mutex_destroy(&stream->dep_mutex);
+
+    rc = yaksu_pool_elem_free(yaksi_global.stream_pool, stream->id);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksi_stream_get(yaksa_stream_t stream, yaksi_stream_s ** yaksi_stream)
+{
+    int rc = YAKSA_SUCCESS;
+
+    rc = yaksu_pool_elem_get(yaksi_global.stream_pool, (unsigned int) stream,
+                             (void **) yaksi_stream);
+    YAKSU_ERR_CHECK(rc, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+/* drive the detached requests of the stream, and reclaim the ones
+ * that have completed */
+int yaksi_stream_progress(yaksi_stream_s * stream)
+{
+    int rc = YAKSA_SUCCESS;
+    yaksi_request_s *pending = NULL, *pending_tail = NULL;
+    bool completed = false;
+
+    /* take the list, so the requests can be tested without holding
+     * the mutex, which their completion acquires */
+    pthread_mutex_lock(&stream->dep_mutex);
+    yaksi_request_s *request = stream->detached;
+    stream->detached = NULL;
+    pthread_mutex_unlock(&stream->dep_mutex);
+
+    while (request) {
+        yaksi_request_s *next = request->next_detached;
+
+        if (yaksu_atomic_load(&request->cc)) {
+            bool is_deferred;
+            rc = yaksi_request_progress(request, &is_deferred);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+        }
+
+        if (yaksu_atomic_load(&request->cc)) {
+            request->next_detached = NULL;
+            if (pending_tail)
+                pending_tail->next_detached = request;
+            else
+                pending = request;
+            pending_tail = request;
+        } else {
+            rc = yaksi_request_free(request);
+            YAKSU_ERR_CHECK(rc, fn_fail);
+            completed = true;
+        }
+
+        request = next;
+    }
+
+    /* the operations are completed by the worker threads and the
+     * GPUs; callers poll the stream in a loop, so let the workers
+     * have the CPU if nothing completed */
+    if (!completed)
+        sched_yield();
+
+  fn_exit:
+    if (pending) {
+        pthread_mutex_lock(&stream->dep_mutex);
+        pending_tail->next_detached = stream->detached;
+        stream->detached = pending;
+        pthread_mutex_unlock(&stream->dep_mutex);
+    }
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
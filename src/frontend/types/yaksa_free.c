@@ -47,14 +47,17 @@ int yaksi_type_free(yaksi_type_s * type)
         case YAKSI_TYPE_KIND__BLKHINDX:
             rc = yaksi_type_free(type->u.blkhindx.child);
             YAKSU_ERR_CHECK(rc, fn_fail);
-            free(type->u.blkhindx.array_of_displs);
+            if (!type->borrows_arrays)
+                free(type->u.blkhindx.array_of_displs);
             break;
 
         case YAKSI_TYPE_KIND__HINDEXED:
             rc = yaksi_type_free(type->u.hindexed.child);
             YAKSU_ERR_CHECK(rc, fn_fail);
-            free(type->u.hindexed.array_of_blocklengths);
-            free(type->u.hindexed.array_of_displs);
+            if (!type->borrows_arrays) {
+                free(type->u.hindexed.array_of_blocklengths);
+                free(type->u.hindexed.array_of_displs);
+            }
             break;
 
         case YAKSI_TYPE_KIND__STRUCT:
@@ -63,8 +66,10 @@ int yaksi_type_free(yaksi_type_s * type)
                 YAKSU_ERR_CHECK(rc, fn_fail);
             }
             free(type->u.str.array_of_types);
-            free(type->u.str.array_of_blocklengths);
-            free(type->u.str.array_of_displs);
+            if (!type->borrows_arrays) {
+                free(type->u.str.array_of_blocklengths);
+                free(type->u.str.array_of_displs);
+            }
             break;
 
         case YAKSI_TYPE_KIND__SUBARRAY:
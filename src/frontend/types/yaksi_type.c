@@ -16,6 +16,8 @@ int yaksi_type_alloc(struct yaksi_type_s **type)
 
     (*type)->id = (yaksa_type_t) idx;
     yaksu_atomic_store(&(*type)->refcount, 1);
+    yaksu_atomic_uint64_store(&(*type)->flattened_size, 0);
+    (*type)->borrows_arrays = false;
 
   fn_exit:
     return rc;
@@ -7,10 +7,18 @@ AM_CPPFLAGS += -I$(top_srcdir)/src/util
 
 libyaksa_la_SOURCES += \
 	src/util/yaksu_atomics.c \
+	src/util/yaksu_freelist.c \
+	src/util/yaksu_futex.c \
+	src/util/yaksu_mpsc.c \
+	src/util/yaksu_numa.c \
 	src/util/yaksu_pool.c
 
 noinst_HEADERS += \
 	src/util/yaksu.h \
 	src/util/yaksu_base.h \
 	src/util/yaksu_atomics.h \
+	src/util/yaksu_freelist.h \
+	src/util/yaksu_futex.h \
+	src/util/yaksu_mpsc.h \
+	src/util/yaksu_numa.h \
 	src/util/yaksu_pool.h
@@ -8,6 +8,10 @@
 
 #include "yaksu_base.h"
 #include "yaksu_atomics.h"
+#include "yaksu_futex.h"
+#include "yaksu_mpsc.h"
+#include "yaksu_freelist.h"
 #include "yaksu_pool.h"
+#include "yaksu_numa.h"
 
 #endif /* YAKSU_H_INCLUDED */
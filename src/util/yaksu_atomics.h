@@ -6,11 +6,16 @@
 #ifndef YAKSU_ATOMICS_H_INCLUDED
 #define YAKSU_ATOMICS_H_INCLUDED
 
-#ifdef HAVE_STDATOMICS_H
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef HAVE_STDATOMIC_H
 
 #include <stdatomic.h>
 
 typedef atomic_int yaksu_atomic_int;
+typedef _Atomic(void *) yaksu_atomic_ptr;
+typedef _Atomic(uint64_t) yaksu_atomic_uint64;
 
 static inline int yaksu_atomic_incr(yaksu_atomic_int * val)
 {
@@ -29,7 +34,49 @@ static inline int yaksu_atomic_load(yaksu_atomic_int * val)
 
 static inline void yaksu_atomic_store(yaksu_atomic_int * val, int x)
 {
-    return atomic_store_explicit(val, x, memory_order_release);
+    atomic_store_explicit(val, x, memory_order_release);
+}
+
+static inline void *yaksu_atomic_ptr_load(yaksu_atomic_ptr * val)
+{
+    return atomic_load_explicit(val, memory_order_acquire);
+}
+
+static inline void yaksu_atomic_ptr_store(yaksu_atomic_ptr * val, void *x)
+{
+    atomic_store_explicit(val, x, memory_order_release);
+}
+
+static inline void *yaksu_atomic_ptr_swap(yaksu_atomic_ptr * val, void *x)
+{
+    return atomic_exchange(val, x);
+}
+
+/* on failure, the current value is returned in expected */
+static inline bool yaksu_atomic_ptr_cas(yaksu_atomic_ptr * val, void **expected, void *x)
+{
+    return atomic_compare_exchange_weak(val, expected, x);
+}
+
+static inline uint64_t yaksu_atomic_uint64_load(yaksu_atomic_uint64 * val)
+{
+    return atomic_load_explicit(val, memory_order_acquire);
+}
+
+static inline void yaksu_atomic_uint64_store(yaksu_atomic_uint64 * val, uint64_t x)
+{
+    atomic_store_explicit(val, x, memory_order_release);
+}
+
+static inline uint64_t yaksu_atomic_uint64_add(yaksu_atomic_uint64 * val, uint64_t x)
+{
+    return atomic_fetch_add(val, x);
+}
+
+static inline bool yaksu_atomic_uint64_cas(yaksu_atomic_uint64 * val, uint64_t * expected,
+                                           uint64_t x)
+{
+    return atomic_compare_exchange_weak(val, expected, x);
 }
 
 #else
@@ -38,6 +85,8 @@ static inline void yaksu_atomic_store(yaksu_atomic_int * val, int x)
 
 extern pthread_mutex_t yaksui_atomic_mutex;
 typedef int yaksu_atomic_int;
+typedef void *yaksu_atomic_ptr;
+typedef uint64_t yaksu_atomic_uint64;
 
 static inline int yaksu_atomic_incr(yaksu_atomic_int * val)
 {
@@ -73,6 +122,93 @@ static inline void yaksu_atomic_store(yaksu_atomic_int * val, int x)
     pthread_mutex_unlock(&yaksui_atomic_mutex);
 }
 
+static inline void *yaksu_atomic_ptr_load(yaksu_atomic_ptr * val)
+{
+    pthread_mutex_lock(&yaksui_atomic_mutex);
+    void *ret = (*val);
+    pthread_mutex_unlock(&yaksui_atomic_mutex);
+
+    return ret;
+}
+
+static inline void yaksu_atomic_ptr_store(yaksu_atomic_ptr * val, void *x)
+{
+    pthread_mutex_lock(&yaksui_atomic_mutex);
+    *val = x;
+    pthread_mutex_unlock(&yaksui_atomic_mutex);
+}
+
+static inline void *yaksu_atomic_ptr_swap(yaksu_atomic_ptr * val, void *x)
+{
+    pthread_mutex_lock(&yaksui_atomic_mutex);
+    void *ret = (*val);
+    *val = x;
+    pthread_mutex_unlock(&yaksui_atomic_mutex);
+
+    return ret;
+}
+
+static inline bool yaksu_atomic_ptr_cas(yaksu_atomic_ptr * val, void **expected, void *x)
+{
+    bool ret;
+
+    pthread_mutex_lock(&yaksui_atomic_mutex);
+    if (*val == *expected) {
+        *val = x;
+        ret = true;
+    } else {
+        *expected = *val;
+        ret = false;
+    }
+    pthread_mutex_unlock(&yaksui_atomic_mutex);
+
+    return ret;
+}
+
+static inline uint64_t yaksu_atomic_uint64_load(yaksu_atomic_uint64 * val)
+{
+    pthread_mutex_lock(&yaksui_atomic_mutex);
+    uint64_t ret = (*val);
+    pthread_mutex_unlock(&yaksui_atomic_mutex);
+
+    return ret;
+}
+
+static inline void yaksu_atomic_uint64_store(yaksu_atomic_uint64 * val, uint64_t x)
+{
+    pthread_mutex_lock(&yaksui_atomic_mutex);
+    *val = x;
+    pthread_mutex_unlock(&yaksui_atomic_mutex);
+}
+
+static inline uint64_t yaksu_atomic_uint64_add(yaksu_atomic_uint64 * val, uint64_t x)
+{
+    pthread_mutex_lock(&yaksui_atomic_mutex);
+    uint64_t ret = *val;
+    *val += x;
+    pthread_mutex_unlock(&yaksui_atomic_mutex);
+
+    return ret;
+}
+
+static inline bool yaksu_atomic_uint64_cas(yaksu_atomic_uint64 * val, uint64_t * expected,
+                                           uint64_t x)
+{
+    bool ret;
+
+    pthread_mutex_lock(&yaksui_atomic_mutex);
+    if (*val == *expected) {
+        *val = x;
+        ret = true;
+    } else {
+        *expected = *val;
+        ret = false;
+    }
+    pthread_mutex_unlock(&yaksui_atomic_mutex);
+
+    return ret;
+}
+
 #endif
 
 #endif /* YAKSU_THREADS_H_INCLUDED */
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksa.h"
+#include "yaksu.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+/* The free elements form a stack of indices.  The top of the stack
+ * is stored together with a tag that changes on every update, so a
+ * thread that was preempted between reading the top and swapping it
+ * cannot succeed after the element was popped and pushed back in the
+ * meantime (the ABA problem). */
+
+#define FREELIST_ALIGNMENT  (16)
+
+#define TOP_IDX(top)       ((uint32_t) ((top) & 0xffffffff))
+#define TOP_TAG(top)       ((uint32_t) ((top) >> 32))
+#define TOP(tag, idx)      (((uint64_t) (tag) << 32) | (uint64_t) (idx))
+
+typedef struct {
+    uintptr_t elemsize;
+    unsigned int capacity;
+
+    char *slab;
+    /* one-based index of the next free element; zero ends the stack */
+    yaksu_atomic_int *next;
+    yaksu_atomic_uint64 top;
+} freelist_s;
+
+int yaksu_freelist_create(uintptr_t elemsize, unsigned int capacity, yaksu_freelist_s * freelist)
+{
+    int rc = YAKSA_SUCCESS;
+    freelist_s *fl;
+
+    fl = (freelist_s *) malloc(sizeof(freelist_s));
+    YAKSU_ERR_CHKANDJUMP(!fl, rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+    fl->elemsize = (elemsize + FREELIST_ALIGNMENT - 1) / FREELIST_ALIGNMENT * FREELIST_ALIGNMENT;
+    fl->capacity = capacity;
+    fl->slab = NULL;
+    fl->next = NULL;
+
+    if (capacity) {
+        fl->slab = (char *) malloc(fl->elemsize * capacity);
+        fl->next = (yaksu_atomic_int *) malloc(capacity * sizeof(yaksu_atomic_int));
+        if (!fl->slab || !fl->next) {
+            free(fl->slab);
+            free(fl->next);
+            free(fl);
+            rc = YAKSA_ERR__OUT_OF_MEM;
+            goto fn_fail;
+        }
+    }
+
+    for (unsigned int i = 0; i < capacity; i++)
+        yaksu_atomic_store(&fl->next[i], (i + 1 < capacity) ? (int) (i + 2) : 0);
+    yaksu_atomic_uint64_store(&fl->top, TOP(0, capacity ? 1 : 0));
+
+    *freelist = (yaksu_freelist_s) fl;
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksu_freelist_free(yaksu_freelist_s freelist)
+{
+    freelist_s *fl = (freelist_s *) freelist;
+
+    free(fl->slab);
+    free(fl->next);
+    free(fl);
+
+    return YAKSA_SUCCESS;
+}
+
+int yaksu_freelist_elem_alloc(yaksu_freelist_s freelist, void **elem)
+{
+    int rc = YAKSA_SUCCESS;
+    freelist_s *fl = (freelist_s *) freelist;
+    uint64_t top = yaksu_atomic_uint64_load(&fl->top);
+
+    while (TOP_IDX(top)) {
+        uint32_t idx = TOP_IDX(top);
+        uint32_t next = (uint32_t) yaksu_atomic_load(&fl->next[idx - 1]);
+
+        if (yaksu_atomic_uint64_cas(&fl->top, &top, TOP(TOP_TAG(top) + 1, next))) {
+            *elem = fl->slab + (uintptr_t) (idx - 1) * fl->elemsize;
+            goto fn_exit;
+        }
+    }
+
+    /* the pool is exhausted */
+    *elem = malloc(fl->elemsize);
+    YAKSU_ERR_CHKANDJUMP(!(*elem), rc, YAKSA_ERR__OUT_OF_MEM, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+void yaksu_freelist_elem_free(yaksu_freelist_s freelist, void *elem)
+{
+    freelist_s *fl = (freelist_s *) freelist;
+    char *ptr = (char *) elem;
+
+    if (ptr < fl->slab || ptr >= fl->slab + fl->elemsize * fl->capacity) {
+        free(elem);
+        return;
+    }
+
+    uint32_t idx = (uint32_t) ((ptr - fl->slab) / fl->elemsize) + 1;
+    uint64_t top = yaksu_atomic_uint64_load(&fl->top);
+
+    do {
+        yaksu_atomic_store(&fl->next[idx - 1], (int) TOP_IDX(top));
+    } while (!yaksu_atomic_uint64_cas(&fl->top, &top, TOP(TOP_TAG(top) + 1, idx)));
+}
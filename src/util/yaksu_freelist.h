@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#ifndef YAKSU_FREELIST_H_INCLUDED
+#define YAKSU_FREELIST_H_INCLUDED
+
+/* Fixed-capacity pool of equally sized elements.  Elements can be
+ * allocated and freed by any number of threads without locks.  Once
+ * the pool is exhausted, allocations fall back to malloc, and such
+ * elements are returned to the system when they are freed. */
+
+typedef void *yaksu_freelist_s;
+
+int yaksu_freelist_create(uintptr_t elemsize, unsigned int capacity, yaksu_freelist_s * freelist);
+int yaksu_freelist_free(yaksu_freelist_s freelist);
+int yaksu_freelist_elem_alloc(yaksu_freelist_s freelist, void **elem);
+void yaksu_freelist_elem_free(yaksu_freelist_s freelist, void *elem);
+
+#endif /* YAKSU_FREELIST_H_INCLUDED */
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#define _GNU_SOURCE
+#include "yaksa_config.h"
+#include "yaksa.h"
+#include "yaksu.h"
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+
+#if defined(HAVE_SYS_SYSCALL_H) && defined(HAVE_LINUX_FUTEX_H) && HAVE_DECL_SYS_FUTEX
+#define YAKSUI_FUTEX_ENABLED
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#ifdef YAKSUI_FUTEX_ENABLED
+
+int yaksu_futex_wait(yaksu_atomic_int * addr, int val)
+{
+    /* EAGAIN (the value already changed) and EINTR are both regular
+     * wakeups for our callers */
+    syscall(SYS_futex, (int *) addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+
+    return YAKSA_SUCCESS;
+}
+
+int yaksu_futex_wake(yaksu_atomic_int * addr)
+{
+    syscall(SYS_futex, (int *) addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+
+    return YAKSA_SUCCESS;
+}
+
+#else
+
+int yaksu_futex_wait(yaksu_atomic_int * addr, int val)
+{
+    sched_yield();
+    return YAKSA_SUCCESS;
+}
+
+int yaksu_futex_wake(yaksu_atomic_int * addr)
+{
+    return YAKSA_SUCCESS;
+}
+
+#endif /* YAKSUI_FUTEX_ENABLED */
@@ -0,0 +1,18 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#ifndef YAKSU_FUTEX_H_INCLUDED
+#define YAKSU_FUTEX_H_INCLUDED
+
+/* Sleep till an atomic integer changes.  yaksu_futex_wait returns
+ * when the value at addr is no longer val, when it is woken up, or
+ * spuriously, so callers must recheck the value.  When the platform
+ * does not provide futexes, waiting degrades to yielding the CPU and
+ * waking up is a no-op. */
+
+int yaksu_futex_wait(yaksu_atomic_int * addr, int val);
+int yaksu_futex_wake(yaksu_atomic_int * addr);
+
+#endif /* YAKSU_FUTEX_H_INCLUDED */
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include "yaksa.h"
+#include "yaksu.h"
+#include <stdlib.h>
+
+void yaksu_mpsc_init(yaksu_mpsc_s * queue)
+{
+    yaksu_atomic_ptr_store(&queue->head, NULL);
+}
+
+void yaksu_mpsc_push(yaksu_mpsc_s * queue, yaksu_mpsc_node_s * node)
+{
+    void *head = yaksu_atomic_ptr_load(&queue->head);
+
+    do {
+        node->next = (yaksu_mpsc_node_s *) head;
+    } while (!yaksu_atomic_ptr_cas(&queue->head, &head, node));
+}
+
+/* the pushed nodes form a stack, which is reversed before it is
+ * handed to the consumer */
+yaksu_mpsc_node_s *yaksu_mpsc_drain(yaksu_mpsc_s * queue)
+{
+    yaksu_mpsc_node_s *node, *list = NULL;
+
+    node = (yaksu_mpsc_node_s *) yaksu_atomic_ptr_swap(&queue->head, NULL);
+    while (node) {
+        yaksu_mpsc_node_s *next = node->next;
+        node->next = list;
+        list = node;
+        node = next;
+    }
+
+    return list;
+}
+
+bool yaksu_mpsc_is_empty(yaksu_mpsc_s * queue)
+{
+    return yaksu_atomic_ptr_load(&queue->head) == NULL;
+}
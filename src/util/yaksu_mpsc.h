@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#ifndef YAKSU_MPSC_H_INCLUDED
+#define YAKSU_MPSC_H_INCLUDED
+
+/* Intrusive multi-producer, single-consumer queue.  Any number of
+ * threads can push without locks; the consumer takes all of the
+ * pushed nodes at once, in the order in which they were pushed.
+ * Since nodes are never popped one at a time, the queue does not
+ * suffer from the ABA problem. */
+
+typedef struct yaksu_mpsc_node_s {
+    struct yaksu_mpsc_node_s *next;
+} yaksu_mpsc_node_s;
+
+typedef struct {
+    yaksu_atomic_ptr head;
+} yaksu_mpsc_s;
+
+void yaksu_mpsc_init(yaksu_mpsc_s * queue);
+void yaksu_mpsc_push(yaksu_mpsc_s * queue, yaksu_mpsc_node_s * node);
+yaksu_mpsc_node_s *yaksu_mpsc_drain(yaksu_mpsc_s * queue);
+bool yaksu_mpsc_is_empty(yaksu_mpsc_s * queue);
+
+#endif /* YAKSU_MPSC_H_INCLUDED */
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#define _GNU_SOURCE
+#include "yaksa_config.h"
+#include "yaksa.h"
+#include "yaksu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(HAVE_SYS_SYSCALL_H) && HAVE_DECL_SYS_MOVE_PAGES && HAVE_DECL_SYS_SET_MEMPOLICY && \
+    defined(HAVE_SCHED_SETAFFINITY)
+#define YAKSUI_NUMA_ENABLED
+#include <sys/syscall.h>
+#endif
+
+#ifdef YAKSUI_NUMA_ENABLED
+
+/* we do not depend on libnuma, so carry the few constants we need */
+#define YAKSUI_MPOL_DEFAULT    (0)
+#define YAKSUI_MPOL_PREFERRED  (1)
+
+#define YAKSUI_NUMA_SYSFS  "/sys/devices/system/node"
+
+static pthread_once_t numa_once = PTHREAD_ONCE_INIT;
+static int numa_nnodes = 1;
+static cpu_set_t *numa_cpusets = NULL;
+
+/* parse a sysfs list such as "0-3,8,10-11" and call fn for each
+ * entry */
+static void parse_list(const char *path, void (*fn) (int, void *), void *arg)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+        return;
+
+    int start, end;
+    char sep;
+    while (fscanf(fp, "%d", &start) == 1) {
+        end = start;
+        sep = (char) fgetc(fp);
+        if (sep == '-') {
+            if (fscanf(fp, "%d", &end) != 1)
+                break;
+            sep = (char) fgetc(fp);
+        }
+        for (int i = start; i <= end; i++)
+            fn(i, arg);
+        if (sep != ',')
+            break;
+    }
+
+    fclose(fp);
+}
+
+static void max_node_fn(int node, void *arg)
+{
+    int *max = (int *) arg;
+    if (node > *max)
+        *max = node;
+}
+
+static void cpuset_fn(int cpu, void *arg)
+{
+    cpu_set_t *set = (cpu_set_t *) arg;
+    if (cpu < CPU_SETSIZE)
+        CPU_SET(cpu, set);
+}
+
+static void numa_discover(void)
+{
+    int max_node = -1;
+    parse_list(YAKSUI_NUMA_SYSFS "/online", max_node_fn, &max_node);
+    if (max_node < 1)
+        return;
+
+    cpu_set_t *cpusets = (cpu_set_t *) malloc((max_node + 1) * sizeof(cpu_set_t));
+    if (cpusets == NULL)
+        return;
+
+    for (int i = 0; i <= max_node; i++) {
+        char path[128];
+        CPU_ZERO(&cpusets[i]);
+        snprintf(path, sizeof(path), YAKSUI_NUMA_SYSFS "/node%d/cpulist", i);
+        parse_list(path, cpuset_fn, &cpusets[i]);
+    }
+
+    numa_cpusets = cpusets;
+    numa_nnodes = max_node + 1;
+}
+
+int yaksu_numa_get_num_nodes(int *nnodes)
+{
+    pthread_once(&numa_once, numa_discover);
+    *nnodes = numa_nnodes;
+
+    return YAKSA_SUCCESS;
+}
+
+int yaksu_numa_get_node(const void *buf, int *node)
+{
+    *node = YAKSU_NUMA_NODE__UNKNOWN;
+
+    pthread_once(&numa_once, numa_discover);
+    if (numa_nnodes == 1) {
+        *node = 0;
+        goto fn_exit;
+    }
+
+    /* move_pages with a NULL node list only queries the location of
+     * the page and does not fault it in */
+    uintptr_t pagesize = (uintptr_t) sysconf(_SC_PAGESIZE);
+    void *page = (void *) ((uintptr_t) buf & ~(pagesize - 1));
+    int status = -1;
+    if (syscall(SYS_move_pages, 0, 1UL, &page, NULL, &status, 0) == 0 && status >= 0)
+        *node = status;
+
+  fn_exit:
+    return YAKSA_SUCCESS;
+}
+
+int yaksu_numa_bind_thread(int node)
+{
+    int rc = YAKSA_SUCCESS;
+
+    pthread_once(&numa_once, numa_discover);
+    if (numa_nnodes == 1 || node < 0 || node >= numa_nnodes)
+        goto fn_exit;
+
+    if (CPU_COUNT(&numa_cpusets[node]) == 0)
+        goto fn_exit;
+
+    int ret = sched_setaffinity(0, sizeof(cpu_set_t), &numa_cpusets[node]);
+    YAKSU_ERR_CHKANDJUMP(ret, rc, YAKSA_ERR__INTERNAL, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+int yaksu_numa_set_preferred_node(int node)
+{
+    int rc = YAKSA_SUCCESS;
+
+    pthread_once(&numa_once, numa_discover);
+    if (numa_nnodes == 1)
+        goto fn_exit;
+
+    /* a negative node restores the default policy of the thread */
+    long ret;
+    if (node < 0 || node >= numa_nnodes) {
+        ret = syscall(SYS_set_mempolicy, YAKSUI_MPOL_DEFAULT, NULL, 0UL);
+    } else {
+        unsigned long mask[1024 / (8 * sizeof(unsigned long))] = { 0 };
+        if (node >= 1024)
+            goto fn_exit;
+        mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+        ret = syscall(SYS_set_mempolicy, YAKSUI_MPOL_PREFERRED, mask, 1024UL);
+    }
+    YAKSU_ERR_CHKANDJUMP(ret, rc, YAKSA_ERR__INTERNAL, fn_fail);
+
+  fn_exit:
+    return rc;
+  fn_fail:
+    goto fn_exit;
+}
+
+#else
+
+int yaksu_numa_get_num_nodes(int *nnodes)
+{
+    *nnodes = 1;
+    return YAKSA_SUCCESS;
+}
+
+int yaksu_numa_get_node(const void *buf, int *node)
+{
+    *node = 0;
+    return YAKSA_SUCCESS;
+}
+
+int yaksu_numa_bind_thread(int node)
+{
+    return YAKSA_SUCCESS;
+}
+
+int yaksu_numa_set_preferred_node(int node)
+{
+    return YAKSA_SUCCESS;
+}
+
+#endif /* YAKSUI_NUMA_ENABLED */
@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#ifndef YAKSU_NUMA_H_INCLUDED
+#define YAKSU_NUMA_H_INCLUDED
+
+/* NUMA utilities.  When the platform does not expose the necessary
+ * system calls, the system is treated as a single node and all of
+ * the functions below become no-ops. */
+
+#define YAKSU_NUMA_NODE__UNKNOWN  (-1)
+
+int yaksu_numa_get_num_nodes(int *nnodes);
+int yaksu_numa_get_node(const void *buf, int *node);
+int yaksu_numa_bind_thread(int node);
+int yaksu_numa_set_preferred_node(int node);
+
+#endif /* YAKSU_NUMA_H_INCLUDED */
@@ -14,5 +14,6 @@ include $(top_srcdir)/test/simple/Makefile.mk
 include $(top_srcdir)/test/pack/Makefile.mk
 include $(top_srcdir)/test/iov/Makefile.mk
 include $(top_srcdir)/test/flatten/Makefile.mk
+include $(top_srcdir)/test/bench/Makefile.mk
 
 CLEANFILES = $(EXTRA_PROGRAMS)
@@ -0,0 +1,11 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+# benchmarks are built on demand and are not part of the testlists
+
+EXTRA_PROGRAMS += \
+	test/bench/numa_pack
+
+test_bench_numa_pack_CPPFLAGS = $(test_cppflags)
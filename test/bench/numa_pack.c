@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* Packs a strided buffer that lives on each NUMA node of the system
+ * from a thread bound to node 0, once on the calling thread and once
+ * through the asynchronous (NUMA-aware) workers, and reports the
+ * achieved bandwidth.  On a multi-node system, the synchronous
+ * numbers for remote nodes should be noticeably lower than the
+ * asynchronous ones. */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "yaksa.h"
+
+#define NODE_SYSFS "/sys/devices/system/node"
+
+static int get_num_nodes(void)
+{
+    int max_node = 0, start, end;
+    char sep;
+    FILE *fp = fopen(NODE_SYSFS "/online", "r");
+    if (fp == NULL)
+        return 1;
+
+    while (fscanf(fp, "%d", &start) == 1) {
+        end = start;
+        sep = (char) fgetc(fp);
+        if (sep == '-') {
+            if (fscanf(fp, "%d", &end) != 1)
+                break;
+            sep = (char) fgetc(fp);
+        }
+        if (end > max_node)
+            max_node = end;
+        if (sep != ',')
+            break;
+    }
+    fclose(fp);
+
+    return max_node + 1;
+}
+
+static void bind_to_node(int node)
+{
+    char path[128];
+    int start, end;
+    char sep;
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    snprintf(path, sizeof(path), NODE_SYSFS "/node%d/cpulist", node);
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+        return;
+
+    while (fscanf(fp, "%d", &start) == 1) {
+        end = start;
+        sep = (char) fgetc(fp);
+        if (sep == '-') {
+            if (fscanf(fp, "%d", &end) != 1)
+                break;
+            sep = (char) fgetc(fp);
+        }
+        for (int i = start; i <= end && i < CPU_SETSIZE; i++)
+            CPU_SET(i, &set);
+        if (sep != ',')
+            break;
+    }
+    fclose(fp);
+
+    if (CPU_COUNT(&set))
+        sched_setaffinity(0, sizeof(set), &set);
+}
+
+struct alloc_args {
+    int node;
+    size_t size;
+    char *buf;
+};
+
+/* allocate and first-touch the buffer from a thread bound to the
+ * target node, so its pages are placed there */
+static void *alloc_fn(void *arg)
+{
+    struct alloc_args *args = (struct alloc_args *) arg;
+
+    bind_to_node(args->node);
+    args->buf = (char *) malloc(args->size);
+    assert(args->buf);
+    memset(args->buf, args->node + 1, args->size);
+
+    return NULL;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double run_pack(const char *sbuf, char *dbuf, uintptr_t count, yaksa_type_t type,
+                       uintptr_t size, yaksa_info_t info, int iters)
+{
+    double start = now();
+
+    for (int i = 0; i < iters; i++) {
+        uintptr_t actual;
+        yaksa_request_t request;
+
+        int rc = yaksa_ipack(sbuf, count, type, 0, dbuf, size, &actual, info, &request);
+        assert(rc == YAKSA_SUCCESS);
+        assert(actual == size);
+
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+    }
+
+    return (double) size * iters / (now() - start) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    int rc;
+    size_t size_mb = 256;
+    int iters = 10;
+
+    while (--argc && ++argv) {
+        if (!strcmp(*argv, "-size")) {
+            --argc;
+            ++argv;
+            size_mb = atol(*argv);
+        } else if (!strcmp(*argv, "-iters")) {
+            --argc;
+            ++argv;
+            iters = atoi(*argv);
+        } else {
+            fprintf(stderr, "Usage: ./numa_pack {options}\n");
+            fprintf(stderr, "   -size    size of the source buffer in MB\n");
+            fprintf(stderr, "   -iters   number of iterations\n");
+            exit(1);
+        }
+    }
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    /* pack every other pair of doubles */
+    yaksa_type_t vector;
+    size_t extent = 4 * sizeof(double);
+    uintptr_t count = size_mb * 1024 * 1024 / extent;
+    rc = yaksa_type_create_vector(1, 2, 4, YAKSA_TYPE__DOUBLE, &vector);
+    assert(rc == YAKSA_SUCCESS);
+
+    yaksa_type_t resized;
+    rc = yaksa_type_create_resized(vector, 0, extent, &resized);
+    assert(rc == YAKSA_SUCCESS);
+
+    uintptr_t size;
+    rc = yaksa_type_get_size(resized, &size);
+    assert(rc == YAKSA_SUCCESS);
+    size *= count;
+
+    yaksa_info_t async_info;
+    rc = yaksa_info_create(&async_info);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(async_info, "yaksa_seq_async_threshold", (const void *) 0,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+
+    int nnodes = get_num_nodes();
+    bind_to_node(0);
+
+    char *dbuf = (char *) malloc(size);
+    assert(dbuf);
+    memset(dbuf, 0, size);
+
+    printf("%-8s %-10s %-10s\n", "# node", "sync GB/s", "async GB/s");
+    for (int node = 0; node < nnodes; node++) {
+        struct alloc_args args = { node, count * extent, NULL };
+        pthread_t thread;
+
+        pthread_create(&thread, NULL, alloc_fn, &args);
+        pthread_join(thread, NULL);
+
+        /* warm up both paths once */
+        run_pack(args.buf, dbuf, count, resized, size, NULL, 1);
+        run_pack(args.buf, dbuf, count, resized, size, async_info, 1);
+
+        double sync_bw = run_pack(args.buf, dbuf, count, resized, size, NULL, iters);
+        double async_bw = run_pack(args.buf, dbuf, count, resized, size, async_info, iters);
+        printf("%-8d %-10.2f %-10.2f\n", node, sync_bw, async_bw);
+
+        free(args.buf);
+    }
+
+    free(dbuf);
+    yaksa_info_free(async_info);
+    yaksa_type_free(resized);
+    yaksa_type_free(vector);
+
+    yaksa_finalize();
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+##
+## Copyright (C) by Argonne National Laboratory
+##     See COPYRIGHT in top-level directory
+##
+
+hostgpu_pack_testlists = $(top_srcdir)/test/pack/testlist.hostgpu.d-d-d.gen \
+	$(top_srcdir)/test/pack/testlist.hostgpu.d-rh-d.gen \
+	$(top_srcdir)/test/pack/testlist.hostgpu.d-urh-d.gen \
+	$(top_srcdir)/test/pack/testlist.hostgpu.rh-d-rh.gen \
+	$(top_srcdir)/test/pack/testlist.hostgpu.urh-d-urh.gen \
+	$(top_srcdir)/test/pack/testlist.hostgpu.md-stride.d-d-d.gen \
+	$(top_srcdir)/test/pack/testlist.hostgpu.md.urh-d-urh.threads.gen
+
+pack_testlists += $(hostgpu_pack_testlists)
+EXTRA_DIST += $(hostgpu_pack_testlists)
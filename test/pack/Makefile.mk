@@ -3,8 +3,13 @@
 ##     See COPYRIGHT in top-level directory
 ##
 
-pack_testlists = $(top_srcdir)/test/pack/testlist.gen $(top_srcdir)/test/pack/testlist.threads.gen
-EXTRA_DIST += $(top_srcdir)/test/pack/testlist.gen
+pack_testlists = $(top_srcdir)/test/pack/testlist.gen $(top_srcdir)/test/pack/testlist.threads.gen \
+	$(top_srcdir)/test/pack/testlist.async.gen $(top_srcdir)/test/pack/testlist.streams.gen \
+	$(top_srcdir)/test/pack/testlist.deps.gen $(top_srcdir)/test/pack/testlist.blocking.gen \
+	$(top_srcdir)/test/pack/testlist.counter.gen
+EXTRA_DIST += $(top_srcdir)/test/pack/testlist.gen $(top_srcdir)/test/pack/testlist.async.gen \
+	$(top_srcdir)/test/pack/testlist.streams.gen $(top_srcdir)/test/pack/testlist.deps.gen \
+	$(top_srcdir)/test/pack/testlist.blocking.gen $(top_srcdir)/test/pack/testlist.counter.gen
 
 EXTRA_PROGRAMS += \
 	test/pack/pack
@@ -15,6 +20,10 @@ if BUILD_CUDA_TESTS
 include $(top_srcdir)/test/pack/Makefile.cuda.mk
 endif BUILD_CUDA_TESTS
 
+if BUILD_HOSTGPU_TESTS
+include $(top_srcdir)/test/pack/Makefile.hostgpu.mk
+endif BUILD_HOSTGPU_TESTS
+
 testlists += $(pack_testlists)
 
 test-pack:
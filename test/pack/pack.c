@@ -59,7 +59,7 @@ typedef enum {
     MEM_TYPE__DEVICE,
 } mem_type_e;
 
-#ifdef HAVE_CUDA
+#if defined(HAVE_CUDA) || defined(HAVE_HOSTGPU)
 static int ndevices = -1;
 #endif
 static int device_id = 0;
@@ -71,6 +71,9 @@ static void init_devices(void)
     cudaGetDeviceCount(&ndevices);
     assert(ndevices != -1);
     cudaSetDevice(device_id);
+#elif defined(HAVE_HOSTGPU)
+    yaksa_hostgpu_get_num_devices(&ndevices);
+    assert(ndevices > 0);
 #endif
 }
 
@@ -92,6 +95,17 @@ static void alloc_mem(size_t size, mem_type_e type, void **hostbuf, void **devic
             cudaMallocHost(hostbuf, size);
         device_id += device_stride;
         device_id %= ndevices;
+#elif defined(HAVE_HOSTGPU)
+    } else if (type == MEM_TYPE__REGISTERED_HOST) {
+        yaksa_hostgpu_malloc_host(size, devicebuf);
+        if (hostbuf)
+            *hostbuf = *devicebuf;
+    } else if (type == MEM_TYPE__DEVICE) {
+        yaksa_hostgpu_malloc(size, device_id, devicebuf);
+        if (hostbuf)
+            *hostbuf = malloc(size);
+        device_id += device_stride;
+        device_id %= ndevices;
 #endif
     } else {
         fprintf(stderr, "ERROR: unsupported memory type\n");
@@ -111,6 +125,12 @@ static void free_mem(mem_type_e type, void *hostbuf, void *devicebuf)
         if (hostbuf) {
             cudaFreeHost(hostbuf);
         }
+#elif defined(HAVE_HOSTGPU)
+    } else if (type == MEM_TYPE__REGISTERED_HOST) {
+        yaksa_hostgpu_free(devicebuf);
+    } else if (type == MEM_TYPE__DEVICE) {
+        yaksa_hostgpu_free(devicebuf);
+        free(hostbuf);
 #endif
     }
 }
@@ -121,6 +141,10 @@ static void copy_content(const void *sbuf, void *dbuf, size_t size, mem_type_e t
     if (type == MEM_TYPE__DEVICE) {
         cudaMemcpy(dbuf, sbuf, size, cudaMemcpyDefault);
     }
+#elif defined(HAVE_HOSTGPU)
+    if (type == MEM_TYPE__DEVICE) {
+        memcpy(dbuf, sbuf, size);
+    }
 #endif
 }
 
@@ -136,6 +160,12 @@ mem_type_e sbuf_memtype = MEM_TYPE__UNREGISTERED_HOST;
 mem_type_e dbuf_memtype = MEM_TYPE__UNREGISTERED_HOST;
 mem_type_e tbuf_memtype = MEM_TYPE__UNREGISTERED_HOST;
 DTP_pool_s *dtp;
+yaksa_info_t *pup_info = NULL;
+int use_dependency = 0;
+int use_blocking = 0;
+int use_counter = 0;
+int use_streams = 0;
+yaksa_stream_t *streams = NULL;
 
 void *runtest(void *arg);
 void *runtest(void *arg)
@@ -279,26 +309,94 @@ void *runtest(void *arg)
 
         for (int j = 0; j < segments; j++) {
             uintptr_t actual_pack_bytes;
-            yaksa_request_t request;
+            yaksa_request_t pack_request, request;
+
+            if (use_blocking) {
+                uintptr_t actual_unpack_bytes;
+
+                rc = yaksa_pack(sbuf_d + sobj.DTP_buf_offset, sobj.DTP_type_count,
+                                sobj.DTP_datatype, segment_starts[j], tbuf, segment_lengths[j],
+                                &actual_pack_bytes, pup_info[tid]);
+                assert(rc == YAKSA_SUCCESS);
+                assert(actual_pack_bytes <= segment_lengths[j]);
+
+                rc = yaksa_unpack(tbuf, actual_pack_bytes, dbuf_d + dobj.DTP_buf_offset,
+                                  dobj.DTP_type_count, dobj.DTP_datatype, segment_starts[j],
+                                  &actual_unpack_bytes, pup_info[tid]);
+                assert(rc == YAKSA_SUCCESS);
+                assert(actual_pack_bytes == actual_unpack_bytes);
+                continue;
+            }
+
+            if (use_counter) {
+                yaksa_stream_t stream = use_streams ? streams[tid] : YAKSA_STREAM__DEFAULT;
+                yaksa_counter_t counter = 2;
+                uintptr_t actual_unpack_bytes;
+
+                rc = yaksa_ipack_counter(sbuf_d + sobj.DTP_buf_offset, sobj.DTP_type_count,
+                                         sobj.DTP_datatype, segment_starts[j], tbuf,
+                                         segment_lengths[j], &actual_pack_bytes, pup_info[tid],
+                                         &counter);
+                assert(rc == YAKSA_SUCCESS);
+                assert(actual_pack_bytes <= segment_lengths[j]);
+
+                while (__atomic_load_n(&counter, __ATOMIC_ACQUIRE) > 1) {
+                    rc = yaksa_stream_progress(stream);
+                    assert(rc == YAKSA_SUCCESS);
+                }
+
+                rc = yaksa_iunpack_counter(tbuf, actual_pack_bytes, dbuf_d + dobj.DTP_buf_offset,
+                                           dobj.DTP_type_count, dobj.DTP_datatype,
+                                           segment_starts[j], &actual_unpack_bytes, pup_info[tid],
+                                           &counter);
+                assert(rc == YAKSA_SUCCESS);
+
+                while (__atomic_load_n(&counter, __ATOMIC_ACQUIRE)) {
+                    rc = yaksa_stream_progress(stream);
+                    assert(rc == YAKSA_SUCCESS);
+                }
+
+                assert(actual_pack_bytes == actual_unpack_bytes);
+                continue;
+            }
 
             rc = yaksa_ipack(sbuf_d + sobj.DTP_buf_offset, sobj.DTP_type_count, sobj.DTP_datatype,
                              segment_starts[j], tbuf, segment_lengths[j], &actual_pack_bytes,
-                             NULL, &request);
+                             pup_info[tid], &pack_request);
             assert(rc == YAKSA_SUCCESS);
             assert(actual_pack_bytes <= segment_lengths[j]);
 
-            rc = yaksa_request_wait(request);
-            assert(rc == YAKSA_SUCCESS);
+            if (use_dependency) {
+                /* let yaksa start the unpack once the pack completes */
+                rc = yaksa_info_keyval_append(pup_info[tid], "yaksa_dependency",
+                                              (const void *) (uintptr_t) pack_request,
+                                              sizeof(uintptr_t));
+                assert(rc == YAKSA_SUCCESS);
+            } else {
+                rc = yaksa_request_wait(pack_request);
+                assert(rc == YAKSA_SUCCESS);
+            }
 
             uintptr_t actual_unpack_bytes;
             rc = yaksa_iunpack(tbuf, actual_pack_bytes, dbuf_d + dobj.DTP_buf_offset,
                                dobj.DTP_type_count, dobj.DTP_datatype, segment_starts[j],
-                               &actual_unpack_bytes, NULL, &request);
+                               &actual_unpack_bytes, pup_info[tid], &request);
             assert(rc == YAKSA_SUCCESS);
-            assert(actual_pack_bytes == actual_unpack_bytes);
 
             rc = yaksa_request_wait(request);
             assert(rc == YAKSA_SUCCESS);
+
+            if (use_dependency) {
+                rc = yaksa_request_wait(pack_request);
+                assert(rc == YAKSA_SUCCESS);
+
+                rc = yaksa_info_keyval_append(pup_info[tid], "yaksa_dependency",
+                                              (const void *) (uintptr_t) YAKSA_REQUEST__NULL,
+                                              sizeof(uintptr_t));
+                assert(rc == YAKSA_SUCCESS);
+            }
+
+            assert(actual_pack_bytes == actual_unpack_bytes);
         }
 
         copy_content(dbuf_d, dbuf_h, dobj.DTP_bufsize, dbuf_memtype);
@@ -324,6 +422,7 @@ void *runtest(void *arg)
 int main(int argc, char **argv)
 {
     int num_threads = 1;
+    intptr_t async_threshold = -1;
 
     while (--argc && ++argv) {
         if (!strcmp(*argv, "-datatype")) {
@@ -425,13 +524,26 @@ int main(int argc, char **argv)
             --argc;
             ++argv;
             num_threads = atoi(*argv);
+        } else if (!strcmp(*argv, "-async-threshold")) {
+            --argc;
+            ++argv;
+            async_threshold = atol(*argv);
+        } else if (!strcmp(*argv, "-streams")) {
+            use_streams = 1;
+        } else if (!strcmp(*argv, "-dependency")) {
+            use_dependency = 1;
+        } else if (!strcmp(*argv, "-blocking")) {
+            use_blocking = 1;
+        } else if (!strcmp(*argv, "-counter")) {
+            use_counter = 1;
         } else {
             fprintf(stderr, "unknown argument %s\n", *argv);
             exit(1);
         }
     }
     if (strlen(typestr) == 0 || basecount <= 0 || seed < 0 || iters <= 0 || max_segments < 0 ||
-        pack_order == PACK_ORDER__UNSET || overlap < 0 || num_threads <= 0) {
+        pack_order == PACK_ORDER__UNSET || overlap < 0 || num_threads <= 0 ||
+        use_blocking + use_dependency + use_counter > 1) {
         fprintf(stderr, "Usage: ./pack {options}\n");
         fprintf(stderr, "   -datatype    base datatype to use, e.g., int\n");
         fprintf(stderr, "   -count       number of base datatypes in the signature\n");
@@ -447,12 +559,52 @@ int main(int argc, char **argv)
         fprintf(stderr, "   -device-stride    difference between consecutive device allocations\n");
         fprintf(stderr, "   -verbose     verbose output\n");
         fprintf(stderr, "   -num-threads number of threads to spawn\n");
+        fprintf(stderr, "   -async-threshold  pack/unpack size above which host copies are async\n");
+        fprintf(stderr, "   -streams     use a separate stream for each thread\n");
+        fprintf(stderr, "   -dependency  make each unpack depend on its pack\n");
+        fprintf(stderr, "   -blocking    use blocking pack/unpack (host buffers are hinted)\n");
+        fprintf(stderr, "   -counter     use pack/unpack with completion counters\n");
         exit(1);
     }
 
     yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
     init_devices();
 
+    pup_info = (yaksa_info_t *) malloc(num_threads * sizeof(yaksa_info_t));
+    streams = (yaksa_stream_t *) malloc(num_threads * sizeof(yaksa_stream_t));
+    for (uintptr_t i = 0; i < num_threads; i++) {
+        pup_info[i] = NULL;
+        if (async_threshold < 0 && !use_streams && !use_dependency && !use_blocking)
+            continue;
+
+        int rc = yaksa_info_create(&pup_info[i]);
+        assert(rc == YAKSA_SUCCESS);
+
+        if (async_threshold >= 0) {
+            rc = yaksa_info_keyval_append(pup_info[i], "yaksa_seq_async_threshold",
+                                          (const void *) (uintptr_t) async_threshold,
+                                          sizeof(uintptr_t));
+            assert(rc == YAKSA_SUCCESS);
+        }
+
+        if (use_blocking && sbuf_memtype != MEM_TYPE__DEVICE &&
+            dbuf_memtype != MEM_TYPE__DEVICE && tbuf_memtype != MEM_TYPE__DEVICE) {
+            rc = yaksa_info_keyval_append(pup_info[i], "yaksa_host_buffers", (const void *) 1,
+                                          sizeof(uintptr_t));
+            assert(rc == YAKSA_SUCCESS);
+        }
+
+        if (use_streams) {
+            rc = yaksa_stream_create(&streams[i]);
+            assert(rc == YAKSA_SUCCESS);
+
+            rc = yaksa_info_keyval_append(pup_info[i], "yaksa_stream",
+                                          (const void *) (uintptr_t) streams[i],
+                                          sizeof(uintptr_t));
+            assert(rc == YAKSA_SUCCESS);
+        }
+    }
+
     dtp = (DTP_pool_s *) malloc(num_threads * sizeof(DTP_pool_s));
     for (uintptr_t i = 0; i < num_threads; i++) {
         int rc = DTP_pool_create(typestr, basecount, seed + i, &dtp[i]);
@@ -475,6 +627,20 @@ int main(int argc, char **argv)
     }
     free(dtp);
 
+    for (uintptr_t i = 0; i < num_threads; i++) {
+        if (pup_info[i]) {
+            int rc = yaksa_info_free(pup_info[i]);
+            assert(rc == YAKSA_SUCCESS);
+        }
+
+        if (use_streams) {
+            int rc = yaksa_stream_free(streams[i]);
+            assert(rc == YAKSA_SUCCESS);
+        }
+    }
+    free(streams);
+    free(pup_info);
+
     yaksa_finalize();
 
     return 0;
@@ -8,10 +8,40 @@ EXTRA_DIST += $(top_srcdir)/test/simple/testlist.gen
 
 EXTRA_PROGRAMS += \
 	test/simple/simple_test \
-	test/simple/threaded_test
+	test/simple/threaded_test \
+	test/simple/pack_iov_test \
+	test/simple/batch_test \
+	test/simple/plan_test \
+	test/simple/request_list_test \
+	test/simple/callback_test \
+	test/simple/hostgpu_test \
+	test/simple/large_type_test \
+	test/simple/buffer_unregister_test \
+	test/simple/staging_test \
+	test/simple/progress_thread_test \
+	test/simple/lazy_gpu_init_test \
+	test/simple/flatten_compact_test \
+	test/simple/unflatten_cache_test \
+	test/simple/flatten_shared_test \
+	test/simple/type_library_test
 
 test_simple_simple_test_CPPFLAGS = $(test_cppflags)
 test_simple_threaded_test_CPPFLAGS = $(test_cppflags)
+test_simple_pack_iov_test_CPPFLAGS = $(test_cppflags)
+test_simple_batch_test_CPPFLAGS = $(test_cppflags)
+test_simple_plan_test_CPPFLAGS = $(test_cppflags)
+test_simple_request_list_test_CPPFLAGS = $(test_cppflags)
+test_simple_callback_test_CPPFLAGS = $(test_cppflags)
+test_simple_hostgpu_test_CPPFLAGS = $(test_cppflags)
+test_simple_large_type_test_CPPFLAGS = $(test_cppflags)
+test_simple_buffer_unregister_test_CPPFLAGS = $(test_cppflags)
+test_simple_staging_test_CPPFLAGS = $(test_cppflags)
+test_simple_progress_thread_test_CPPFLAGS = $(test_cppflags)
+test_simple_lazy_gpu_init_test_CPPFLAGS = $(test_cppflags)
+test_simple_flatten_compact_test_CPPFLAGS = $(test_cppflags)
+test_simple_unflatten_cache_test_CPPFLAGS = $(test_cppflags)
+test_simple_flatten_shared_test_CPPFLAGS = $(test_cppflags)
+test_simple_type_library_test_CPPFLAGS = $(test_cppflags)
 
 test-simple:
 	@$(top_srcdir)/test/runtests.py --summary=$(top_builddir)/test/simple/summary.junit.xml \
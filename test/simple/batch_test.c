@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* packs the 26 boundary regions (faces, edges and corners) of a 3D
+ * array in a single batch, and compares the result with packing each
+ * region separately */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define N        (24)
+#define NREGIONS (26)
+
+static int check_batch(yaksa_batch_desc_t * descs, const char *ref, uintptr_t total,
+                       const double *sbuf, yaksa_info_t info)
+{
+    int errs = 0;
+    int rc;
+    uintptr_t actual;
+    yaksa_request_t request;
+    char *packbuf = (char *) malloc(total);
+    double *dbuf = (double *) calloc(N * N * N, sizeof(double));
+    assert(packbuf && dbuf);
+
+    rc = yaksa_ipack_batch(descs, NREGIONS, packbuf, &actual, info, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == total);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    if (memcmp(packbuf, ref, total)) {
+        fprintf(stderr, "batch pack does not match the individual packs\n");
+        errs++;
+    }
+
+    /* unpack into a clean array; the boundary should match the
+     * source and the interior should be untouched */
+    for (int i = 0; i < NREGIONS; i++)
+        descs[i].buf = dbuf;
+
+    rc = yaksa_iunpack_batch(packbuf, descs, NREGIONS, &actual, info, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == total);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            for (int k = 0; k < N; k++) {
+                int idx = (i * N + j) * N + k;
+                int boundary = (i == 0 || i == N - 1 || j == 0 || j == N - 1 ||
+                                k == 0 || k == N - 1);
+                double expected = boundary ? sbuf[idx] : 0.0;
+                if (dbuf[idx] != expected) {
+                    if (errs < 10)
+                        fprintf(stderr, "mismatch at (%d, %d, %d): %f != %f\n", i, j, k,
+                                dbuf[idx], expected);
+                    errs++;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < NREGIONS; i++)
+        descs[i].buf = (void *) sbuf;
+
+    free(dbuf);
+    free(packbuf);
+
+    return errs;
+}
+
+int main()
+{
+    int rc = YAKSA_SUCCESS;
+    int errs = 0;
+    yaksa_type_t types[NREGIONS];
+    yaksa_batch_desc_t descs[NREGIONS];
+    uintptr_t sizes[NREGIONS];
+    double *sbuf;
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    sbuf = (double *) malloc(N * N * N * sizeof(double));
+    assert(sbuf);
+    for (int i = 0; i < N * N * N; i++)
+        sbuf[i] = (double) i;
+
+    /* each boundary region is a subarray whose extent in a dimension
+     * is either the low plane, the interior, or the high plane */
+    int array_of_sizes[3] = { N, N, N };
+    int nregions = 0;
+    for (int di = -1; di <= 1; di++) {
+        for (int dj = -1; dj <= 1; dj++) {
+            for (int dk = -1; dk <= 1; dk++) {
+                int d[3] = { di, dj, dk };
+                int subsizes[3], starts[3];
+
+                if (di == 0 && dj == 0 && dk == 0)
+                    continue;
+
+                for (int x = 0; x < 3; x++) {
+                    subsizes[x] = (d[x] == 0) ? N - 2 : 1;
+                    starts[x] = (d[x] == -1) ? 0 : (d[x] == 0) ? 1 : N - 1;
+                }
+
+                rc = yaksa_type_create_subarray(3, array_of_sizes, subsizes, starts,
+                                                YAKSA_SUBARRAY_ORDER__C, YAKSA_TYPE__DOUBLE,
+                                                &types[nregions]);
+                assert(rc == YAKSA_SUCCESS);
+
+                rc = yaksa_type_get_size(types[nregions], &sizes[nregions]);
+                assert(rc == YAKSA_SUCCESS);
+
+                descs[nregions].buf = sbuf;
+                descs[nregions].count = 1;
+                descs[nregions].type = types[nregions];
+                descs[nregions].offset = YAKSA_BATCH_OFFSET__NEXT;
+                nregions++;
+            }
+        }
+    }
+    assert(nregions == NREGIONS);
+
+    /* reference: pack each region separately */
+    uintptr_t total = 0;
+    for (int i = 0; i < NREGIONS; i++)
+        total += sizes[i];
+
+    char *ref = (char *) malloc(total);
+    assert(ref);
+
+    uintptr_t offset = 0;
+    for (int i = 0; i < NREGIONS; i++) {
+        uintptr_t actual;
+        yaksa_request_t request;
+
+        rc = yaksa_ipack(sbuf, 1, types[i], 0, ref + offset, sizes[i], &actual, NULL, &request);
+        assert(rc == YAKSA_SUCCESS);
+        assert(actual == sizes[i]);
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+
+        offset += sizes[i];
+    }
+
+    /* consecutive offsets, synchronously and through the async
+     * workers */
+    yaksa_info_t async_info;
+    rc = yaksa_info_create(&async_info);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(async_info, "yaksa_seq_async_threshold", (const void *) 0,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+
+    errs += check_batch(descs, ref, total, sbuf, NULL);
+    errs += check_batch(descs, ref, total, sbuf, async_info);
+
+    /* explicit offsets, with the descriptors in reverse order */
+    yaksa_batch_desc_t rdescs[NREGIONS];
+    offset = 0;
+    for (int i = 0; i < NREGIONS; i++) {
+        rdescs[NREGIONS - 1 - i] = descs[i];
+        rdescs[NREGIONS - 1 - i].offset = offset;
+        offset += sizes[i];
+    }
+
+    errs += check_batch(rdescs, ref, total, sbuf, NULL);
+    errs += check_batch(rdescs, ref, total, sbuf, async_info);
+
+    yaksa_info_free(async_info);
+    for (int i = 0; i < NREGIONS; i++)
+        yaksa_type_free(types[i]);
+    free(ref);
+    free(sbuf);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
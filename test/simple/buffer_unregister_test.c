@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* recycles memory between host and emulated device buffers, so the
+ * same addresses change their memory type while their classification
+ * is cached */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define COUNT   (64 * 1024)
+#define ROUNDS  (16)
+
+static int check(const int *buf, const char *what, int round)
+{
+    for (int i = 0; i < COUNT * 2; i++) {
+        int ref = (i % 2 == 0) ? (i + round) : 0;
+        if (buf[i] != ref) {
+            fprintf(stderr, "%s (round %d): mismatch at element %d\n", what, round, i);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    int rc;
+    int errs = 0;
+    int ndevices;
+    uintptr_t actual;
+    yaksa_request_t request;
+
+    setenv("YAKSA_ENV_HOSTGPU_P2P", "0", 1);
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    rc = yaksa_hostgpu_get_num_devices(&ndevices);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* every other integer */
+    yaksa_type_t vector, type;
+    rc = yaksa_type_create_vector(1, 1, 2, YAKSA_TYPE__INT, &vector);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_resized(vector, 0, 2 * sizeof(int), &type);
+    assert(rc == YAKSA_SUCCESS);
+
+    size_t bufsize = (size_t) COUNT * 2 * sizeof(int);
+    size_t packsize = (size_t) COUNT * sizeof(int);
+
+    for (int round = 0; round < ROUNDS && errs == 0; round++) {
+        int *sbuf, *dbuf, *tbuf;
+        int on_device = (ndevices > 0 && round % 2);
+
+        /* freed memory is usually handed out again, so the buffers of
+         * consecutive rounds tend to share their addresses */
+        if (on_device) {
+            rc = yaksa_hostgpu_malloc(bufsize, 0, (void **) &sbuf);
+            assert(rc == YAKSA_SUCCESS);
+            rc = yaksa_hostgpu_malloc(packsize, ndevices - 1, (void **) &tbuf);
+            assert(rc == YAKSA_SUCCESS);
+            rc = yaksa_hostgpu_malloc(bufsize, 0, (void **) &dbuf);
+            assert(rc == YAKSA_SUCCESS);
+        } else {
+            sbuf = (int *) malloc(bufsize);
+            tbuf = (int *) malloc(packsize);
+            dbuf = (int *) malloc(bufsize);
+        }
+
+        for (int i = 0; i < COUNT * 2; i++)
+            sbuf[i] = i + round;
+        memset(dbuf, 0, bufsize);
+
+        rc = yaksa_ipack(sbuf, COUNT, type, 0, tbuf, packsize, &actual, NULL, &request);
+        assert(rc == YAKSA_SUCCESS);
+        assert(actual == packsize);
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+
+        rc = yaksa_iunpack(tbuf, packsize, dbuf, COUNT, type, 0, &actual, NULL, &request);
+        assert(rc == YAKSA_SUCCESS);
+        assert(actual == packsize);
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+
+        errs += check(dbuf, on_device ? "device" : "host", round);
+
+        if (on_device) {
+            yaksa_hostgpu_free(dbuf);
+            yaksa_hostgpu_free(tbuf);
+            yaksa_hostgpu_free(sbuf);
+        } else {
+            /* plain host memory has to be unregistered by the user */
+            rc = yaksa_buffer_unregister(dbuf, bufsize);
+            assert(rc == YAKSA_SUCCESS);
+            rc = yaksa_buffer_unregister(tbuf, packsize);
+            assert(rc == YAKSA_SUCCESS);
+            rc = yaksa_buffer_unregister(sbuf, bufsize);
+            assert(rc == YAKSA_SUCCESS);
+
+            free(dbuf);
+            free(tbuf);
+            free(sbuf);
+        }
+    }
+
+    yaksa_type_free(type);
+    yaksa_type_free(vector);
+
+    yaksa_finalize();
+
+    /* buffers can also be unregistered after finalize */
+    rc = yaksa_buffer_unregister(&errs, sizeof(errs));
+    assert(rc == YAKSA_SUCCESS);
+
+    return errs ? 1 : 0;
+}
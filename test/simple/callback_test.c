@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* waits for asynchronous operations without polling, and chains
+ * unpacks to packs through completion callbacks */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define NREQS   (16)
+#define COUNT   (4096)
+
+static int sbuf[NREQS][COUNT * 4];
+static int tbuf[NREQS][COUNT * 2];
+static int dbuf[NREQS][COUNT * 4];
+
+static yaksa_type_t type;
+static yaksa_info_t info;
+static yaksa_counter_t counter;
+
+static void fill(void)
+{
+    for (int i = 0; i < NREQS; i++) {
+        for (int j = 0; j < COUNT * 4; j++)
+            sbuf[i][j] = i * COUNT * 4 + j;
+        memset(tbuf[i], 0, sizeof(tbuf[i]));
+        memset(dbuf[i], 0, sizeof(dbuf[i]));
+    }
+}
+
+static int check(void)
+{
+    int errs = 0;
+
+    for (int i = 0; i < NREQS; i++) {
+        for (int j = 0; j < COUNT * 4; j++) {
+            int ref = (j % 4 < 2) ? sbuf[i][j] : 0;
+            if (dbuf[i][j] != ref) {
+                fprintf(stderr, "buffer %d: mismatch at element %d\n", i, j);
+                errs++;
+                break;
+            }
+        }
+    }
+
+    return errs;
+}
+
+/* the pack of buffer i completed, so unpack it */
+static void unpack_cb(void *arg)
+{
+    int i = (int) (uintptr_t) arg;
+    uintptr_t actual;
+
+    int rc = yaksa_iunpack_counter(tbuf[i], sizeof(tbuf[i]), dbuf[i], COUNT, type, 0, &actual,
+                                   info, &counter);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == sizeof(tbuf[i]));
+}
+
+int main()
+{
+    int rc;
+    int errs = 0;
+    uintptr_t actual;
+    yaksa_request_t request;
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    /* two out of every four integers */
+    yaksa_type_t vector;
+    rc = yaksa_type_create_vector(1, 2, 4, YAKSA_TYPE__INT, &vector);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_resized(vector, 0, 4 * sizeof(int), &type);
+    assert(rc == YAKSA_SUCCESS);
+
+    rc = yaksa_info_create(&info);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(info, "yaksa_seq_async_threshold", (const void *) 0,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(info, "yaksa_blocking_wait", (const void *) 1,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+
+    /* blocking waits */
+    fill();
+    for (int i = 0; i < NREQS; i++) {
+        rc = yaksa_ipack(sbuf[i], COUNT, type, 0, tbuf[i], sizeof(tbuf[i]), &actual, info,
+                         &request);
+        assert(rc == YAKSA_SUCCESS);
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+
+        rc = yaksa_iunpack(tbuf[i], sizeof(tbuf[i]), dbuf[i], COUNT, type, 0, &actual, info,
+                           &request);
+        assert(rc == YAKSA_SUCCESS);
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+    }
+    errs += check();
+
+    /* chain the unpacks to the packs; requests that complete before
+     * the callback is set run it right away */
+    yaksa_info_t infos[] = { info, NULL };
+    for (int k = 0; k < sizeof(infos) / sizeof(infos[0]); k++) {
+        fill();
+        __atomic_store_n(&counter, NREQS, __ATOMIC_RELEASE);
+        for (int i = 0; i < NREQS; i++) {
+            rc = yaksa_ipack(sbuf[i], COUNT, type, 0, tbuf[i], sizeof(tbuf[i]), &actual,
+                             infos[k], &request);
+            assert(rc == YAKSA_SUCCESS);
+            rc = yaksa_request_set_callback(request, unpack_cb, (void *) (uintptr_t) i);
+            assert(rc == YAKSA_SUCCESS);
+        }
+
+        while (__atomic_load_n(&counter, __ATOMIC_ACQUIRE)) {
+            rc = yaksa_stream_progress(YAKSA_STREAM__DEFAULT);
+            assert(rc == YAKSA_SUCCESS);
+        }
+        errs += check();
+    }
+
+    yaksa_info_free(info);
+    yaksa_type_free(type);
+    yaksa_type_free(vector);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* flattens large index types and checks that the flattened form is
+ * compact, that the unflattened types move the same data, and that
+ * buffers from other versions of the format are rejected */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define REGULAR_COUNT    (1024 * 1024)
+#define IRREGULAR_COUNT  (128 * 1024)
+
+static int roundtrip(yaksa_type_t type, uintptr_t max_flattened_size, const char *what)
+{
+    int rc;
+    int errs = 0;
+    uintptr_t size, extent, actual;
+    intptr_t lb;
+
+    uintptr_t flattened_size, cached_size;
+    rc = yaksa_flatten_size(type, &flattened_size);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_flatten_size(type, &cached_size);
+    assert(rc == YAKSA_SUCCESS);
+    assert(cached_size == flattened_size);
+
+    if (flattened_size > max_flattened_size) {
+        fprintf(stderr, "%s: flattened to %zu bytes, more than %zu\n", what,
+                (size_t) flattened_size, (size_t) max_flattened_size);
+        errs++;
+    }
+
+    void *flatbuf = malloc(flattened_size);
+    rc = yaksa_flatten(type, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    yaksa_type_t newtype;
+    rc = yaksa_unflatten(&newtype, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* the new type flattens to the same bytes */
+    uintptr_t new_flattened_size;
+    rc = yaksa_flatten_size(newtype, &new_flattened_size);
+    assert(rc == YAKSA_SUCCESS);
+    assert(new_flattened_size == flattened_size);
+
+    void *newflatbuf = malloc(flattened_size);
+    rc = yaksa_flatten(newtype, newflatbuf);
+    assert(rc == YAKSA_SUCCESS);
+    if (memcmp(flatbuf, newflatbuf, flattened_size)) {
+        fprintf(stderr, "%s: the unflattened type flattens differently\n", what);
+        errs++;
+    }
+
+    /* pack with the original type and unpack with the new one */
+    rc = yaksa_type_get_size(type, &size);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_get_extent(type, &lb, &extent);
+    assert(rc == YAKSA_SUCCESS);
+    assert(lb == 0);
+
+    int *sbuf = (int *) malloc(extent);
+    int *dbuf = (int *) calloc(1, extent);
+    int *ref = (int *) calloc(1, extent);
+    char *tbuf = (char *) malloc(size);
+
+    for (uintptr_t i = 0; i < extent / sizeof(int); i++)
+        sbuf[i] = (int) i;
+
+    rc = yaksa_pack(sbuf, 1, type, 0, tbuf, size, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS && actual == size);
+    rc = yaksa_unpack(tbuf, size, ref, 1, type, 0, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS && actual == size);
+    rc = yaksa_unpack(tbuf, size, dbuf, 1, newtype, 0, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS && actual == size);
+
+    if (memcmp(dbuf, ref, extent)) {
+        fprintf(stderr, "%s: the unflattened type moves different data\n", what);
+        errs++;
+    }
+
+    free(tbuf);
+    free(ref);
+    free(dbuf);
+    free(sbuf);
+    free(newflatbuf);
+    free(flatbuf);
+
+    yaksa_type_free(newtype);
+
+    return errs;
+}
+
+int main()
+{
+    int rc;
+    int errs = 0;
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    int *blocklengths = (int *) malloc(REGULAR_COUNT * sizeof(int));
+    int *displs = (int *) malloc(REGULAR_COUNT * sizeof(int));
+
+    /* evenly spaced blocks, whose lengths change every 64K blocks:
+     * the regular pattern collapses into a few runs */
+    for (int i = 0; i < REGULAR_COUNT; i++) {
+        blocklengths[i] = 1 + (i / (64 * 1024)) % 2;
+        displs[i] = 3 * i;
+    }
+
+    yaksa_type_t regular;
+    rc = yaksa_type_create_indexed(REGULAR_COUNT, blocklengths, displs, YAKSA_TYPE__INT, &regular);
+    assert(rc == YAKSA_SUCCESS);
+    errs += roundtrip(regular, 1024, "regular");
+
+    /* sorted random displacements and random blocklengths cost a few
+     * bytes per block, instead of twelve */
+    srand(1);
+    int disp = 0;
+    for (int i = 0; i < IRREGULAR_COUNT; i++) {
+        blocklengths[i] = 1 + rand() % 8;
+        displs[i] = disp;
+        disp += blocklengths[i] + rand() % 16;
+    }
+
+    yaksa_type_t irregular;
+    rc = yaksa_type_create_indexed(IRREGULAR_COUNT, blocklengths, displs, YAKSA_TYPE__INT,
+                                   &irregular);
+    assert(rc == YAKSA_SUCCESS);
+    errs += roundtrip(irregular, 4 * IRREGULAR_COUNT, "irregular");
+
+    /* the arrays of structs are encoded the same way */
+    yaksa_type_t types[3] = { regular, irregular, YAKSA_TYPE__DOUBLE };
+    int struct_blocklengths[3] = { 1, 1, 4 };
+    intptr_t struct_displs[3] = { 0, 3 * REGULAR_COUNT * sizeof(int) + 64,
+        3 * REGULAR_COUNT * sizeof(int) + 64 + disp * sizeof(int)
+    };
+    yaksa_type_t str;
+    rc = yaksa_type_create_struct(3, struct_blocklengths, struct_displs, types, &str);
+    assert(rc == YAKSA_SUCCESS);
+    errs += roundtrip(str, 1024 + 4 * IRREGULAR_COUNT + 64, "struct");
+
+    /* other versions of the format are refused */
+    uintptr_t flattened_size;
+    rc = yaksa_flatten_size(regular, &flattened_size);
+    assert(rc == YAKSA_SUCCESS);
+    char *flatbuf = (char *) malloc(flattened_size);
+    rc = yaksa_flatten(regular, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+    /* the version byte follows the four magic bytes */
+    flatbuf[4]++;
+
+    yaksa_type_t newtype;
+    rc = yaksa_unflatten(&newtype, flatbuf);
+    if (rc != YAKSA_ERR__NOT_SUPPORTED) {
+        fprintf(stderr, "a different format version was accepted\n");
+        errs++;
+    }
+    free(flatbuf);
+
+    yaksa_type_free(str);
+    yaksa_type_free(irregular);
+    yaksa_type_free(regular);
+    free(displs);
+    free(blocklengths);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
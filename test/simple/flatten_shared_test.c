@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* flattens a type whose levels each use the type of the level below
+ * twice, and checks that the flattened form grows with the number of
+ * levels rather than with the size of the expanded tree, and that the
+ * unflattened type moves the same data */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define LEVELS              (16)
+#define MAX_BYTES_PER_LEVEL (64)
+
+int main()
+{
+    int rc;
+    int errs = 0;
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    /* every level is a struct of two copies of the level below, with a
+     * hole between them; the hvector at the bottom is shared by all
+     * 2^LEVELS leaves */
+    yaksa_type_t levels[LEVELS + 1];
+    rc = yaksa_type_create_hvector(2, 1, 2 * sizeof(int), YAKSA_TYPE__INT, &levels[0]);
+    assert(rc == YAKSA_SUCCESS);
+
+    for (int i = 1; i <= LEVELS; i++) {
+        intptr_t lb;
+        uintptr_t extent;
+        rc = yaksa_type_get_extent(levels[i - 1], &lb, &extent);
+        assert(rc == YAKSA_SUCCESS);
+
+        int blocklengths[2] = { 1, 1 };
+        intptr_t displs[2] = { 0, (intptr_t) extent + (intptr_t) sizeof(int) };
+        yaksa_type_t types[2] = { levels[i - 1], levels[i - 1] };
+        rc = yaksa_type_create_struct(2, blocklengths, displs, types, &levels[i]);
+        assert(rc == YAKSA_SUCCESS);
+    }
+
+    yaksa_type_t type = levels[LEVELS];
+
+    uintptr_t flattened_size;
+    rc = yaksa_flatten_size(type, &flattened_size);
+    assert(rc == YAKSA_SUCCESS);
+    if (flattened_size > MAX_BYTES_PER_LEVEL * (LEVELS + 1)) {
+        fprintf(stderr, "flattened to %zu bytes, more than %d\n", (size_t) flattened_size,
+                MAX_BYTES_PER_LEVEL * (LEVELS + 1));
+        errs++;
+    }
+
+    void *flatbuf = malloc(flattened_size);
+    rc = yaksa_flatten(type, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    yaksa_type_t newtype;
+    rc = yaksa_unflatten(&newtype, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* the unflattened type shares its levels the same way */
+    uintptr_t new_flattened_size;
+    rc = yaksa_flatten_size(newtype, &new_flattened_size);
+    assert(rc == YAKSA_SUCCESS);
+    void *newflatbuf = malloc(new_flattened_size);
+    rc = yaksa_flatten(newtype, newflatbuf);
+    assert(rc == YAKSA_SUCCESS);
+    if (new_flattened_size != flattened_size || memcmp(flatbuf, newflatbuf, flattened_size)) {
+        fprintf(stderr, "the unflattened type flattens differently\n");
+        errs++;
+    }
+
+    /* pack with the original type and unpack with the new one */
+    uintptr_t size, extent, actual;
+    intptr_t lb;
+    rc = yaksa_type_get_size(type, &size);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_get_extent(type, &lb, &extent);
+    assert(rc == YAKSA_SUCCESS);
+    assert(lb == 0);
+
+    int *sbuf = (int *) malloc(extent);
+    int *dbuf = (int *) calloc(1, extent);
+    int *ref = (int *) calloc(1, extent);
+    char *tbuf = (char *) malloc(size);
+
+    for (uintptr_t i = 0; i < extent / sizeof(int); i++)
+        sbuf[i] = (int) i;
+
+    rc = yaksa_pack(sbuf, 1, type, 0, tbuf, size, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS && actual == size);
+    rc = yaksa_unpack(tbuf, size, ref, 1, type, 0, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS && actual == size);
+    rc = yaksa_unpack(tbuf, size, dbuf, 1, newtype, 0, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS && actual == size);
+
+    if (memcmp(dbuf, ref, extent)) {
+        fprintf(stderr, "the unflattened type moves different data\n");
+        errs++;
+    }
+
+    free(tbuf);
+    free(ref);
+    free(dbuf);
+    free(sbuf);
+    free(newflatbuf);
+    free(flatbuf);
+
+    yaksa_type_free(newtype);
+    for (int i = 0; i <= LEVELS; i++)
+        yaksa_type_free(levels[i]);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* moves data between the host-emulated devices without peer-to-peer
+ * access and with an artificial copy cost, so every operation is
+ * staged through the host and spans several temporary buffers */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+/* larger than the temporary buffers of the progress engine */
+#define COUNT   (3 * 1024 * 1024)
+
+int main()
+{
+    int rc;
+    int errs = 0;
+    int ndevices;
+    uintptr_t actual;
+    yaksa_request_t request;
+
+    setenv("YAKSA_ENV_HOSTGPU_P2P", "0", 1);
+    setenv("YAKSA_ENV_HOSTGPU_LATENCY", "10", 1);
+    setenv("YAKSA_ENV_HOSTGPU_BANDWIDTH", "20000", 1);
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    rc = yaksa_hostgpu_get_num_devices(&ndevices);
+    assert(rc == YAKSA_SUCCESS);
+    if (ndevices < 2) {
+        /* the driver was not built or has too few devices */
+        yaksa_finalize();
+        return 0;
+    }
+
+    /* two out of every four integers */
+    yaksa_type_t vector, type;
+    rc = yaksa_type_create_vector(1, 2, 4, YAKSA_TYPE__INT, &vector);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_resized(vector, 0, 4 * sizeof(int), &type);
+    assert(rc == YAKSA_SUCCESS);
+
+    size_t bufsize = (size_t) COUNT * 4 * sizeof(int);
+    size_t packsize = (size_t) COUNT * 2 * sizeof(int);
+
+    int *hbuf = (int *) malloc(bufsize);
+    int *rbuf = (int *) malloc(bufsize);
+    int *sbuf, *tbuf, *dbuf;
+    rc = yaksa_hostgpu_malloc(bufsize, 0, (void **) &sbuf);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_hostgpu_malloc(packsize, 1, (void **) &tbuf);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_hostgpu_malloc(bufsize, 0, (void **) &dbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* the emulated devices live in host memory, so they can be
+     * initialized directly */
+    for (size_t i = 0; i < (size_t) COUNT * 4; i++)
+        sbuf[i] = (int) i;
+    memset(dbuf, 0, bufsize);
+
+    /* device 0 to device 1 */
+    rc = yaksa_ipack(sbuf, COUNT, type, 0, tbuf, packsize, &actual, NULL, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == packsize);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* device 1 back to device 0 */
+    rc = yaksa_iunpack(tbuf, packsize, dbuf, COUNT, type, 0, &actual, NULL, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == packsize);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    for (size_t i = 0; i < (size_t) COUNT * 4; i++) {
+        int ref = (i % 4 < 2) ? (int) i : 0;
+        if (dbuf[i] != ref) {
+            fprintf(stderr, "device to device: mismatch at element %zu\n", i);
+            errs++;
+            break;
+        }
+    }
+
+    /* device 1 to an unregistered host buffer and back */
+    memset(hbuf, 0, bufsize);
+    memset(rbuf, 0, bufsize);
+    rc = yaksa_iunpack(tbuf, packsize, hbuf, COUNT, type, 0, &actual, NULL, &request);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    memset(tbuf, 0, packsize);
+    rc = yaksa_ipack(hbuf, COUNT, type, 0, tbuf, packsize, &actual, NULL, &request);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    rc = yaksa_iunpack(tbuf, packsize, rbuf, COUNT, type, 0, &actual, NULL, &request);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    for (size_t i = 0; i < (size_t) COUNT * 4; i++) {
+        int ref = (i % 4 < 2) ? (int) i : 0;
+        if (rbuf[i] != ref) {
+            fprintf(stderr, "device to host: mismatch at element %zu\n", i);
+            errs++;
+            break;
+        }
+    }
+
+    yaksa_hostgpu_free(dbuf);
+    yaksa_hostgpu_free(tbuf);
+    yaksa_hostgpu_free(sbuf);
+    free(rbuf);
+    free(hbuf);
+    yaksa_type_free(type);
+    yaksa_type_free(vector);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* moves single elements that are larger than the temporary buffers of
+ * the progress engine between the host and the host-emulated devices,
+ * so each element is staged in several pieces */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+static int check(const int *buf, size_t nints, const int *ref, const char *what)
+{
+    for (size_t i = 0; i < nints; i++) {
+        if (buf[i] != ref[i]) {
+            fprintf(stderr, "%s: mismatch at integer %zu\n", what, i);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int roundtrip(yaksa_type_t type, const char *what)
+{
+    int rc;
+    int errs = 0;
+    uintptr_t actual;
+    uintptr_t size, extent;
+    intptr_t lb;
+    yaksa_request_t request;
+
+    rc = yaksa_type_get_size(type, &size);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_get_extent(type, &lb, &extent);
+    assert(rc == YAKSA_SUCCESS);
+    assert(lb == 0);
+
+    size_t nints = (size_t) extent / sizeof(int);
+    int *sbuf, *dbuf;
+    int *hbuf = (int *) malloc(extent);
+    int *ref = (int *) malloc(extent);
+    int *tbuf = (int *) malloc(size);
+    rc = yaksa_hostgpu_malloc(extent, 0, (void **) &sbuf);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_hostgpu_malloc(extent, 0, (void **) &dbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    for (size_t i = 0; i < nints; i++)
+        hbuf[i] = (int) i;
+
+    /* the reference keeps the integers that the type selects, moved
+     * entirely on the host */
+    rc = yaksa_pack(hbuf, 1, type, 0, tbuf, size, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS);
+    memset(ref, 0, extent);
+    rc = yaksa_unpack(tbuf, size, ref, 1, type, 0, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* the emulated devices live in host memory, so they can be
+     * initialized directly */
+    memcpy(sbuf, hbuf, extent);
+    memset(dbuf, 0, extent);
+    memset(tbuf, 0, size);
+
+    /* device to host */
+    rc = yaksa_ipack(sbuf, 1, type, 0, tbuf, size, &actual, NULL, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == size);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* host back to device */
+    rc = yaksa_iunpack(tbuf, size, dbuf, 1, type, 0, &actual, NULL, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == size);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    errs += check(dbuf, nints, ref, what);
+
+    yaksa_hostgpu_free(dbuf);
+    yaksa_hostgpu_free(sbuf);
+    free(tbuf);
+    free(ref);
+    free(hbuf);
+
+    return errs;
+}
+
+int main()
+{
+    int rc;
+    int errs = 0;
+    int ndevices;
+
+    setenv("YAKSA_ENV_HOSTGPU_P2P", "0", 1);
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    rc = yaksa_hostgpu_get_num_devices(&ndevices);
+    assert(rc == YAKSA_SUCCESS);
+    if (ndevices < 1) {
+        /* the driver was not built */
+        yaksa_finalize();
+        return 0;
+    }
+
+    /* many small blocks, which are gathered into pieces */
+    yaksa_type_t small_blocks;
+    rc = yaksa_type_create_vector(5 * 1024 * 1024 + 3, 1, 2, YAKSA_TYPE__INT, &small_blocks);
+    assert(rc == YAKSA_SUCCESS);
+    errs += roundtrip(small_blocks, "small blocks");
+
+    /* a few blocks, each of which is larger than a piece */
+    yaksa_type_t large_blocks;
+    rc = yaksa_type_create_vector(5, 1024 * 1024 + 5, 1024 * 1024 + 64, YAKSA_TYPE__INT,
+                                  &large_blocks);
+    assert(rc == YAKSA_SUCCESS);
+    errs += roundtrip(large_blocks, "large blocks");
+
+    /* blocks of different sizes and types */
+    yaksa_type_t sparse;
+    rc = yaksa_type_create_vector(1024 * 1024, 1, 2, YAKSA_TYPE__INT, &sparse);
+    assert(rc == YAKSA_SUCCESS);
+
+    int blocklengths[3] = { 1024, 5 * 1024 * 1024, 2 };
+    intptr_t displs[3] = { 0, 8192, 8192 + 24 * 1024 * 1024 };
+    yaksa_type_t types[3] = { YAKSA_TYPE__INT, YAKSA_TYPE__INT, sparse };
+    yaksa_type_t mixed;
+    rc = yaksa_type_create_struct(3, blocklengths, displs, types, &mixed);
+    assert(rc == YAKSA_SUCCESS);
+    errs += roundtrip(mixed, "struct");
+
+    yaksa_type_free(mixed);
+    yaksa_type_free(sparse);
+    yaksa_type_free(large_blocks);
+    yaksa_type_free(small_blocks);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* checks that the host-emulated devices are only set up by the first
+ * operation on device memory, once even if several threads race for
+ * it, and in yaksa_init when the application asks for it.  Each
+ * emulated device runs a worker thread, so the setup shows in the
+ * number of threads of the process. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define NTHREADS  (4)
+#define COUNT     (1024)
+
+static int *dbufs[NTHREADS];
+static int *tbufs[NTHREADS];
+static yaksa_type_t type;
+
+/* returns -1 where the threads of the process cannot be listed */
+static int count_threads(void)
+{
+    DIR *dir = opendir("/proc/self/task");
+    struct dirent *entry;
+    int nthreads = 0;
+
+    if (dir == NULL)
+        return -1;
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.')
+            nthreads++;
+    }
+    closedir(dir);
+
+    return nthreads;
+}
+
+static int host_pack(void)
+{
+    int rc;
+    int sbuf[2 * COUNT], tbuf[COUNT];
+    uintptr_t actual;
+
+    for (int i = 0; i < 2 * COUNT; i++)
+        sbuf[i] = i;
+
+    rc = yaksa_pack(sbuf, COUNT, type, 0, tbuf, sizeof(tbuf), &actual, NULL);
+    assert(rc == YAKSA_SUCCESS);
+
+    for (int i = 0; i < COUNT; i++) {
+        if (tbuf[i] != 2 * i) {
+            fprintf(stderr, "host pack: mismatch at element %d\n", i);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void *device_pack(void *arg)
+{
+    int rc;
+    uintptr_t tid = (uintptr_t) arg;
+    uintptr_t actual;
+    yaksa_request_t request;
+
+    rc = yaksa_ipack(dbufs[tid], COUNT, type, 0, tbufs[tid], COUNT * sizeof(int), &actual, NULL,
+                     &request);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    return NULL;
+}
+
+static void create_type(void)
+{
+    int rc;
+    yaksa_type_t vector;
+
+    /* every other integer */
+    rc = yaksa_type_create_vector(1, 1, 2, YAKSA_TYPE__INT, &vector);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_resized(vector, 0, 2 * sizeof(int), &type);
+    assert(rc == YAKSA_SUCCESS);
+    yaksa_type_free(vector);
+}
+
+int main()
+{
+    int rc;
+    int errs = 0;
+    int ndevices;
+
+    if (count_threads() < 0)
+        return 0;
+
+    /* host-only work does not start the devices */
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    rc = yaksa_hostgpu_get_num_devices(&ndevices);
+    assert(rc == YAKSA_SUCCESS);
+    if (ndevices < 1) {
+        /* the driver was not built */
+        yaksa_finalize();
+        return 0;
+    }
+
+    create_type();
+    errs += host_pack();
+
+    /* allocating device memory only registers it */
+    for (uintptr_t i = 0; i < NTHREADS; i++) {
+        rc = yaksa_hostgpu_malloc(2 * COUNT * sizeof(int), 0, (void **) &dbufs[i]);
+        assert(rc == YAKSA_SUCCESS);
+        rc = yaksa_hostgpu_malloc(COUNT * sizeof(int), 0, (void **) &tbufs[i]);
+        assert(rc == YAKSA_SUCCESS);
+        for (int j = 0; j < 2 * COUNT; j++)
+            dbufs[i][j] = j;
+    }
+
+    int lazy_threads = count_threads();
+
+    /* the first operations on device memory race to set the devices
+     * up */
+    pthread_t threads[NTHREADS];
+    for (uintptr_t i = 0; i < NTHREADS; i++)
+        pthread_create(&threads[i], NULL, device_pack, (void *) i);
+    for (int i = 0; i < NTHREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    int active_threads = count_threads();
+    if (active_threads - lazy_threads != ndevices) {
+        fprintf(stderr, "%d threads before the first device operation, %d after, %d devices\n",
+                lazy_threads, active_threads, ndevices);
+        errs++;
+    }
+
+    for (int i = 0; i < NTHREADS; i++) {
+        for (int j = 0; j < COUNT && errs == 0; j++) {
+            if (tbufs[i][j] != 2 * j) {
+                fprintf(stderr, "device pack: mismatch at element %d of thread %d\n", j, i);
+                errs++;
+            }
+        }
+        yaksa_hostgpu_free(tbufs[i]);
+        yaksa_hostgpu_free(dbufs[i]);
+    }
+
+    yaksa_type_free(type);
+    yaksa_finalize();
+
+    /* the application can ask for the devices upfront */
+    yaksa_init_attr_t attr = YAKSA_INIT_ATTR__DEFAULT;
+    attr.eager_gpu_init = 1;
+    yaksa_init(attr);
+
+    int eager_threads = count_threads();
+    if (eager_threads != active_threads) {
+        fprintf(stderr, "%d threads after an eager yaksa_init, %d expected\n", eager_threads,
+                active_threads);
+        errs++;
+    }
+
+    create_type();
+    errs += host_pack();
+    yaksa_type_free(type);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define ARRSIZE (128 * 1024)
+#define COUNT   (3)
+#define MAX_IOV_LEN  (4)
+#define TMPBUF_SIZE  (64)
+
+typedef struct {
+    char a[ARRSIZE];
+    int x;
+    double y;
+    char b[ARRSIZE];
+    int z;
+} mixed_s;
+
+int main()
+{
+    int rc = YAKSA_SUCCESS;
+    int errs = 0;
+    yaksa_type_t type;
+    mixed_s *inbuf;
+    char *packbuf, *iovbuf;
+    uintptr_t size, actual;
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    int blocklengths[5] = { ARRSIZE, 1, 1, ARRSIZE, 1 };
+    intptr_t displs[5] = { offsetof(mixed_s, a), offsetof(mixed_s, x), offsetof(mixed_s, y),
+        offsetof(mixed_s, b), offsetof(mixed_s, z)
+    };
+    yaksa_type_t types[5] = { YAKSA_TYPE__CHAR, YAKSA_TYPE__INT, YAKSA_TYPE__DOUBLE,
+        YAKSA_TYPE__CHAR, YAKSA_TYPE__INT
+    };
+
+    rc = yaksa_type_create_struct(5, blocklengths, displs, types, &type);
+    assert(rc == YAKSA_SUCCESS);
+
+    rc = yaksa_type_get_size(type, &size);
+    assert(rc == YAKSA_SUCCESS);
+
+    inbuf = (mixed_s *) malloc(COUNT * sizeof(mixed_s));
+    packbuf = (char *) malloc(COUNT * size);
+    iovbuf = (char *) malloc(COUNT * size);
+    assert(inbuf && packbuf && iovbuf);
+
+    for (int i = 0; i < COUNT; i++) {
+        for (int j = 0; j < ARRSIZE; j++) {
+            inbuf[i].a[j] = (char) (i + j);
+            inbuf[i].b[j] = (char) (i * j);
+        }
+        inbuf[i].x = i;
+        inbuf[i].y = (double) i / 2;
+        inbuf[i].z = -i;
+    }
+
+    yaksa_request_t request;
+    rc = yaksa_ipack(inbuf, COUNT, type, 0, packbuf, COUNT * size, &actual, NULL, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == COUNT * size);
+
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* build the hybrid iov in small steps, so we exercise both the
+     * iov limit and the staging buffer limit, and gather the result */
+    uintptr_t iov_offset = 0, iov_len;
+    uintptr_t num_segments = 0, num_inplace = 0, gathered = 0;
+    rc = yaksa_iov_len(COUNT, type, &iov_len);
+    assert(rc == YAKSA_SUCCESS);
+
+    while (iov_offset < iov_len) {
+        struct iovec iov[MAX_IOV_LEN];
+        char tmpbuf[TMPBUF_SIZE];
+        uintptr_t actual_iov_len, actual_tmpbuf_bytes, actual_segments;
+
+        rc = yaksa_pack_iov(inbuf, COUNT, type, iov_offset, tmpbuf, TMPBUF_SIZE, iov,
+                            MAX_IOV_LEN, &actual_iov_len, &actual_tmpbuf_bytes,
+                            &actual_segments, NULL);
+        assert(rc == YAKSA_SUCCESS);
+        assert(actual_segments > 0);
+
+        for (uintptr_t i = 0; i < actual_iov_len; i++) {
+            char *base = (char *) iov[i].iov_base;
+            if (base >= (char *) inbuf && base < (char *) (inbuf + COUNT)) {
+                num_inplace++;
+            } else if (base < tmpbuf || base + iov[i].iov_len > tmpbuf + actual_tmpbuf_bytes) {
+                fprintf(stderr, "iov[%d] points neither to the input nor the staging buffer\n",
+                        (int) i);
+                errs++;
+            }
+
+            memcpy(iovbuf + gathered, base, iov[i].iov_len);
+            gathered += iov[i].iov_len;
+        }
+
+        num_segments += actual_segments;
+        iov_offset += actual_segments;
+    }
+
+    if (num_segments != iov_len) {
+        fprintf(stderr, "consumed %d segments instead of %d\n", (int) num_segments, (int) iov_len);
+        errs++;
+    }
+
+    if (num_inplace != 2 * COUNT) {
+        fprintf(stderr, "%d segments were referenced in place instead of %d\n",
+                (int) num_inplace, 2 * COUNT);
+        errs++;
+    }
+
+    if (gathered != actual || memcmp(packbuf, iovbuf, actual)) {
+        fprintf(stderr, "hybrid iov does not match the packed buffer\n");
+        errs++;
+    }
+
+    free(iovbuf);
+    free(packbuf);
+    free(inbuf);
+
+    yaksa_type_free(type);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
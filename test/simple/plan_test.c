@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* executes pack and unpack plans several times, with the buffer
+ * contents changing between executions, and compares the results with
+ * regular pack/unpack operations */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define COUNT   (64)
+#define NITERS  (4)
+
+static int test_plan(yaksa_type_t type, uintptr_t count, yaksa_info_t info)
+{
+    int rc;
+    int errs = 0;
+    uintptr_t size, actual;
+    intptr_t lb;
+    uintptr_t extent;
+    yaksa_request_t request;
+    yaksa_pack_plan_t pack_plan, unpack_plan;
+
+    rc = yaksa_type_get_size(type, &size);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_get_extent(type, &lb, &extent);
+    assert(rc == YAKSA_SUCCESS);
+
+    uintptr_t buflen = extent * count;
+    char *sbuf = (char *) malloc(buflen);
+    char *dbuf = (char *) malloc(buflen);
+    char *refbuf = (char *) malloc(buflen);
+    char *packbuf = (char *) malloc(size * count);
+    char *refpackbuf = (char *) malloc(size * count);
+    assert(sbuf && dbuf && refbuf && packbuf && refpackbuf);
+
+    rc = yaksa_pack_plan_create(YAKSA_PACK_PLAN_OP__PACK, sbuf, packbuf, count, type, info,
+                                &pack_plan);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_pack_plan_create(YAKSA_PACK_PLAN_OP__UNPACK, packbuf, dbuf, count, type, info,
+                                &unpack_plan);
+    assert(rc == YAKSA_SUCCESS);
+
+    for (int iter = 0; iter < NITERS; iter++) {
+        for (uintptr_t i = 0; i < buflen; i++)
+            sbuf[i] = (char) (i * (iter + 1));
+        memset(dbuf, 0, buflen);
+        memset(refbuf, 0, buflen);
+
+        rc = yaksa_pack_plan_execute(pack_plan, &request);
+        assert(rc == YAKSA_SUCCESS);
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+
+        rc = yaksa_ipack(sbuf, count, type, 0, refpackbuf, size * count, &actual, NULL,
+                         &request);
+        assert(rc == YAKSA_SUCCESS);
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+
+        if (memcmp(packbuf, refpackbuf, size * count)) {
+            fprintf(stderr, "pack plan mismatch in iteration %d\n", iter);
+            errs++;
+        }
+
+        rc = yaksa_pack_plan_execute(unpack_plan, &request);
+        assert(rc == YAKSA_SUCCESS);
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+
+        rc = yaksa_iunpack(refpackbuf, size * count, refbuf, count, type, 0, &actual, NULL,
+                           &request);
+        assert(rc == YAKSA_SUCCESS);
+        rc = yaksa_request_wait(request);
+        assert(rc == YAKSA_SUCCESS);
+
+        if (memcmp(dbuf, refbuf, buflen)) {
+            fprintf(stderr, "unpack plan mismatch in iteration %d\n", iter);
+            errs++;
+        }
+    }
+
+    rc = yaksa_pack_plan_free(pack_plan);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_pack_plan_free(unpack_plan);
+    assert(rc == YAKSA_SUCCESS);
+
+    free(refpackbuf);
+    free(packbuf);
+    free(refbuf);
+    free(dbuf);
+    free(sbuf);
+
+    return errs;
+}
+
+int main()
+{
+    int rc = YAKSA_SUCCESS;
+    int errs = 0;
+    yaksa_type_t contig, vector, wide_vector, many_vector;
+    yaksa_info_t iov_info, async_info;
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    rc = yaksa_type_create_contig(16, YAKSA_TYPE__INT, &contig);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_vector(8, 3, 5, YAKSA_TYPE__INT, &vector);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_vector(4, 1024, 2048, YAKSA_TYPE__CHAR, &wide_vector);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_vector(1024, 16, 32, YAKSA_TYPE__CHAR, &many_vector);
+    assert(rc == YAKSA_SUCCESS);
+
+    rc = yaksa_info_create(&iov_info);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(iov_info, "yaksa_seq_iov_pack_threshold", (const void *) 8,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(iov_info, "yaksa_seq_iov_unpack_threshold", (const void *) 8,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+
+    rc = yaksa_info_create(&async_info);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(async_info, "yaksa_seq_async_threshold", (const void *) 0,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+
+    yaksa_type_t types[] = { contig, vector, wide_vector, many_vector };
+    yaksa_info_t infos[] = { NULL, iov_info, async_info };
+    for (int i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+        for (int j = 0; j < sizeof(infos) / sizeof(infos[0]); j++)
+            errs += test_plan(types[i], COUNT, infos[j]);
+
+    /* empty plans */
+    errs += test_plan(vector, 0, NULL);
+
+    yaksa_info_free(async_info);
+    yaksa_info_free(iov_info);
+    yaksa_type_free(many_vector);
+    yaksa_type_free(wide_vector);
+    yaksa_type_free(vector);
+    yaksa_type_free(contig);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
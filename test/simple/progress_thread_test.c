@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* stages operations between the host-emulated devices and
+ * unregistered host memory with the progress thread enabled, and
+ * checks that they finish without being tested or waited on */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define COUNT    (1024 * 1024)
+#define TIMEOUT  (60)
+
+static volatile int *last_elem;
+
+/* the "computation" of the application, which never calls into
+ * yaksa */
+static int compute_until_done(int ref)
+{
+    time_t start = time(NULL);
+
+    while (*last_elem != ref) {
+        if (time(NULL) - start > TIMEOUT) {
+            fprintf(stderr, "the operation did not progress on its own\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int run(yaksa_init_attr_t attr, int blocking_wait)
+{
+    int rc;
+    int errs = 0;
+    int ndevices;
+    uintptr_t actual;
+    yaksa_request_t request;
+    yaksa_info_t info = NULL;
+
+    yaksa_init(attr);
+
+    rc = yaksa_hostgpu_get_num_devices(&ndevices);
+    assert(rc == YAKSA_SUCCESS);
+    if (ndevices < 1) {
+        /* the driver was not built */
+        yaksa_finalize();
+        return 0;
+    }
+
+    if (blocking_wait) {
+        rc = yaksa_info_create(&info);
+        assert(rc == YAKSA_SUCCESS);
+        rc = yaksa_info_keyval_append(info, "yaksa_blocking_wait", (const void *) (uintptr_t) 1,
+                                      sizeof(uintptr_t));
+        assert(rc == YAKSA_SUCCESS);
+    }
+
+    /* every other integer */
+    yaksa_type_t vector, type;
+    rc = yaksa_type_create_vector(1, 1, 2, YAKSA_TYPE__INT, &vector);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_resized(vector, 0, 2 * sizeof(int), &type);
+    assert(rc == YAKSA_SUCCESS);
+
+    size_t bufsize = (size_t) COUNT * 2 * sizeof(int);
+    size_t packsize = (size_t) COUNT * sizeof(int);
+
+    int *tbuf = (int *) malloc(packsize);
+    int *sbuf, *dbuf;
+    rc = yaksa_hostgpu_malloc(bufsize, 0, (void **) &sbuf);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_hostgpu_malloc(bufsize, 0, (void **) &dbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* the emulated devices live in host memory, so they can be
+     * initialized and checked directly */
+    for (int i = 0; i < COUNT * 2; i++)
+        sbuf[i] = i;
+    memset(dbuf, 0, bufsize);
+    memset(tbuf, 0, packsize);
+
+    /* device to host; the staging buffers are much smaller than the
+     * data, so the pipeline has to be driven until the end */
+    rc = yaksa_ipack(sbuf, COUNT, type, 0, tbuf, packsize, &actual, info, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == packsize);
+
+    last_elem = &tbuf[COUNT - 1];
+    errs += compute_until_done(2 * (COUNT - 1));
+
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* host back to device */
+    rc = yaksa_iunpack(tbuf, packsize, dbuf, COUNT, type, 0, &actual, info, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == packsize);
+
+    last_elem = &dbuf[2 * (COUNT - 1)];
+    errs += compute_until_done(2 * (COUNT - 1));
+
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    for (int i = 0; i < COUNT * 2 && errs == 0; i++) {
+        int ref = (i % 2 == 0) ? i : 0;
+        if (dbuf[i] != ref) {
+            fprintf(stderr, "mismatch at element %d\n", i);
+            errs++;
+        }
+    }
+
+    if (info)
+        yaksa_info_free(info);
+
+    yaksa_hostgpu_free(dbuf);
+    yaksa_hostgpu_free(sbuf);
+    free(tbuf);
+
+    yaksa_type_free(type);
+    yaksa_type_free(vector);
+
+    yaksa_finalize();
+
+    return errs;
+}
+
+int main()
+{
+    int errs = 0;
+
+    setenv("YAKSA_ENV_HOSTGPU_P2P", "0", 1);
+    setenv("YAKSA_ENV_HOSTGPU_LATENCY", "100", 1);
+
+    yaksa_init_attr_t attr = YAKSA_INIT_ATTR__DEFAULT;
+    attr.staging_device_buffer_size = 256 * 1024;
+    attr.staging_host_buffer_size = 256 * 1024;
+    attr.progress_thread = 1;
+
+    /* the thread polls */
+    errs += run(attr, 0);
+
+    /* the thread sleeps between passes and is bound to a CPU, and the
+     * waits sleep as well */
+    attr.progress_thread_cpu = 0;
+    attr.progress_thread_interval_us = 50;
+    errs += run(attr, 1);
+
+    return errs ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* issues many pack operations at once, a few of them depending on
+ * earlier ones, and drains them with testsome, testany and waitall */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define NREQS   (64)
+#define COUNT   (256)
+
+static char sbuf[NREQS][COUNT * 4 * sizeof(int)];
+static char dbuf[NREQS][COUNT * 2 * sizeof(int)];
+
+static void fill(void)
+{
+    for (int i = 0; i < NREQS; i++) {
+        for (uintptr_t j = 0; j < sizeof(sbuf[i]); j++)
+            sbuf[i][j] = (char) (i + j);
+        memset(dbuf[i], 0, sizeof(dbuf[i]));
+    }
+}
+
+static void issue(yaksa_type_t type, yaksa_info_t info, yaksa_info_t dep_info,
+                  yaksa_request_t * requests)
+{
+    int rc;
+    uintptr_t actual;
+
+    for (int i = 0; i < NREQS; i++) {
+        /* every fourth request depends on the one before it */
+        yaksa_info_t pup_info = info;
+        if (i % 4 == 3 && requests[i - 1] != YAKSA_REQUEST__NULL) {
+            rc = yaksa_info_keyval_append(dep_info, "yaksa_dependency",
+                                          (const void *) (uintptr_t) requests[i - 1],
+                                          sizeof(uintptr_t));
+            assert(rc == YAKSA_SUCCESS);
+            pup_info = dep_info;
+        }
+
+        rc = yaksa_ipack(sbuf[i], COUNT, type, 0, dbuf[i], sizeof(dbuf[i]), &actual, pup_info,
+                         &requests[i]);
+        assert(rc == YAKSA_SUCCESS);
+        assert(actual == sizeof(dbuf[i]));
+    }
+}
+
+static int check(void)
+{
+    int errs = 0;
+
+    for (int i = 0; i < NREQS; i++) {
+        for (uintptr_t j = 0; j < COUNT * 2; j++) {
+            int val, ref;
+            memcpy(&val, dbuf[i] + j * sizeof(int), sizeof(int));
+            memcpy(&ref, sbuf[i] + (j / 2 * 4 + j % 2) * sizeof(int), sizeof(int));
+            if (val != ref) {
+                fprintf(stderr, "request %d: mismatch at element %d\n", i, (int) j);
+                errs++;
+                break;
+            }
+        }
+    }
+
+    return errs;
+}
+
+static int all_null(const yaksa_request_t * requests)
+{
+    for (int i = 0; i < NREQS; i++)
+        if (requests[i] != YAKSA_REQUEST__NULL)
+            return 0;
+    return 1;
+}
+
+int main()
+{
+    int rc;
+    int errs = 0;
+    yaksa_type_t vector;
+    yaksa_info_t async_info, dep_info;
+    yaksa_request_t requests[NREQS];
+    int indices[NREQS];
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    /* two out of every four integers */
+    yaksa_type_t resized;
+    rc = yaksa_type_create_vector(1, 2, 4, YAKSA_TYPE__INT, &vector);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_resized(vector, 0, 4 * sizeof(int), &resized);
+    assert(rc == YAKSA_SUCCESS);
+
+    rc = yaksa_info_create(&async_info);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(async_info, "yaksa_seq_async_threshold", (const void *) 0,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+
+    rc = yaksa_info_create(&dep_info);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(dep_info, "yaksa_seq_async_threshold", (const void *) 0,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+
+    yaksa_info_t infos[] = { NULL, async_info };
+    for (int k = 0; k < sizeof(infos) / sizeof(infos[0]); k++) {
+        /* testsome */
+        fill();
+        issue(resized, infos[k], dep_info, requests);
+        int ncompleted = 0;
+        while (ncompleted < NREQS) {
+            int outcount;
+            rc = yaksa_request_testsome(NREQS, requests, &outcount, indices);
+            assert(rc == YAKSA_SUCCESS);
+            for (int i = 0; i < outcount; i++)
+                assert(requests[indices[i]] == YAKSA_REQUEST__NULL);
+            ncompleted += outcount;
+            /* requests that completed at issue time are never reported */
+            if (outcount == 0 && all_null(requests))
+                break;
+        }
+        assert(all_null(requests));
+        errs += check();
+
+        /* testany */
+        fill();
+        issue(resized, infos[k], dep_info, requests);
+        while (1) {
+            int index, completed;
+            rc = yaksa_request_testany(NREQS, requests, &index, &completed);
+            assert(rc == YAKSA_SUCCESS);
+            if (completed && index == -1)
+                break;
+            if (completed)
+                assert(requests[index] == YAKSA_REQUEST__NULL);
+        }
+        assert(all_null(requests));
+        errs += check();
+
+        /* waitall */
+        fill();
+        issue(resized, infos[k], dep_info, requests);
+        rc = yaksa_request_waitall(NREQS, requests);
+        assert(rc == YAKSA_SUCCESS);
+        assert(all_null(requests));
+        errs += check();
+    }
+
+    yaksa_info_free(dep_info);
+    yaksa_info_free(async_info);
+    yaksa_type_free(resized);
+    yaksa_type_free(vector);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* stages operations between the host-emulated devices and
+ * unregistered host memory through small temporary buffers, with the
+ * pipeline tuned through the init attributes and the info keys */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define COUNT         (1024 * 1024)
+#define DEPTH         (3)
+#define CHUNK_SIZE    (64 * 1024)
+
+static int roundtrip(const int *sbuf, int *tbuf, int *dbuf, yaksa_type_t type, yaksa_info_t info)
+{
+    int rc;
+    uintptr_t actual;
+    yaksa_request_t request;
+    size_t packsize = (size_t) COUNT * sizeof(int);
+
+    memset(tbuf, 0, packsize);
+    memset(dbuf, 0, packsize * 2);
+
+    /* device to host */
+    rc = yaksa_ipack(sbuf, COUNT, type, 0, tbuf, packsize, &actual, info, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == packsize);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* host back to device */
+    rc = yaksa_iunpack(tbuf, packsize, dbuf, COUNT, type, 0, &actual, info, &request);
+    assert(rc == YAKSA_SUCCESS);
+    assert(actual == packsize);
+    rc = yaksa_request_wait(request);
+    assert(rc == YAKSA_SUCCESS);
+
+    for (int i = 0; i < COUNT * 2; i++) {
+        int ref = (i % 2 == 0) ? i : 0;
+        if (dbuf[i] != ref) {
+            fprintf(stderr, "mismatch at element %d\n", i);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    int rc;
+    int errs = 0;
+    int ndevices;
+    yaksa_stats_t stats;
+
+    setenv("YAKSA_ENV_HOSTGPU_P2P", "0", 1);
+    setenv("YAKSA_ENV_HOSTGPU_LATENCY", "100", 1);
+
+    yaksa_init_attr_t attr = YAKSA_INIT_ATTR__DEFAULT;
+    attr.staging_device_buffer_size = 1024 * 1024;
+    attr.staging_host_buffer_size = 1024 * 1024;
+    attr.staging_depth = DEPTH;
+    yaksa_init(attr);
+
+    rc = yaksa_hostgpu_get_num_devices(&ndevices);
+    assert(rc == YAKSA_SUCCESS);
+    if (ndevices < 1) {
+        /* the driver was not built */
+        yaksa_finalize();
+        return 0;
+    }
+
+    /* every other integer */
+    yaksa_type_t vector, type;
+    rc = yaksa_type_create_vector(1, 1, 2, YAKSA_TYPE__INT, &vector);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_resized(vector, 0, 2 * sizeof(int), &type);
+    assert(rc == YAKSA_SUCCESS);
+
+    size_t bufsize = (size_t) COUNT * 2 * sizeof(int);
+    size_t packsize = (size_t) COUNT * sizeof(int);
+
+    int *tbuf = (int *) malloc(packsize);
+    int *sbuf, *dbuf;
+    rc = yaksa_hostgpu_malloc(bufsize, 0, (void **) &sbuf);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_hostgpu_malloc(bufsize, 0, (void **) &dbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* the emulated devices live in host memory, so they can be
+     * initialized directly */
+    for (int i = 0; i < COUNT * 2; i++)
+        sbuf[i] = i;
+
+    /* with the init attributes, several subops of an operation are in
+     * flight at once, but never more than the requested depth */
+    errs += roundtrip(sbuf, tbuf, dbuf, type, NULL);
+
+    rc = yaksa_stats_get(&stats);
+    assert(rc == YAKSA_SUCCESS);
+    if (stats.staged_subops == 0 || stats.staged_overlapped_subops == 0 ||
+        stats.staged_max_depth < 2 || stats.staged_max_depth > DEPTH) {
+        fprintf(stderr, "unexpected pipeline: %llu subops, %llu overlapped, depth %llu\n",
+                (unsigned long long) stats.staged_subops,
+                (unsigned long long) stats.staged_overlapped_subops,
+                (unsigned long long) stats.staged_max_depth);
+        errs++;
+    }
+
+    /* the info keys override the chunk size for single operations */
+    yaksa_info_t info;
+    rc = yaksa_info_create(&info);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(info, "yaksa_staging_chunk_size",
+                                  (const void *) (uintptr_t) CHUNK_SIZE, sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_info_keyval_append(info, "yaksa_staging_depth", (const void *) (uintptr_t) 1,
+                                  sizeof(uintptr_t));
+    assert(rc == YAKSA_SUCCESS);
+
+    uint64_t subops = stats.staged_subops;
+    errs += roundtrip(sbuf, tbuf, dbuf, type, info);
+
+    rc = yaksa_stats_get(&stats);
+    assert(rc == YAKSA_SUCCESS);
+    if (stats.staged_subops - subops < 2 * packsize / CHUNK_SIZE) {
+        fprintf(stderr, "only %llu subops with %d-byte chunks\n",
+                (unsigned long long) (stats.staged_subops - subops), CHUNK_SIZE);
+        errs++;
+    }
+
+    yaksa_info_free(info);
+
+    yaksa_hostgpu_free(dbuf);
+    yaksa_hostgpu_free(sbuf);
+    free(tbuf);
+
+    yaksa_type_free(type);
+    yaksa_type_free(vector);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* writes large index types to a type library, maps it, and checks
+ * that the types from the library, whose arrays live in the mapped
+ * file, move the same data as the originals; also checks that
+ * compact flattened types can be unflattened in borrowed mode and
+ * outlive their buffer */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define COUNT      (64 * 1024)
+#define NUM_TYPES  (3)
+
+static int compare(yaksa_type_t type, yaksa_type_t newtype, const char *what)
+{
+    int rc;
+    int errs = 0;
+    uintptr_t size, extent, actual;
+    intptr_t lb;
+
+    /* the new type flattens to the same bytes */
+    uintptr_t flattened_size, new_flattened_size;
+    rc = yaksa_flatten_size(type, &flattened_size);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_flatten_size(newtype, &new_flattened_size);
+    assert(rc == YAKSA_SUCCESS);
+
+    void *flatbuf = malloc(flattened_size);
+    void *newflatbuf = malloc(new_flattened_size);
+    rc = yaksa_flatten(type, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_flatten(newtype, newflatbuf);
+    assert(rc == YAKSA_SUCCESS);
+    if (new_flattened_size != flattened_size || memcmp(flatbuf, newflatbuf, flattened_size)) {
+        fprintf(stderr, "%s: the new type flattens differently\n", what);
+        errs++;
+    }
+    free(newflatbuf);
+    free(flatbuf);
+
+    /* pack with the original type and unpack with the new one */
+    rc = yaksa_type_get_size(type, &size);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_get_extent(type, &lb, &extent);
+    assert(rc == YAKSA_SUCCESS);
+    assert(lb == 0);
+
+    int *sbuf = (int *) malloc(extent);
+    int *dbuf = (int *) calloc(1, extent);
+    int *ref = (int *) calloc(1, extent);
+    char *tbuf = (char *) malloc(size);
+
+    for (uintptr_t i = 0; i < extent / sizeof(int); i++)
+        sbuf[i] = (int) i;
+
+    rc = yaksa_pack(sbuf, 1, type, 0, tbuf, size, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS && actual == size);
+    rc = yaksa_unpack(tbuf, size, ref, 1, type, 0, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS && actual == size);
+    rc = yaksa_unpack(tbuf, size, dbuf, 1, newtype, 0, &actual, NULL);
+    assert(rc == YAKSA_SUCCESS && actual == size);
+
+    if (memcmp(dbuf, ref, extent)) {
+        fprintf(stderr, "%s: the new type moves different data\n", what);
+        errs++;
+    }
+
+    free(tbuf);
+    free(ref);
+    free(dbuf);
+    free(sbuf);
+
+    return errs;
+}
+
+int main()
+{
+    int rc;
+    int errs = 0;
+    yaksa_type_t types[NUM_TYPES];
+
+    yaksa_init(YAKSA_INIT_ATTR__DEFAULT);
+
+    int *blocklengths = (int *) malloc(COUNT * sizeof(int));
+    int *displs = (int *) malloc(COUNT * sizeof(int));
+
+    srand(1);
+    int disp = 0;
+    for (int i = 0; i < COUNT; i++) {
+        blocklengths[i] = 1 + rand() % 8;
+        displs[i] = disp;
+        disp += blocklengths[i] + rand() % 16;
+    }
+
+    rc = yaksa_type_create_indexed(COUNT, blocklengths, displs, YAKSA_TYPE__INT, &types[0]);
+    assert(rc == YAKSA_SUCCESS);
+    rc = yaksa_type_create_indexed_block(COUNT, 2, displs, YAKSA_TYPE__INT, &types[1]);
+    assert(rc == YAKSA_SUCCESS);
+
+    int struct_blocklengths[2] = { 1, 1 };
+    intptr_t struct_displs[2] = { 0, (disp + 16) * sizeof(int) };
+    yaksa_type_t struct_types[2] = { types[0], types[1] };
+    rc = yaksa_type_create_struct(2, struct_blocklengths, struct_displs, struct_types,
+                                  &types[2]);
+    assert(rc == YAKSA_SUCCESS);
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/yaksa_type_library_test.%d", (int) getpid());
+
+    rc = yaksa_type_library_write(path, NUM_TYPES, types);
+    assert(rc == YAKSA_SUCCESS);
+
+    yaksa_type_library_t library;
+    int count;
+    rc = yaksa_type_library_open(path, &library, &count);
+    assert(rc == YAKSA_SUCCESS);
+    assert(count == NUM_TYPES);
+
+    /* the mapping keeps the file alive */
+    unlink(path);
+
+    for (int i = 0; i < NUM_TYPES; i++) {
+        char what[32];
+        snprintf(what, sizeof(what), "library type %d", i);
+
+        yaksa_type_t newtype;
+        rc = yaksa_type_library_get(library, i, &newtype);
+        assert(rc == YAKSA_SUCCESS);
+        errs += compare(types[i], newtype, what);
+        yaksa_type_free(newtype);
+    }
+
+    rc = yaksa_type_library_close(library);
+    assert(rc == YAKSA_SUCCESS);
+
+    /* compact arrays are copied, so the type outlives the buffer */
+    uintptr_t flattened_size;
+    rc = yaksa_flatten_size(types[2], &flattened_size);
+    assert(rc == YAKSA_SUCCESS);
+    void *flatbuf = malloc(flattened_size);
+    rc = yaksa_flatten(types[2], flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    yaksa_type_t newtype;
+    rc = yaksa_unflatten_borrowed(&newtype, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+    memset(flatbuf, 0, flattened_size);
+    free(flatbuf);
+
+    errs += compare(types[2], newtype, "borrowed compact type");
+    yaksa_type_free(newtype);
+
+    for (int i = 0; i < NUM_TYPES; i++)
+        yaksa_type_free(types[i]);
+    free(displs);
+    free(blocklengths);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) by Argonne National Laboratory
+ *     See COPYRIGHT in top-level directory
+ */
+
+/* unflattens the same flattened types repeatedly with the unflatten
+ * cache enabled, and checks that identical flattened types yield the
+ * same type, and that the least recently used type is evicted when
+ * the cache is full */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaksa.h"
+#include <assert.h>
+
+#define CACHE_SIZE  (4096)
+#define COUNT       (3000)
+
+/* irregular blocks, so the flattened type takes about a byte per
+ * block: one type fits into the cache, but two do not */
+static void *create_flattened(unsigned int seed, uintptr_t * flattened_size)
+{
+    int rc;
+    int *blocklengths = (int *) malloc(COUNT * sizeof(int));
+    int *displs = (int *) malloc(COUNT * sizeof(int));
+
+    srand(seed);
+    int disp = 0;
+    for (int i = 0; i < COUNT; i++) {
+        blocklengths[i] = 1;
+        displs[i] = disp;
+        disp += 1 + rand() % 8;
+    }
+
+    yaksa_type_t type;
+    rc = yaksa_type_create_indexed(COUNT, blocklengths, displs, YAKSA_TYPE__INT, &type);
+    assert(rc == YAKSA_SUCCESS);
+
+    rc = yaksa_flatten_size(type, flattened_size);
+    assert(rc == YAKSA_SUCCESS);
+    assert(*flattened_size > CACHE_SIZE / 2 && *flattened_size <= CACHE_SIZE);
+
+    void *flatbuf = malloc(*flattened_size);
+    rc = yaksa_flatten(type, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    yaksa_type_free(type);
+    free(displs);
+    free(blocklengths);
+
+    return flatbuf;
+}
+
+static yaksa_type_t unflatten(const void *flatbuf)
+{
+    yaksa_type_t type;
+    int rc = yaksa_unflatten(&type, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+
+    return type;
+}
+
+int main()
+{
+    int rc;
+    int errs = 0;
+    yaksa_stats_t stats;
+
+    yaksa_init_attr_t attr = YAKSA_INIT_ATTR__DEFAULT;
+    attr.unflatten_cache_size = CACHE_SIZE;
+    yaksa_init(attr);
+
+    uintptr_t size_a, size_b;
+    void *flatbuf_a = create_flattened(1, &size_a);
+    void *flatbuf_b = create_flattened(2, &size_b);
+
+    /* a copy of the flattened type hits just as well */
+    void *copy_a = malloc(size_a);
+    memcpy(copy_a, flatbuf_a, size_a);
+
+    yaksa_type_t a1 = unflatten(flatbuf_a);
+    yaksa_type_t a2 = unflatten(copy_a);
+    if (a1 != a2) {
+        fprintf(stderr, "an identical flattened type was unflattened again\n");
+        errs++;
+    }
+
+    /* every reference is freed separately */
+    yaksa_type_free(a2);
+
+    rc = yaksa_stats_get(&stats);
+    assert(rc == YAKSA_SUCCESS);
+    if (stats.unflatten_cache_hits != 1 || stats.unflatten_cache_misses != 1) {
+        fprintf(stderr, "expected one hit and one miss, got %llu and %llu\n",
+                (unsigned long long) stats.unflatten_cache_hits,
+                (unsigned long long) stats.unflatten_cache_misses);
+        errs++;
+    }
+
+    /* caching the second type evicts the first one; the application
+     * still holds the first type, so a new one is built for it */
+    yaksa_type_t b1 = unflatten(flatbuf_b);
+    yaksa_type_t a3 = unflatten(flatbuf_a);
+    if (a3 == a1 || a3 == b1) {
+        fprintf(stderr, "an evicted type was handed out again\n");
+        errs++;
+    }
+
+    yaksa_type_t a4 = unflatten(flatbuf_a);
+    if (a4 != a3) {
+        fprintf(stderr, "the most recently unflattened type was not cached\n");
+        errs++;
+    }
+
+    rc = yaksa_stats_get(&stats);
+    assert(rc == YAKSA_SUCCESS);
+    if (stats.unflatten_cache_hits != 2 || stats.unflatten_cache_misses != 3) {
+        fprintf(stderr, "expected two hits and three misses, got %llu and %llu\n",
+                (unsigned long long) stats.unflatten_cache_hits,
+                (unsigned long long) stats.unflatten_cache_misses);
+        errs++;
+    }
+
+    /* the cached type is as good as a freshly built one */
+    uintptr_t size;
+    rc = yaksa_flatten_size(a4, &size);
+    assert(rc == YAKSA_SUCCESS);
+    void *flatbuf = malloc(size);
+    rc = yaksa_flatten(a4, flatbuf);
+    assert(rc == YAKSA_SUCCESS);
+    if (size != size_a || memcmp(flatbuf, flatbuf_a, size)) {
+        fprintf(stderr, "the cached type flattens differently\n");
+        errs++;
+    }
+    free(flatbuf);
+
+    yaksa_type_free(a4);
+    yaksa_type_free(a3);
+    yaksa_type_free(b1);
+    yaksa_type_free(a1);
+
+    free(copy_a);
+    free(flatbuf_b);
+    free(flatbuf_a);
+
+    yaksa_finalize();
+
+    return errs ? 1 : 0;
+}